@@ -0,0 +1,206 @@
+// vibecad-batch: headless load -> recompute -> export over document files (no Qt)
+#include <Document.h>
+#include <DocumentIO.h>
+#include <DiskShapeCache.h>
+#include <Feature.h>
+
+#include <BRepTools.hxx>
+#include <BRep_Builder.hxx>
+#include <OSD_Parallel.hxx>
+#include <Standard_Failure.hxx>
+#include <TopoDS_Compound.hxx>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace {
+struct Options
+{
+  std::vector<std::filesystem::path> files;
+  std::filesystem::path              exportDir; // empty: no export
+  bool                               parallelFiles{false};
+  bool                               parallelRecompute{false};
+  bool                               diskCache{false};
+};
+
+struct Result
+{
+  bool               ok{false};
+  std::string        error;
+  int                items{0};
+  int                features{0};
+  std::size_t        executed{0}; // features built by execute() (the rest came from caches)
+  double             loadMs{0.0};
+  double             recomputeMs{0.0};
+  double             exportMs{0.0};
+  ShapeMemory::Usage memory;
+};
+
+using Clock = std::chrono::steady_clock;
+
+double msSince(Clock::time_point t0)
+{
+  return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+void usage(const char* argv0)
+{
+  std::fprintf(stderr,
+               "usage: %s [options] <document>...\n"
+               "  -o, --export <dir>       write <dir>/<name>.brep with the visible bodies\n"
+               "  -p, --parallel           process documents concurrently\n"
+               "      --parallel-recompute recompute independent branches concurrently\n"
+               "      --disk-cache         use <document>.cache for results\n"
+               "  -h, --help\n",
+               argv0);
+}
+
+bool parse(int argc, char* argv[], Options& opt)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    const char* a = argv[i];
+    if (!std::strcmp(a, "-o") || !std::strcmp(a, "--export"))
+    {
+      if (++i >= argc) return false;
+      opt.exportDir = argv[i];
+    }
+    else if (!std::strcmp(a, "-p") || !std::strcmp(a, "--parallel")) opt.parallelFiles = true;
+    else if (!std::strcmp(a, "--parallel-recompute")) opt.parallelRecompute = true;
+    else if (!std::strcmp(a, "--disk-cache")) opt.diskCache = true;
+    else if (a[0] == '-') return false;
+    else opt.files.emplace_back(a);
+  }
+  return !opt.files.empty();
+}
+
+// Visible bodies: unsuppressed, non-datum results in timeline order
+TopoDS_Shape bodies(const Document& doc)
+{
+  TopoDS_Compound comp;
+  BRep_Builder builder;
+  builder.MakeCompound(comp);
+  for (NCollection_Sequence<Handle(Feature)>::Iterator it(doc.features()); it.More(); it.Next())
+  {
+    const Handle(Feature)& f = it.Value();
+    if (f->isSuppressed() || f->isDatumRelated() || f->shape().IsNull()) continue;
+    builder.Add(comp, f->shape());
+  }
+  return comp;
+}
+
+Result process(const std::filesystem::path& file, const Options& opt)
+{
+  Result r;
+  try
+  {
+    Clock::time_point t0 = Clock::now();
+    std::unique_ptr<Document> doc = DocumentIO::load(file, &r.error);
+    if (!doc) return r;
+    r.loadMs = msSince(t0);
+    r.items = doc->items().Size();
+    r.features = doc->features().Size();
+
+    doc->setParallelRecompute(opt.parallelRecompute);
+    doc->setProfiling(true);
+    if (opt.diskCache) doc->setDiskCache(std::make_shared<DiskShapeCache>(DiskShapeCache::directoryFor(file)));
+    t0 = Clock::now();
+    doc->recompute();
+    r.recomputeMs = msSince(t0);
+    for (const RecomputeProfile::Sample& s : doc->lastRecomputeProfile().samples)
+    {
+      if (s.source == RecomputeProfile::Source::Executed) ++r.executed;
+    }
+
+    if (!opt.exportDir.empty())
+    {
+      t0 = Clock::now();
+      const std::filesystem::path out = opt.exportDir / (file.stem().string() + ".brep");
+      if (!BRepTools::Write(bodies(*doc), out.string().c_str()))
+      {
+        r.error = "cannot write " + out.string();
+        return r;
+      }
+      r.exportMs = msSince(t0);
+    }
+    r.memory = doc->geometryMemory().total;
+    r.ok = true;
+  }
+  catch (const Standard_Failure& e)
+  {
+    r.error = std::string("OCCT failure: ") + e.GetMessageString();
+  }
+  catch (const std::exception& e)
+  {
+    r.error = e.what();
+  }
+  return r;
+}
+
+long peakRssKb()
+{
+#if defined(__unix__) || defined(__APPLE__)
+  rusage ru{};
+  if (getrusage(RUSAGE_SELF, &ru) != 0) return -1;
+#if defined(__APPLE__)
+  return ru.ru_maxrss / 1024; // bytes on macOS
+#else
+  return ru.ru_maxrss;
+#endif
+#else
+  return -1;
+#endif
+}
+}
+
+int main(int argc, char* argv[])
+{
+  Options opt;
+  if (!parse(argc, argv, opt))
+  {
+    usage(argv[0]);
+    return 2;
+  }
+  if (!opt.exportDir.empty())
+  {
+    std::error_code ec;
+    std::filesystem::create_directories(opt.exportDir, ec);
+  }
+
+  const Clock::time_point start = Clock::now();
+  std::vector<Result> results(opt.files.size());
+  OSD_Parallel::For(0, static_cast<int>(opt.files.size()), [&](int i) {
+    results[i] = process(opt.files[i], opt);
+  }, !opt.parallelFiles);
+  const double wallMs = msSince(start);
+
+  // One tab-separated row per document, in argument order; bytes from Document::geometryMemory()
+  std::printf("document\titems\tfeatures\texecuted\tload_ms\trecompute_ms\texport_ms\ttopology_b\tgeometry_b\tmesh_b\n");
+  int failed = 0;
+  for (std::size_t i = 0; i < results.size(); ++i)
+  {
+    const Result& r = results[i];
+    if (!r.ok)
+    {
+      ++failed;
+      std::fprintf(stderr, "%s: %s\n", opt.files[i].string().c_str(), r.error.c_str());
+      continue;
+    }
+    std::printf("%s\t%d\t%d\t%zu\t%.2f\t%.2f\t%.2f\t%zu\t%zu\t%zu\n", opt.files[i].string().c_str(), r.items,
+                r.features, r.executed, r.loadMs, r.recomputeMs, r.exportMs, r.memory.topology,
+                r.memory.geometry, r.memory.triangulation);
+  }
+  const std::size_t done = results.size() - static_cast<std::size_t>(failed);
+  std::printf("# documents=%zu failed=%d wall_ms=%.2f docs_per_s=%.2f peak_rss_kb=%ld\n", results.size(), failed,
+              wallMs, wallMs > 0.0 ? 1000.0 * static_cast<double>(done) / wallMs : 0.0, peakRssKb());
+  return failed ? 1 : 0;
+}
@@ -5,10 +5,15 @@
 #include <BRepAlgoAPI_Fuse.hxx>
 #include <BRepBuilderAPI_MakeFace.hxx>
 #include <BRepPrimAPI_MakePrism.hxx>
+#include <Message_ProgressScope.hxx>
+#include <OSD_Parallel.hxx>
+#include <TopTools_ListOfShape.hxx>
 #include <TopExp_Explorer.hxx>
 #include <TopAbs_ShapeEnum.hxx>
 #include <gp_Vec.hxx>
 
+#include <algorithm>
+
 namespace KernelAPI
 {
 // Box: OCCT builder returns a closed solid with 6 planar faces
@@ -24,42 +29,67 @@ TopoDS_Shape makeCylinder(double radius, double height)
 }
 
 // Fuse: unified solid (may produce shells if inputs are not solids)
-TopoDS_Shape fuse(const TopoDS_Shape& a, const TopoDS_Shape& b)
+TopoDS_Shape fuse(const TopoDS_Shape& a, const TopoDS_Shape& b, const Message_ProgressRange& range)
 {
-  return BRepAlgoAPI_Fuse(a, b).Shape();
+  BRepAlgoAPI_Fuse op(a, b, range);
+  if (range.UserBreak()) return TopoDS_Shape();
+  return op.Shape();
 }
 
 // Extrude a set of wires along +Z by a given distance (compat wrapper)
-TopoDS_Shape extrude(const std::vector<TopoDS_Wire>& wires, double distance)
+TopoDS_Shape extrude(const std::vector<TopoDS_Wire>& wires, double distance, const Message_ProgressRange& range)
 {
-  return extrude(wires, gp_Vec(0.0, 0.0, distance));
+  return extrude(wires, gp_Vec(0.0, 0.0, distance), range);
 }
 
-// Extrude a set of wires along arbitrary vector direction
-TopoDS_Shape extrude(const std::vector<TopoDS_Wire>& wires, const gp_Vec& dir)
+// Extrude a set of wires along arbitrary vector direction: all prisms first (in parallel), then
+// one fuse over all of them instead of N-1 pairwise fuses into a growing result
+TopoDS_Shape extrude(const std::vector<TopoDS_Wire>& wires, const gp_Vec& dir, const Message_ProgressRange& range)
 {
   if (wires.empty() || dir.SquareMagnitude() <= gp::Resolution())
   {
     return TopoDS_Shape();
   }
 
-  TopoDS_Shape result;
+  // Prisms are cheap next to the fuse; weight the steps accordingly
+  Message_ProgressScope scope(range, "Extrude", 10.0);
+  Message_ProgressRange prismStep = scope.Next(1.0);
+  if (!scope.More()) { return TopoDS_Shape(); }
 
-  for (const TopoDS_Wire& w : wires)
-  {
-    if (w.IsNull()) { continue; }
-    TopoDS_Face face = BRepBuilderAPI_MakeFace(w);
-    if (face.IsNull()) { continue; }
-    TopoDS_Shape prism = BRepPrimAPI_MakePrism(face, dir).Shape();
-    if (result.IsNull())
-    {
-      result = prism;
-    }
-    else
+  // Wires share no topology, so faces and prisms build independently; blocks keep tasks coarse
+  constexpr int kBlock = 16;
+  std::vector<TopoDS_Shape> prisms(wires.size());
+  const int blocks = static_cast<int>((wires.size() + kBlock - 1) / kBlock);
+  OSD_Parallel::For(0, blocks, [&](int b) {
+    const std::size_t last = std::min(wires.size(), static_cast<std::size_t>(b + 1) * kBlock);
+    for (std::size_t i = static_cast<std::size_t>(b) * kBlock; i < last; ++i)
     {
-      result = BRepAlgoAPI_Fuse(result, prism).Shape();
+      if (wires[i].IsNull()) { continue; }
+      TopoDS_Face face = BRepBuilderAPI_MakeFace(wires[i]);
+      if (face.IsNull()) { continue; }
+      prisms[i] = BRepPrimAPI_MakePrism(face, dir).Shape();
     }
+  }, blocks < 2);
+  if (prismStep.UserBreak()) { return TopoDS_Shape(); }
+
+  TopTools_ListOfShape arguments;
+  TopTools_ListOfShape tools;
+  for (const TopoDS_Shape& prism : prisms)
+  {
+    if (prism.IsNull()) { continue; }
+    (arguments.IsEmpty() ? arguments : tools).Append(prism);
   }
-  return result;
+  if (arguments.IsEmpty()) { return TopoDS_Shape(); }
+  if (tools.IsEmpty()) { return arguments.First(); }
+
+  // Fuse of many tools into the first prism: one intersection pass over all of them
+  Message_ProgressRange fuseStep = scope.Next(9.0);
+  BRepAlgoAPI_Fuse op;
+  op.SetArguments(arguments);
+  op.SetTools(tools);
+  op.SetRunParallel(true);
+  op.Build(fuseStep);
+  if (!scope.More() || op.HasErrors()) { return TopoDS_Shape(); }
+  return op.Shape();
 }
 }
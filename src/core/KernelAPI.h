@@ -5,6 +5,7 @@
 #include <TopoDS_Wire.hxx>
 #include <vector>
 #include <gp_Vec.hxx>
+#include <Message_ProgressRange.hxx>
 
 namespace KernelAPI
 {
@@ -13,14 +14,19 @@ namespace KernelAPI
   // Create a right circular cylinder along +Z with given radius and height
   TopoDS_Shape makeCylinder(double radius, double height);
 
-  // Boolean fuse (union) of two shapes; returns the combined solid
-  TopoDS_Shape fuse(const TopoDS_Shape& a, const TopoDS_Shape& b);
+  // Boolean fuse (union) of two shapes; returns the combined solid (null if cancelled)
+  TopoDS_Shape fuse(const TopoDS_Shape& a, const TopoDS_Shape& b,
+                    const Message_ProgressRange& range = Message_ProgressRange());
 
   // Linear extrusion (prism) of one or more planar profile wires along +Z by a distance
-  // - Each wire is treated independently and the resulting prisms are fused
+  // - Each wire is treated independently; the prisms are built in parallel and fused in one
+  //   multi-tool boolean (parallel mode)
   // - Input wires are assumed to lie in the XY plane (Z=0)
-  TopoDS_Shape extrude(const std::vector<TopoDS_Wire>& wires, double distance);
+  // - Returns a null shape if the progress range reports a user break
+  TopoDS_Shape extrude(const std::vector<TopoDS_Wire>& wires, double distance,
+                       const Message_ProgressRange& range = Message_ProgressRange());
 
-  // Linear extrusion along an arbitrary vector direction (magnitude = length)
-  TopoDS_Shape extrude(const std::vector<TopoDS_Wire>& wires, const gp_Vec& dir);
+  // Linear extrusion along an arbitrary vector direction (magnitude = length); null if the fuse fails
+  TopoDS_Shape extrude(const std::vector<TopoDS_Wire>& wires, const gp_Vec& dir,
+                       const Message_ProgressRange& range = Message_ProgressRange());
 }
@@ -0,0 +1,94 @@
+#include "MappedFile.h"
+
+#include <fstream>
+#include <iterator>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::filesystem::path& file)
+{
+#if defined(_WIN32)
+  HANDLE h = CreateFileW(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (h == INVALID_HANDLE_VALUE) return;
+  LARGE_INTEGER sz{};
+  if (!GetFileSizeEx(h, &sz))
+  {
+    CloseHandle(h);
+    return;
+  }
+  m_open = true;
+  m_size = static_cast<std::size_t>(sz.QuadPart);
+  if (m_size == 0)
+  {
+    CloseHandle(h);
+    return;
+  }
+  HANDLE mapping = CreateFileMappingW(h, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+  if (view)
+  {
+    m_file = h;
+    m_mapping = mapping;
+    m_data = static_cast<const char*>(view);
+    m_mapped = true;
+    return;
+  }
+  if (mapping) CloseHandle(mapping);
+  CloseHandle(h);
+#elif defined(__unix__) || defined(__APPLE__)
+  const int fd = ::open(file.c_str(), O_RDONLY);
+  if (fd < 0) return;
+  struct stat st{};
+  if (::fstat(fd, &st) != 0)
+  {
+    ::close(fd);
+    return;
+  }
+  m_open = true;
+  m_size = static_cast<std::size_t>(st.st_size);
+  if (m_size == 0)
+  {
+    ::close(fd);
+    return;
+  }
+  void* view = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd); // the mapping keeps its own reference
+  if (view != MAP_FAILED)
+  {
+    m_data = static_cast<const char*>(view);
+    m_mapped = true;
+    return;
+  }
+#endif
+  std::ifstream is(file, std::ios::binary);
+  if (!is)
+  {
+    m_open = false;
+    return;
+  }
+  m_buffer.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+  m_open = true;
+  m_data = m_buffer.data();
+  m_size = m_buffer.size();
+}
+
+MappedFile::~MappedFile()
+{
+  if (!m_mapped) return;
+#if defined(_WIN32)
+  UnmapViewOfFile(m_data);
+  CloseHandle(static_cast<HANDLE>(m_mapping));
+  CloseHandle(static_cast<HANDLE>(m_file));
+#elif defined(__unix__) || defined(__APPLE__)
+  ::munmap(const_cast<char*>(m_data), m_size);
+#endif
+}
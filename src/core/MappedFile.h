@@ -0,0 +1,32 @@
+// Read-only memory-mapped file (no Qt deps)
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+
+// Maps a whole file for reading; falls back to reading it into memory where mapping is unavailable.
+// The view stays valid for the lifetime of the object; an empty file is open with size() == 0.
+class MappedFile
+{
+public:
+  explicit MappedFile(const std::filesystem::path& file);
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  bool        isOpen() const { return m_open; }
+  const char* data() const { return m_data; }
+  std::size_t size() const { return m_size; }
+
+private:
+  const char* m_data{nullptr};
+  std::size_t m_size{0};
+  bool        m_open{false};
+  bool        m_mapped{false}; // m_data is a mapping (else it points into m_buffer)
+  std::string m_buffer;
+#if defined(_WIN32)
+  void* m_file{nullptr};
+  void* m_mapping{nullptr};
+#endif
+};
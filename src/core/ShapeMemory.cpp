@@ -0,0 +1,214 @@
+#include "ShapeMemory.h"
+
+#include <BRep_CurveRepresentation.hxx>
+#include <BRep_ListIteratorOfListOfCurveRepresentation.hxx>
+#include <BRep_TEdge.hxx>
+#include <BRep_TFace.hxx>
+#include <Geom2d_BSplineCurve.hxx>
+#include <Geom2d_BezierCurve.hxx>
+#include <Geom2d_OffsetCurve.hxx>
+#include <Geom2d_TrimmedCurve.hxx>
+#include <Geom_BSplineCurve.hxx>
+#include <Geom_BSplineSurface.hxx>
+#include <Geom_BezierCurve.hxx>
+#include <Geom_BezierSurface.hxx>
+#include <Geom_OffsetCurve.hxx>
+#include <Geom_OffsetSurface.hxx>
+#include <Geom_RectangularTrimmedSurface.hxx>
+#include <Geom_SweptSurface.hxx>
+#include <Geom_TrimmedCurve.hxx>
+#include <Poly_Polygon2D.hxx>
+#include <Poly_Polygon3D.hxx>
+#include <Poly_PolygonOnTriangulation.hxx>
+#include <Poly_Triangulation.hxx>
+#include <Standard_Type.hxx>
+#include <TopoDS_Iterator.hxx>
+#include <gp_Pnt.hxx>
+#include <gp_Pnt2d.hxx>
+
+namespace
+{
+// One entry of a TopoDS_ListOfShape / BRep_ListOfCurveRepresentation (node link + payload)
+constexpr std::size_t kBytesPerChildLink = sizeof(void*) + sizeof(TopoDS_Shape);
+constexpr std::size_t kBytesPerRepLink = 2 * sizeof(void*);
+constexpr std::size_t kBytesPerKnot = sizeof(double) + sizeof(int); // knot value + multiplicity
+
+std::size_t objectBytes(const Standard_Transient* object)
+{
+  const Standard_Type* type = object->DynamicType();
+  return type ? type->Size() : sizeof(Standard_Transient);
+}
+
+std::size_t poleBytes(std::size_t poles, std::size_t pointSize, bool rational)
+{
+  return poles * (pointSize + (rational ? sizeof(double) : 0));
+}
+
+std::size_t triangulationBytes(const Poly_Triangulation& t)
+{
+  const std::size_t nodes = std::size_t(t.NbNodes());
+  std::size_t bytes = nodes * sizeof(gp_Pnt) + std::size_t(t.NbTriangles()) * sizeof(Poly_Triangle);
+  if (t.HasUVNodes()) bytes += nodes * sizeof(gp_Pnt2d);
+  if (t.HasNormals()) bytes += nodes * 3 * sizeof(float);
+  return bytes;
+}
+
+std::size_t polygonBytes(const Poly_Polygon3D& p)
+{
+  const std::size_t nodes = std::size_t(p.NbNodes());
+  return nodes * sizeof(gp_Pnt) + (p.HasParameters() ? nodes * sizeof(double) : 0);
+}
+
+std::size_t polygonBytes(const Poly_Polygon2D& p)
+{
+  return std::size_t(p.NbNodes()) * sizeof(gp_Pnt2d);
+}
+
+std::size_t polygonBytes(const Poly_PolygonOnTriangulation& p)
+{
+  const std::size_t nodes = std::size_t(p.NbNodes());
+  return nodes * sizeof(int) + (p.HasParameters() ? nodes * sizeof(double) : 0);
+}
+}
+
+ShapeMemory::Usage& ShapeMemory::Usage::operator+=(const Usage& o)
+{
+  topology += o.topology;
+  geometry += o.geometry;
+  triangulation += o.triangulation;
+  return *this;
+}
+
+ShapeMemory::Usage ShapeMemory::add(const TopoDS_Shape& shape)
+{
+  Usage usage;
+  visit(shape, usage);
+  m_total += usage;
+  return usage;
+}
+
+void ShapeMemory::clear()
+{
+  m_seen.clear();
+  m_total = Usage();
+}
+
+ShapeMemory::Usage ShapeMemory::measure(const TopoDS_Shape& shape)
+{
+  ShapeMemory counter;
+  return counter.add(shape);
+}
+
+bool ShapeMemory::firstSeen(const Standard_Transient* object)
+{
+  return object && m_seen.insert(object).second;
+}
+
+// Depth-first over the TShape graph; a TShape reached again (shared face, edge, vertex) stops the walk
+void ShapeMemory::visit(const TopoDS_Shape& shape, Usage& usage)
+{
+  if (shape.IsNull() || !firstSeen(shape.TShape().get())) return;
+  usage.topology += objectBytes(shape.TShape().get());
+  switch (shape.ShapeType())
+  {
+  case TopAbs_FACE: addFace(shape, usage); break;
+  case TopAbs_EDGE: addEdge(shape, usage); break;
+  default: break;
+  }
+  for (TopoDS_Iterator it(shape, false, false); it.More(); it.Next())
+  {
+    usage.topology += kBytesPerChildLink;
+    visit(it.Value(), usage);
+  }
+}
+
+void ShapeMemory::addFace(const TopoDS_Shape& face, Usage& usage)
+{
+  Handle(BRep_TFace) tf = Handle(BRep_TFace)::DownCast(face.TShape());
+  if (tf.IsNull()) return;
+  usage.geometry += surfaceBytes(tf->Surface().get());
+  const Handle(Poly_Triangulation)& mesh = tf->Triangulation();
+  if (firstSeen(mesh.get())) usage.triangulation += objectBytes(mesh.get()) + triangulationBytes(*mesh);
+}
+
+// Edge representations: 3D curve, pcurves per face, and the polygons left behind by meshing
+void ShapeMemory::addEdge(const TopoDS_Shape& edge, Usage& usage)
+{
+  Handle(BRep_TEdge) te = Handle(BRep_TEdge)::DownCast(edge.TShape());
+  if (te.IsNull()) return;
+  for (BRep_ListIteratorOfListOfCurveRepresentation it(te->Curves()); it.More(); it.Next())
+  {
+    const Handle(BRep_CurveRepresentation)& rep = it.Value();
+    if (rep->IsPolygon3D() || rep->IsPolygonOnTriangulation() || rep->IsPolygonOnSurface())
+    {
+      usage.triangulation += objectBytes(rep.get()) + kBytesPerRepLink;
+      if (rep->IsPolygon3D() && firstSeen(rep->Polygon3D().get()))
+        usage.triangulation += objectBytes(rep->Polygon3D().get()) + polygonBytes(*rep->Polygon3D());
+      if (rep->IsPolygonOnTriangulation() && firstSeen(rep->PolygonOnTriangulation().get()))
+        usage.triangulation += objectBytes(rep->PolygonOnTriangulation().get())
+                             + polygonBytes(*rep->PolygonOnTriangulation());
+      if (rep->IsPolygonOnClosedTriangulation() && firstSeen(rep->PolygonOnTriangulation2().get()))
+        usage.triangulation += objectBytes(rep->PolygonOnTriangulation2().get())
+                             + polygonBytes(*rep->PolygonOnTriangulation2());
+      if (rep->IsPolygonOnSurface() && firstSeen(rep->Polygon().get()))
+        usage.triangulation += objectBytes(rep->Polygon().get()) + polygonBytes(*rep->Polygon());
+      if (rep->IsPolygonOnClosedSurface() && firstSeen(rep->Polygon2().get()))
+        usage.triangulation += objectBytes(rep->Polygon2().get()) + polygonBytes(*rep->Polygon2());
+      continue;
+    }
+    usage.geometry += objectBytes(rep.get()) + kBytesPerRepLink;
+    if (rep->IsCurve3D()) usage.geometry += curveBytes(rep->Curve3D().get());
+    if (rep->IsCurveOnSurface())
+    {
+      usage.geometry += curveBytes(rep->PCurve().get());
+      usage.geometry += surfaceBytes(rep->Surface().get());
+    }
+    if (rep->IsCurveOnClosedSurface()) usage.geometry += curveBytes(rep->PCurve2().get());
+  }
+}
+
+// 3D and 2D curves; trimmed/offset wrappers also count their (possibly shared) basis
+std::size_t ShapeMemory::curveBytes(const Standard_Transient* curve)
+{
+  if (!firstSeen(curve)) return 0;
+  std::size_t bytes = objectBytes(curve);
+  if (auto* c = dynamic_cast<const Geom_BSplineCurve*>(curve))
+    bytes += poleBytes(std::size_t(c->NbPoles()), sizeof(gp_Pnt), c->IsRational())
+           + std::size_t(c->NbKnots()) * kBytesPerKnot;
+  else if (auto* c = dynamic_cast<const Geom_BezierCurve*>(curve))
+    bytes += poleBytes(std::size_t(c->NbPoles()), sizeof(gp_Pnt), c->IsRational());
+  else if (auto* c = dynamic_cast<const Geom_TrimmedCurve*>(curve))
+    bytes += curveBytes(c->BasisCurve().get());
+  else if (auto* c = dynamic_cast<const Geom_OffsetCurve*>(curve))
+    bytes += curveBytes(c->BasisCurve().get());
+  else if (auto* c = dynamic_cast<const Geom2d_BSplineCurve*>(curve))
+    bytes += poleBytes(std::size_t(c->NbPoles()), sizeof(gp_Pnt2d), c->IsRational())
+           + std::size_t(c->NbKnots()) * kBytesPerKnot;
+  else if (auto* c = dynamic_cast<const Geom2d_BezierCurve*>(curve))
+    bytes += poleBytes(std::size_t(c->NbPoles()), sizeof(gp_Pnt2d), c->IsRational());
+  else if (auto* c = dynamic_cast<const Geom2d_TrimmedCurve*>(curve))
+    bytes += curveBytes(c->BasisCurve().get());
+  else if (auto* c = dynamic_cast<const Geom2d_OffsetCurve*>(curve))
+    bytes += curveBytes(c->BasisCurve().get());
+  return bytes;
+}
+
+std::size_t ShapeMemory::surfaceBytes(const Standard_Transient* surface)
+{
+  if (!firstSeen(surface)) return 0;
+  std::size_t bytes = objectBytes(surface);
+  if (auto* s = dynamic_cast<const Geom_BSplineSurface*>(surface))
+    bytes += poleBytes(std::size_t(s->NbUPoles()) * std::size_t(s->NbVPoles()), sizeof(gp_Pnt),
+                       s->IsURational() || s->IsVRational())
+           + std::size_t(s->NbUKnots() + s->NbVKnots()) * kBytesPerKnot;
+  else if (auto* s = dynamic_cast<const Geom_BezierSurface*>(surface))
+    bytes += poleBytes(std::size_t(s->NbUPoles()) * std::size_t(s->NbVPoles()), sizeof(gp_Pnt),
+                       s->IsURational() || s->IsVRational());
+  else if (auto* s = dynamic_cast<const Geom_RectangularTrimmedSurface*>(surface))
+    bytes += surfaceBytes(s->BasisSurface().get());
+  else if (auto* s = dynamic_cast<const Geom_OffsetSurface*>(surface))
+    bytes += surfaceBytes(s->BasisSurface().get());
+  else if (auto* s = dynamic_cast<const Geom_SweptSurface*>(surface))
+    bytes += curveBytes(s->BasisCurve().get());
+  return bytes;
+}
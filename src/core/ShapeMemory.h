@@ -0,0 +1,49 @@
+// Geometry memory accounting for OCCT shapes (no Qt deps)
+#pragma once
+
+#include <TopoDS_Shape.hxx>
+
+#include <cstddef>
+#include <unordered_set>
+
+class Standard_Transient;
+
+// Walks shapes and sums the heap held by their B-Rep data
+// - Each shared TShape, curve, surface and mesh is counted once per accumulator,
+//   so sub-shapes shared inside a shape or between shapes are not double counted
+// - Sizes come from the OCCT RTTI object size plus pole/knot/node arrays; they are
+//   estimates of the live data, not allocator-exact figures
+class ShapeMemory
+{
+public:
+  struct Usage
+  {
+    std::size_t topology{0};      // TShapes and their sub-shape lists
+    std::size_t geometry{0};      // surfaces, 3D curves, pcurves and edge representations
+    std::size_t triangulation{0}; // face meshes and edge polygons
+
+    std::size_t total() const { return topology + geometry + triangulation; }
+    Usage&      operator+=(const Usage& o);
+  };
+
+  // Adds a shape; returns only the bytes not already counted by earlier calls
+  Usage add(const TopoDS_Shape& shape);
+
+  const Usage& total() const { return m_total; }
+  void         clear();
+
+  // Standalone usage of one shape (sharing counted within the shape only)
+  static Usage measure(const TopoDS_Shape& shape);
+
+private:
+  void visit(const TopoDS_Shape& shape, Usage& usage);
+  void addEdge(const TopoDS_Shape& edge, Usage& usage);
+  void addFace(const TopoDS_Shape& face, Usage& usage);
+  bool firstSeen(const Standard_Transient* object);
+
+  std::size_t curveBytes(const Standard_Transient* curve);
+  std::size_t surfaceBytes(const Standard_Transient* surface);
+
+  std::unordered_set<const void*> m_seen;
+  Usage                           m_total;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Incremental 64-bit FNV-1a hasher for content-addressed keys.
+// Values are hashed by their bit patterns, so keys are stable across runs of the same platform.
+class ContentHash
+{
+public:
+  ContentHash& add(const void* data, std::size_t size)
+  {
+    const auto* p = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      m_value ^= p[i];
+      m_value *= 1099511628211ull;
+    }
+    return *this;
+  }
+
+  ContentHash& add(std::uint64_t v) { return add(&v, sizeof(v)); }
+  ContentHash& add(std::int64_t v) { return add(&v, sizeof(v)); }
+  ContentHash& add(int v) { return add(static_cast<std::int64_t>(v)); }
+  ContentHash& add(bool v) { return add(static_cast<std::int64_t>(v ? 1 : 0)); }
+
+  ContentHash& add(double v)
+  {
+    if (v == 0.0) v = 0.0; // fold -0.0 into +0.0
+    std::uint64_t bits = 0;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return add(bits);
+  }
+
+  ContentHash& add(const std::string& s)
+  {
+    add(static_cast<std::uint64_t>(s.size()));
+    return add(s.data(), s.size());
+  }
+
+  std::uint64_t value() const { return m_value; }
+
+private:
+  std::uint64_t m_value{14695981039346656037ull};
+};
@@ -1,4 +1,5 @@
 #include "DocumentItem.h"
+#include "ContentHash.h"
 
 #include <atomic>
 #include <mutex>
@@ -10,13 +11,37 @@ static std::atomic<DocumentItem::Id>& nextId()
   return v;
 }
 
-static std::unordered_map<DocumentItem::Kind, DocumentItem::CreateFn>& registry()
+// Kinds are sparse (1, 100..); slots are dense
+constexpr int kFactorySlots = 16;
+
+static int factorySlot(DocumentItem::Kind k)
+{
+  const int v = static_cast<int>(k);
+  if (v == static_cast<int>(DocumentItem::Kind::Sketch)) return 0;
+  const int slot = v - static_cast<int>(DocumentItem::Kind::BoxFeature) + 1;
+  return slot >= 1 && slot < kFactorySlots ? slot : -1;
+}
+
+static std::atomic<DocumentItem::CreateFn>& factory(int slot)
+{
+  static std::atomic<DocumentItem::CreateFn> table[kFactorySlots] = {};
+  return table[slot];
+}
+
+// Deferred payloads load under a per-item stripe; recursive because deserialize() goes
+// through the same accessors that trigger loading
+static std::recursive_mutex& payloadMutex(DocumentItem::Id id)
 {
-  static std::unordered_map<DocumentItem::Kind, DocumentItem::CreateFn> r;
-  return r;
+  static std::recursive_mutex stripes[64];
+  return stripes[id % 64];
 }
 
-static std::mutex registryMutex;
+// Ids handed out later must not collide with a persisted one; a read only once the range is reserved
+static void reserveId(DocumentItem::Id id)
+{
+  DocumentItem::Id cur = nextId().load(std::memory_order_relaxed);
+  while (id >= cur && !nextId().compare_exchange_weak(cur, id + 1)) {}
+}
 }
 
 DocumentItem::DocumentItem()
@@ -27,24 +52,75 @@ DocumentItem::DocumentItem()
 DocumentItem::DocumentItem(DocumentItem::Id existingId)
   : m_id(existingId)
 {
-  // keep next id ahead
-  DocumentItem::Id cur = nextId().load();
-  if (existingId >= cur) {
-    nextId().store(existingId + 1);
+  reserveId(existingId);
+}
+
+void DocumentItem::restoreId(DocumentItem::Id id)
+{
+  m_id = id;
+  reserveId(id);
+}
+
+void DocumentItem::reserveIds(DocumentItem::Id last)
+{
+  reserveId(last);
+}
+
+void DocumentItem::deferPayload(std::shared_ptr<const PayloadSource> source, std::size_t entry)
+{
+  m_payloadSource = std::move(source);
+  m_payloadEntry = entry;
+  m_pending.store(m_payloadSource != nullptr, std::memory_order_release);
+}
+
+void DocumentItem::loadPayload() const
+{
+  std::lock_guard<std::recursive_mutex> lock(payloadMutex(m_id));
+  // Null when another thread finished first, or when re-entered from deserialize() below
+  std::shared_ptr<const PayloadSource> source = std::move(m_payloadSource);
+  if (!source) return;
+  // Loading is not an edit: deserialize() marks the item dirty, so restore the state it was
+  // loaded with (async recompute and autosave compare revisions)
+  auto* self = const_cast<DocumentItem*>(this);
+  const bool          dirty = m_dirty;
+  const std::uint64_t revision = m_revision;
+  try
+  {
+    self->deserialize(source->payload(m_payloadEntry));
   }
+  catch (...)
+  {
+    self->m_dirty = dirty;
+    self->m_revision = revision;
+    m_pending.store(false, std::memory_order_release); // left with its defaults; do not retry
+    throw;
+  }
+  self->m_dirty = dirty;
+  self->m_revision = revision;
+  m_pending.store(false, std::memory_order_release);
+}
+
+void DocumentItem::dropPayload()
+{
+  std::lock_guard<std::recursive_mutex> lock(payloadMutex(m_id));
+  m_payloadSource.reset();
+  m_pending.store(false, std::memory_order_release);
 }
 
 void DocumentItem::registerFactory(DocumentItem::Kind k, DocumentItem::CreateFn fn)
 {
-  std::lock_guard<std::mutex> lock(registryMutex);
-  registry()[k] = std::move(fn);
+  const int slot = factorySlot(k);
+  if (slot >= 0) factory(slot).store(fn, std::memory_order_release);
+}
+
+Handle(DocumentItem) DocumentItem::create(DocumentItem::Kind k, PersistedId id)
+{
+  const int slot = factorySlot(k);
+  const CreateFn fn = slot >= 0 ? factory(slot).load(std::memory_order_acquire) : nullptr;
+  return fn ? Handle(DocumentItem)(fn(id)) : Handle(DocumentItem)();
 }
 
-std::shared_ptr<DocumentItem> DocumentItem::create(DocumentItem::Kind k)
+std::uint64_t DocumentItem::contentHash() const
 {
-  std::lock_guard<std::mutex> lock(registryMutex);
-  auto& reg = registry();
-  auto it = reg.find(k);
-  if (it == reg.end()) return nullptr;
-  return (it->second)();
+  return ContentHash().add(static_cast<int>(kind())).add(serialize()).value();
 }
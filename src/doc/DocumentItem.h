@@ -1,9 +1,11 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 #include <Standard_DefineHandle.hxx>
@@ -30,26 +32,119 @@ public:
   virtual ~DocumentItem() = default;
 
   Id id() const { return m_id; }
+  // Loaders only: take the persisted id before the item joins a document (keeps new ids ahead)
+  void restoreId(Id id);
+  // Keep new ids above last; bulk loaders call it once so per-item restores only read the counter
+  static void reserveIds(Id last);
+
+  // Constructor tag for loaders: the item takes a persisted id instead of drawing a new one, so
+  // loading leaves the id counter at max(previous, largest loaded id + 1) whatever the thread order
+  struct PersistedId
+  {
+    Id value{0};
+  };
+
+  // Dirty flag: set by mutators that affect results, cleared by Document::recompute()
+  bool isDirty() const { return m_dirty; }
+  void markDirty()
+  {
+    m_dirty = true;
+    ++m_revision;
+    touch();
+  }
+  void clearDirty()
+  {
+    if (!m_dirty) return;
+    m_dirty = false;
+    touch();
+  }
+  // Incremented by every markDirty(); detects edits made while an async recompute ran
+  std::uint64_t revision() const { return m_revision; }
+
+  // Change hook installed by the owning Document (snapshots); may be called from recompute workers
+  class Observer
+  {
+  public:
+    virtual ~Observer() = default;
+    virtual void itemChanged(const DocumentItem& item) = 0;
+  };
+  void setObserver(Observer* o) { m_observer = o; }
+
+  // Deferred payload (lazy document loads): the serialized blob stays with its source until an
+  // accessor needs it, then deserialize() runs once. Subclass accessors call ensureLoaded().
+  class PayloadSource
+  {
+  public:
+    virtual ~PayloadSource() = default;
+    virtual std::string_view payload(std::size_t entry) const = 0; // valid while the source lives
+  };
+  // Loaders only: before the item joins a document
+  void deferPayload(std::shared_ptr<const PayloadSource> source, std::size_t entry);
+  bool isLoaded() const { return !m_pending.load(std::memory_order_acquire); }
+  // Safe to call concurrently; the first caller deserializes, others wait for it
+  void ensureLoaded() const
+  {
+    if (!isLoaded()) loadPayload();
+  }
 
   // Every item reports its kind for factory-driven reconstruction
   virtual Kind kind() const = 0;
 
   // Minimal serialization interface: encode to a string blob and restore from it
   virtual std::string serialize() const = 0;
-  virtual void        deserialize(const std::string& data) = 0;
+  virtual void        deserialize(std::string_view data) = 0;
 
-  // Factory registration and creation for document load
-  using CreateFn = std::function<std::shared_ptr<DocumentItem>()>;
+  // Hash of everything that affects this item's computed result (not its id or links).
+  // Default: kind plus serialized blob; subclasses hash their raw inputs instead.
+  virtual std::uint64_t contentHash() const;
+
+  // Factory registration and creation for document load. The table is a fixed array of plain
+  // function pointers: registration happens during static initialization, lookups take no lock
+  using CreateFn = DocumentItem* (*)(PersistedId id);
 
   static void registerFactory(Kind k, CreateFn fn);
-  static std::shared_ptr<DocumentItem> create(Kind k);
+  // Null for unregistered kinds
+  static Handle(DocumentItem) create(Kind k, PersistedId id);
 
 protected:
   DocumentItem();
   explicit DocumentItem(Id existingId);
+  // Copies (clones, snapshots for async recompute) are not observed by the original's document
+  // A copy is always loaded: the source is loaded here, before subclass members are copied
+  DocumentItem(const DocumentItem& o) : Standard_Transient(loaded(o)), m_id(o.m_id), m_dirty(o.m_dirty), m_revision(o.m_revision) {}
+  DocumentItem& operator=(const DocumentItem& o)
+  {
+    o.ensureLoaded();
+    dropPayload();
+    m_id = o.m_id;
+    m_dirty = o.m_dirty;
+    m_revision = o.m_revision;
+    touch();
+    return *this;
+  }
+
+  // Report a change that is not a dirty transition (name, display flags, installed result)
+  void touch() const
+  {
+    if (m_observer) m_observer->itemChanged(*this);
+  }
 
 private:
-  Id m_id{0};
+  static const DocumentItem& loaded(const DocumentItem& o)
+  {
+    o.ensureLoaded();
+    return o;
+  }
+  void loadPayload() const;
+  void dropPayload();
+
+  Id   m_id{0};
+  bool          m_dirty{true}; // new items have never been computed
+  std::uint64_t m_revision{0};
+  Observer*     m_observer{nullptr};
+  mutable std::shared_ptr<const PayloadSource> m_payloadSource; // set while a payload is deferred
+  std::size_t                                  m_payloadEntry{0};
+  mutable std::atomic<bool>                    m_pending{false};
 };
 
 // Enable OCCT handle for DocumentItem
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+// Floating-point to_chars/from_chars are missing from some standard libraries (Apple libc++);
+// integers use them everywhere
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#define FIELDTEXT_FP_CHARCONV 1
+#else
+#define FIELDTEXT_FP_CHARCONV 0
+#include <cerrno>
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#endif
+
+// Line-based key=value text used by item blobs ("key=value\n" per field).
+// Numbers are written with std::to_chars: doubles in their shortest form that parses back to the
+// same bits, so blobs round-trip exactly and are byte-stable for hashing. Without floating-point
+// charconv, doubles use 17 significant digits ("%.17g"/strtod with '.' whatever the C locale), which
+// round-trips as well. Values escape '\' and '=' with a backslash, and line breaks as \n and \r so
+// a value never splits its line. Reading works on views into the blob and allocates only to unescape.
+namespace FieldText
+{
+#if FIELDTEXT_FP_CHARCONV
+  inline void appendNumber(std::string& out, double v)
+  {
+    char buf[32];
+    const auto r = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, r.ptr);
+  }
+#else
+  // Decimal separator of the C locale; blobs always use '.'
+  inline char localeDecimalPoint()
+  {
+    const char* p = std::localeconv()->decimal_point;
+    return (p && p[0]) ? p[0] : '.';
+  }
+
+  inline void appendNumber(std::string& out, double v)
+  {
+    char buf[32];
+    const int n = std::snprintf(buf, sizeof(buf), "%.17g", v);
+    if (n <= 0) return;
+    const char point = localeDecimalPoint();
+    for (int i = 0; i < n; ++i)
+    {
+      if (buf[i] == point) buf[i] = '.';
+    }
+    out.append(buf, static_cast<std::size_t>(n));
+  }
+#endif
+
+  template <class Int>
+  inline void appendInteger(std::string& out, Int v)
+  {
+    char buf[24];
+    const auto r = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, r.ptr);
+  }
+
+  inline void appendEscaped(std::string& out, std::string_view s)
+  {
+    for (char c : s)
+    {
+      if (c == '\n' || c == '\r')
+      {
+        out.push_back('\\');
+        out.push_back(c == '\n' ? 'n' : 'r');
+        continue;
+      }
+      if (c == '\\' || c == '=') out.push_back('\\');
+      out.push_back(c);
+    }
+  }
+
+  // Whole view must be a number; leaves v untouched otherwise
+#if FIELDTEXT_FP_CHARCONV
+  inline bool parseNumber(std::string_view s, double& v)
+  {
+    const auto r = std::from_chars(s.data(), s.data() + s.size(), v);
+    return r.ec == std::errc() && r.ptr == s.data() + s.size();
+  }
+#else
+  inline bool parseNumber(std::string_view s, double& v)
+  {
+    // strtod also takes leading blanks, '+' and hex; from_chars does not
+    char buf[64];
+    if (s.empty() || s.size() >= sizeof(buf) || s[0] == '+' || s[0] == ' ' || s[0] == '\t') return false;
+    const char point = localeDecimalPoint();
+    for (std::size_t i = 0; i < s.size(); ++i)
+    {
+      const char c = s[i];
+      if (c == 'x' || c == 'X') return false;
+      buf[i] = (c == '.') ? point : c;
+    }
+    buf[s.size()] = '\0';
+    char* end = nullptr;
+    errno = 0;
+    const double d = std::strtod(buf, &end);
+    if (end != buf + s.size() || (errno == ERANGE && std::fabs(d) == HUGE_VAL)) return false;
+    v = d;
+    return true;
+  }
+#endif
+
+  template <class Int>
+  inline bool parseInteger(std::string_view s, Int& v)
+  {
+    const auto r = std::from_chars(s.data(), s.data() + s.size(), v);
+    return r.ec == std::errc() && r.ptr == s.data() + s.size();
+  }
+
+  struct Field
+  {
+    std::string_view key;
+    std::string_view value;   // raw, still escaped when escaped is set
+    bool             escaped{false};
+  };
+
+  // Value with escapes removed; scratch holds the result only when needed
+  inline std::string_view unescaped(const Field& f, std::string& scratch)
+  {
+    if (!f.escaped) return f.value;
+    scratch.clear();
+    bool esc = false;
+    for (char c : f.value)
+    {
+      if (!esc && c == '\\')
+      {
+        esc = true;
+        continue;
+      }
+      if (esc && c == 'n') scratch.push_back('\n');
+      else if (esc && c == 'r') scratch.push_back('\r');
+      else scratch.push_back(c);
+      esc = false;
+    }
+    return scratch;
+  }
+
+  // Iterates the fields of a blob; lines without an unescaped '=' are skipped
+  class Reader
+  {
+  public:
+    explicit Reader(std::string_view data) : m_data(data) {}
+
+    bool next(Field& f)
+    {
+      while (m_pos < m_data.size())
+      {
+        std::size_t eol = m_data.find('\n', m_pos);
+        if (eol == std::string_view::npos) eol = m_data.size();
+        const std::string_view line = m_data.substr(m_pos, eol - m_pos);
+        m_pos = eol + 1;
+
+        bool esc = false;
+        bool any = false;
+        for (std::size_t i = 0; i < line.size(); ++i)
+        {
+          if (!esc && line[i] == '=')
+          {
+            f.key = line.substr(0, i);
+            f.value = line.substr(i + 1);
+            f.escaped = any || f.value.find('\\') != std::string_view::npos;
+            return true;
+          }
+          esc = (!esc && line[i] == '\\');
+          any = any || esc;
+        }
+      }
+      return false;
+    }
+
+  private:
+    std::string_view m_data;
+    std::size_t      m_pos{0};
+  };
+}
@@ -13,7 +13,7 @@ IMPLEMENT_STANDARD_RTTIEXT(AxeFeature, Feature)
 
 namespace {
 const bool kAxeFeatureReg = [](){
-  DocumentItem::registerFactory(DocumentItem::Kind::AxeFeature, [](){ return std::shared_ptr<DocumentItem>(new AxeFeature()); });
+  DocumentItem::registerFactory(DocumentItem::Kind::AxeFeature, [](DocumentItem::PersistedId id) -> DocumentItem* { return new AxeFeature(id); });
   return true;
 }();
 }
@@ -19,9 +19,11 @@ class AxeFeature : public Feature
   DEFINE_STANDARD_RTTIEXT(AxeFeature, Feature)
 
 public:
-  AxeFeature() = default;
+  AxeFeature() : Feature(kSchema) {}
+  explicit AxeFeature(PersistedId id) : Feature(id, kSchema) {} // loaders
 
   AxeFeature(const gp_Pnt& origin, const gp_Dir& dir, double length)
+    : Feature(kSchema)
   {
     setOrigin(origin);
     setDirection(dir);
@@ -31,17 +33,17 @@ public:
   // Param setters
   void setOrigin(const gp_Pnt& p)
   {
-    params()[Feature::ParamKey::Ox] = p.X();
-    params()[Feature::ParamKey::Oy] = p.Y();
-    params()[Feature::ParamKey::Oz] = p.Z();
+    setParam(Feature::ParamKey::Ox, p.X());
+    setParam(Feature::ParamKey::Oy, p.Y());
+    setParam(Feature::ParamKey::Oz, p.Z());
   }
   void setDirection(const gp_Dir& d)
   {
-    params()[Feature::ParamKey::Nx] = d.X();
-    params()[Feature::ParamKey::Ny] = d.Y();
-    params()[Feature::ParamKey::Nz] = d.Z();
+    setParam(Feature::ParamKey::Nx, d.X());
+    setParam(Feature::ParamKey::Ny, d.Y());
+    setParam(Feature::ParamKey::Nz, d.Z());
   }
-  void setLength(double l) { params()[Feature::ParamKey::Length] = l; }
+  void setLength(double l) { setParam(Feature::ParamKey::Length, l); }
 
   // Param getters
   gp_Pnt origin() const;
@@ -52,7 +54,21 @@ public:
 
   // Feature API
   void execute() override;
+  Handle(Feature) clone() const override { return new AxeFeature(*this); }
+
+  // Parameter layout: declared keys are stored in flat slots
+  static constexpr ParamSchema kSchema{
+      {ParamKey::Ox, ParamType::Double},
+      {ParamKey::Oy, ParamType::Double},
+      {ParamKey::Oz, ParamType::Double},
+      {ParamKey::Nx, ParamType::Double},
+      {ParamKey::Ny, ParamType::Double},
+      {ParamKey::Nz, ParamType::Double},
+      {ParamKey::Length, ParamType::Double},
+      {ParamKey::FixedGeometry, ParamType::Int},
+  };
 
   // DocumentItem
-  Kind kind() const override { return Kind::AxeFeature; }
+  static constexpr Kind StaticKind = Kind::AxeFeature; // for Document::itemsOfKind<T>()
+  Kind kind() const override { return StaticKind; }
 };
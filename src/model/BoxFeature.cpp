@@ -8,7 +8,7 @@ IMPLEMENT_STANDARD_RTTIEXT(BoxFeature, Feature)
 
 namespace {
 const bool kBoxFeatureReg = [](){
-  DocumentItem::registerFactory(DocumentItem::Kind::BoxFeature, [](){ return std::shared_ptr<DocumentItem>(new BoxFeature()); });
+  DocumentItem::registerFactory(DocumentItem::Kind::BoxFeature, [](DocumentItem::PersistedId id) -> DocumentItem* { return new BoxFeature(id); });
   return true;
 }();
 }
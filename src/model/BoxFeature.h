@@ -12,9 +12,10 @@ class BoxFeature : public Feature
   DEFINE_STANDARD_RTTIEXT(BoxFeature, Feature)
 
 public:
-  BoxFeature() = default;
+  BoxFeature() : Feature(kSchema) {}
+  explicit BoxFeature(PersistedId id) : Feature(id, kSchema) {} // loaders
 
-  BoxFeature(double dx, double dy, double dz) { setSize(dx, dy, dz); }
+  BoxFeature(double dx, double dy, double dz) : Feature(kSchema) { setSize(dx, dy, dz); }
 
   // Parameter accessors (backed by Feature::params())
   void setSize(double dx, double dy, double dz)
@@ -24,11 +25,11 @@ public:
     setDz(dz);
   }
 
-  void setDx(double dx) { params()[Feature::ParamKey::Dx] = dx; }
+  void setDx(double dx) { setParam(Feature::ParamKey::Dx, dx); }
 
-  void setDy(double dy) { params()[Feature::ParamKey::Dy] = dy; }
+  void setDy(double dy) { setParam(Feature::ParamKey::Dy, dy); }
 
-  void setDz(double dz) { params()[Feature::ParamKey::Dz] = dz; }
+  void setDz(double dz) { setParam(Feature::ParamKey::Dz, dz); }
 
   double dx() const;
   double dy() const;
@@ -36,7 +37,16 @@ public:
 
   // Feature API
   void execute() override;
+  Handle(Feature) clone() const override { return new BoxFeature(*this); }
+
+  // Parameter layout: declared keys are stored in flat slots
+  static constexpr ParamSchema kSchema{
+      {ParamKey::Dx, ParamType::Double},
+      {ParamKey::Dy, ParamType::Double},
+      {ParamKey::Dz, ParamType::Double},
+  };
 
   // DocumentItem
-  Kind kind() const override { return Kind::BoxFeature; }
+  static constexpr Kind StaticKind = Kind::BoxFeature; // for Document::itemsOfKind<T>()
+  Kind kind() const override { return StaticKind; }
 };
@@ -8,7 +8,7 @@ IMPLEMENT_STANDARD_RTTIEXT(CylinderFeature, Feature)
 
 namespace {
 const bool kCylinderFeatureReg = [](){
-  DocumentItem::registerFactory(DocumentItem::Kind::CylinderFeature, [](){ return std::shared_ptr<DocumentItem>(new CylinderFeature()); });
+  DocumentItem::registerFactory(DocumentItem::Kind::CylinderFeature, [](DocumentItem::PersistedId id) -> DocumentItem* { return new CylinderFeature(id); });
   return true;
 }();
 }
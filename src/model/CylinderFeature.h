@@ -12,8 +12,9 @@ class CylinderFeature : public Feature
   DEFINE_STANDARD_RTTIEXT(CylinderFeature, Feature)
 
 public:
-  CylinderFeature() = default;
-  CylinderFeature(double radius, double height) { set(radius, height); }
+  CylinderFeature() : Feature(kSchema) {}
+  explicit CylinderFeature(PersistedId id) : Feature(id, kSchema) {} // loaders
+  CylinderFeature(double radius, double height) : Feature(kSchema) { set(radius, height); }
 
   void set(double radius, double height)
   {
@@ -21,14 +22,22 @@ public:
     setHeight(height);
   }
 
-  void setRadius(double r) { params()[Feature::ParamKey::Radius] = r; }
-  void setHeight(double h) { params()[Feature::ParamKey::Height] = h; }
+  void setRadius(double r) { setParam(Feature::ParamKey::Radius, r); }
+  void setHeight(double h) { setParam(Feature::ParamKey::Height, h); }
 
   double radius() const;
   double height() const;
 
   void execute() override;
+  Handle(Feature) clone() const override { return new CylinderFeature(*this); }
+
+  // Parameter layout: declared keys are stored in flat slots
+  static constexpr ParamSchema kSchema{
+      {ParamKey::Radius, ParamType::Double},
+      {ParamKey::Height, ParamType::Double},
+  };
 
   // DocumentItem
-  Kind kind() const override { return Kind::CylinderFeature; }
+  static constexpr Kind StaticKind = Kind::CylinderFeature; // for Document::itemsOfKind<T>()
+  Kind kind() const override { return StaticKind; }
 };
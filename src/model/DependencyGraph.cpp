@@ -0,0 +1,124 @@
+#include "DependencyGraph.h"
+
+#include <algorithm>
+
+namespace {
+const std::vector<DocumentItem::Id> kNoEdges;
+}
+
+void DependencyGraph::eraseValue(std::vector<Id>& v, Id value)
+{
+  v.erase(std::remove(v.begin(), v.end(), value), v.end());
+}
+
+void DependencyGraph::setUpstream(Id node, const std::vector<Id>& upstream)
+{
+  Node& n = m_nodes[node];
+  for (Id u : n.up)
+  {
+    auto it = m_nodes.find(u);
+    if (it != m_nodes.end()) eraseValue(it->second.down, node);
+  }
+  n.up.clear();
+  for (Id u : upstream)
+  {
+    if (u == 0 || u == node) continue;
+    if (std::find(n.up.begin(), n.up.end(), u) != n.up.end()) continue;
+    n.up.push_back(u);
+    m_nodes[u].down.push_back(node);
+  }
+}
+
+void DependencyGraph::remove(Id node)
+{
+  auto it = m_nodes.find(node);
+  if (it == m_nodes.end()) return;
+  setUpstream(node, {});
+  if (it->second.down.empty()) m_nodes.erase(it);
+}
+
+const std::vector<DependencyGraph::Id>& DependencyGraph::upstream(Id node) const
+{
+  auto it = m_nodes.find(node);
+  return it == m_nodes.end() ? kNoEdges : it->second.up;
+}
+
+const std::vector<DependencyGraph::Id>& DependencyGraph::downstream(Id node) const
+{
+  auto it = m_nodes.find(node);
+  return it == m_nodes.end() ? kNoEdges : it->second.down;
+}
+
+std::unordered_set<DependencyGraph::Id> DependencyGraph::closure(const std::vector<Id>& seeds) const
+{
+  std::unordered_set<Id> out;
+  std::vector<Id>        stack(seeds.begin(), seeds.end());
+  while (!stack.empty())
+  {
+    const Id id = stack.back();
+    stack.pop_back();
+    if (!out.insert(id).second) continue;
+    for (Id d : downstream(id)) stack.push_back(d);
+  }
+  return out;
+}
+
+std::vector<std::vector<DependencyGraph::Id>> DependencyGraph::partition(const std::vector<Id>& nodes,
+                                                                          const std::function<bool(Id)>& walkThrough) const
+{
+  // Union-find over the nodes and their upstream ids (transitively through walkThrough nodes)
+  std::unordered_map<Id, Id> parent;
+  auto find = [&parent](Id x) {
+    Id root = x;
+    for (auto it = parent.find(root); it != parent.end() && it->second != root; it = parent.find(root))
+      root = it->second;
+    // path compression
+    while (x != root)
+    {
+      Id next = parent[x];
+      parent[x] = root;
+      x = next;
+    }
+    return root;
+  };
+  auto unite = [&](Id a, Id b) {
+    parent.emplace(a, a);
+    parent.emplace(b, b);
+    const Id ra = find(a);
+    const Id rb = find(b);
+    if (ra != rb) parent[rb] = ra;
+  };
+  std::unordered_set<Id> walked;
+  std::vector<Id>        stack;
+  for (Id n : nodes)
+  {
+    parent.emplace(n, n);
+    for (Id u : upstream(n))
+    {
+      unite(n, u);
+      if (walkThrough && walkThrough(u)) stack.push_back(u);
+    }
+    while (!stack.empty())
+    {
+      const Id w = stack.back();
+      stack.pop_back();
+      if (!walked.insert(w).second) continue;
+      for (Id u : upstream(w))
+      {
+        unite(w, u);
+        if (walkThrough(u)) stack.push_back(u);
+      }
+    }
+  }
+
+  std::vector<std::vector<Id>> groups;
+  std::unordered_map<Id, std::size_t> groupOfRoot;
+  for (Id n : nodes)
+  {
+    const Id root = find(n);
+    auto [it, inserted] = groupOfRoot.emplace(root, groups.size());
+    if (inserted) groups.emplace_back();
+    groups[it->second].push_back(n);
+  }
+  return groups;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <DocumentItem.h>
+
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Directed dependency graph between document items keyed by DocumentItem::Id
+// - Upstream edges: items a node consumes (sketch of an extrude, source of a move, plane of a sketch)
+// - Downstream edges: reverse adjacency, kept in sync for invalidation walks
+class DependencyGraph
+{
+public:
+  using Id = DocumentItem::Id;
+
+  void clear() { m_nodes.clear(); }
+  void reserve(std::size_t nodes) { m_nodes.reserve(nodes); }
+
+  // Replace all upstream edges of a node (zero ids are ignored)
+  void setUpstream(Id node, const std::vector<Id>& upstream);
+
+  // Detach a node from its upstream; keep it as a placeholder while dependents still reference it
+  void remove(Id node);
+
+  bool contains(Id node) const { return m_nodes.find(node) != m_nodes.end(); }
+
+  const std::vector<Id>& upstream(Id node) const;
+  const std::vector<Id>& downstream(Id node) const;
+
+  // All nodes reachable downstream from the seeds (seeds included)
+  std::unordered_set<Id> closure(const std::vector<Id>& seeds) const;
+
+  // Split nodes into independent groups: nodes linked directly or through a shared upstream
+  // node end up together. Upstream nodes matching walkThrough are followed further, so nodes
+  // sharing an input behind them (e.g. a result rebuilt on demand) group together as well.
+  // Input order is preserved inside each group.
+  std::vector<std::vector<Id>> partition(const std::vector<Id>& nodes,
+                                         const std::function<bool(Id)>& walkThrough = {}) const;
+
+private:
+  struct Node
+  {
+    std::vector<Id> up;
+    std::vector<Id> down;
+  };
+
+  static void eraseValue(std::vector<Id>& v, Id value);
+
+  std::unordered_map<Id, Node> m_nodes;
+};
@@ -0,0 +1,123 @@
+#include "DiskShapeCache.h"
+
+#include <BinTools.hxx>
+#include <Standard_Failure.hxx>
+
+#include <cstdio>
+#include <fstream>
+#include <system_error>
+
+namespace {
+// Bump when the on-disk layout changes; older files are then ignored
+constexpr const char* kFileSuffix = ".v1.bin";
+}
+
+DiskShapeCache::DiskShapeCache(std::filesystem::path directory)
+  : m_dir(std::move(directory))
+{
+  std::error_code ec;
+  std::filesystem::create_directories(m_dir, ec);
+}
+
+std::filesystem::path DiskShapeCache::directoryFor(const std::filesystem::path& documentFile)
+{
+  std::filesystem::path dir = documentFile;
+  dir += ".cache";
+  return dir;
+}
+
+std::filesystem::path DiskShapeCache::pathFor(Key key) const
+{
+  char name[17];
+  std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+  return m_dir / (std::string(name) + kFileSuffix);
+}
+
+bool DiskShapeCache::load(Key key, TopoDS_Shape& out)
+{
+  const std::filesystem::path file = pathFor(key);
+  std::ifstream in(file, std::ios::binary);
+  if (!in)
+  {
+    ++m_misses;
+    return false;
+  }
+  TopoDS_Shape shape;
+  try
+  {
+    BinTools::Read(shape, in);
+  }
+  catch (const Standard_Failure&)
+  {
+    shape.Nullify();
+  }
+  if (shape.IsNull() || in.bad())
+  {
+    // Truncated or foreign file: drop it so the next store replaces it
+    in.close();
+    std::error_code ec;
+    std::filesystem::remove(file, ec);
+    ++m_misses;
+    return false;
+  }
+  out = shape;
+  ++m_hits;
+  return true;
+}
+
+bool DiskShapeCache::store(Key key, const TopoDS_Shape& shape)
+{
+  if (shape.IsNull()) return false;
+  const std::filesystem::path file = pathFor(key);
+  std::filesystem::path tmp = file;
+  tmp += ".tmp" + std::to_string(m_tmpCounter++);
+  {
+    std::ofstream os(tmp, std::ios::binary | std::ios::trunc);
+    if (!os) return false;
+    bool ok = false;
+    try
+    {
+      BinTools::Write(shape, os); // the stream overload reports errors through the stream only
+      ok = os.good();
+    }
+    catch (const Standard_Failure&)
+    {
+      ok = false;
+    }
+    os.close();
+    if (!ok || os.fail())
+    {
+      std::error_code ec;
+      std::filesystem::remove(tmp, ec);
+      return false;
+    }
+  }
+  std::error_code ec;
+  std::filesystem::rename(tmp, file, ec);
+  if (ec)
+  {
+    std::filesystem::remove(tmp, ec);
+    return false;
+  }
+  ++m_writes;
+  return true;
+}
+
+void DiskShapeCache::clear()
+{
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator(m_dir, ec))
+  {
+    if (entry.path().extension() == ".bin" || entry.path().filename().string().find(".tmp") != std::string::npos)
+      std::filesystem::remove(entry.path(), ec);
+  }
+}
+
+DiskShapeCache::Stats DiskShapeCache::stats() const
+{
+  Stats s;
+  s.hits = m_hits.load();
+  s.misses = m_misses.load();
+  s.writes = m_writes.load();
+  return s;
+}
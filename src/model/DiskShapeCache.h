@@ -0,0 +1,49 @@
+#pragma once
+
+#include <TopoDS_Shape.hxx>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+// Persistent second level behind ShapeCache: one OCCT binary (BinTools) file per result key
+// - Lives next to the document (see directoryFor) so reopening skips Feature::execute()
+// - Keys are content hashes, so stale entries are never returned, only left unused
+// - Writes go to a temporary file and are renamed into place; unreadable files count as misses
+class DiskShapeCache
+{
+public:
+  using Key = std::uint64_t;
+
+  struct Stats
+  {
+    std::size_t hits{0};
+    std::size_t misses{0};
+    std::size_t writes{0};
+  };
+
+  explicit DiskShapeCache(std::filesystem::path directory);
+
+  // Conventional cache directory for a document file: "<file>.cache"
+  static std::filesystem::path directoryFor(const std::filesystem::path& documentFile);
+
+  const std::filesystem::path& directory() const { return m_dir; }
+
+  bool load(Key key, TopoDS_Shape& out);
+  bool store(Key key, const TopoDS_Shape& shape);
+
+  // Remove every cached file
+  void  clear();
+  Stats stats() const;
+
+private:
+  std::filesystem::path pathFor(Key key) const;
+
+  std::filesystem::path    m_dir;
+  std::atomic<std::size_t> m_hits{0};
+  std::atomic<std::size_t> m_misses{0};
+  std::atomic<std::size_t> m_writes{0};
+  std::atomic<std::size_t> m_tmpCounter{0};
+};
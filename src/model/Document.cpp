@@ -7,7 +7,62 @@
 #include <Datum.h>
 #include <AxeFeature.h>
 #include "DocumentInitializer.h"
+#include <ContentHash.h>
+#include <OSD_Parallel.hxx>
+#include <TopAbs_ShapeEnum.hxx>
+#include <TopExp.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <Message_ProgressScope.hxx>
 #include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+
+namespace {
+// Kind-based casts: DocumentItem::kind() names the concrete class, so no RTTI walk is needed
+bool isFeatureKind(DocumentItem::Kind k)
+{
+  switch (k)
+  {
+    case DocumentItem::Kind::BoxFeature:
+    case DocumentItem::Kind::CylinderFeature:
+    case DocumentItem::Kind::ExtrudeFeature:
+    case DocumentItem::Kind::MoveFeature:
+    case DocumentItem::Kind::PlaneFeature:
+    case DocumentItem::Kind::PointFeature:
+    case DocumentItem::Kind::AxeFeature:
+      return true;
+    case DocumentItem::Kind::Sketch:
+      return false;
+  }
+  return false;
+}
+
+// Planes, axes and origin point are fixed-geometry helpers, not bodies
+bool isDatumKind(DocumentItem::Kind k)
+{
+  return k == DocumentItem::Kind::PlaneFeature || k == DocumentItem::Kind::PointFeature || k == DocumentItem::Kind::AxeFeature;
+}
+
+Handle(Feature) asFeature(const Handle(DocumentItem)& item)
+{
+  return isFeatureKind(item->kind()) ? Handle(Feature)(static_cast<Feature*>(item.get())) : Handle(Feature)();
+}
+
+template <class T>
+Handle(T) kindCast(const Handle(DocumentItem)& item)
+{
+  return item->kind() == T::StaticKind ? Handle(T)(static_cast<T*>(item.get())) : Handle(T)();
+}
+
+int countSubShapes(const TopoDS_Shape& s, TopAbs_ShapeEnum type)
+{
+  if (s.IsNull()) return 0;
+  TopTools_IndexedMapOfShape m;
+  TopExp::MapShapes(s, type, m);
+  return m.Extent();
+}
+}
 
 Document::Document()
 {
@@ -15,29 +70,57 @@ Document::Document()
   m_datum = std::make_shared<Datum>();
   // Populate default geometry (planes and optional origin point)
   DocumentInitializer::initialize(*this);
+  m_journal.clear(); // defaults are not undoable
+  m_structureChanged = false;
 }
 
-void Document::clear()
+Document::~Document()
 {
-  m_items.Clear();
+  // Features may outlive the document: detach them from its evaluator and snapshot tracker
+  for (const Handle(DocumentItem)& di : m_items)
+  {
+    dropPending(di);
+    detach(di);
+  }
+}
+
+void Document::clear(bool defaults)
+{
+  for (const Handle(DocumentItem)& di : m_items)
+  {
+    dropPending(di);
+    detach(di);
+  }
+  m_items.clear();
   m_registry.clear();
   m_sketchList.clear();
   m_featuresCache.Clear();
   m_featuresCacheDirty = true;
+  m_graph.clear();
+  m_resultKeys.clear();
+  m_rollback = -1;
+  m_rolledBack.clear();
+  m_checkpoints.clear();
+  m_pinnedUpTo = 0;
   // Keep Datum persistent; recreate default if missing
   if (!m_datum) m_datum = std::make_shared<Datum>();
   // Clear planes container
   m_planes.Clear();
   // Recreate default geometry using current Datum settings
-  DocumentInitializer::initialize(*this);
+  if (defaults) DocumentInitializer::initialize(*this);
+  m_journal.clear();
 }
 
 void Document::addItem(const Handle(DocumentItem)& item)
 {
   if (!item.IsNull())
   {
-    m_items.Append(item);
+    m_items.append(item);
+    attach(item);
+    m_journal.record({UndoJournal::Command::Type::Insert, item, m_items.Size()});
     m_featuresCacheDirty = true;
+    m_structureChanged = true;
+    m_graph.setUpstream(item->id(), upstreamOf(item));
     if (Handle(PlaneFeature) pf = Handle(PlaneFeature)::DownCast(item); !pf.IsNull())
     {
       m_planes.Append(pf);
@@ -45,13 +128,24 @@ void Document::addItem(const Handle(DocumentItem)& item)
   }
 }
 
+void Document::reserve(std::size_t items)
+{
+  m_items.reserve(items);
+  m_graph.reserve(items);
+  std::lock_guard<std::mutex> lock(m_snapshotMutex);
+  m_snapshotChanged.reserve(items);
+}
+
 void Document::insertItem(int index1, const Handle(DocumentItem)& item)
 {
   if (item.IsNull()) return;
-  if (index1 < 1) index1 = 1;
-  if (index1 > m_items.Size() + 1) index1 = m_items.Size() + 1;
-  m_items.InsertBefore(index1, item);
+  shiftRollback(index1, +1);
+  m_items.insert(index1, item);
+  attach(item);
+  m_journal.record({UndoJournal::Command::Type::Insert, item, std::clamp(index1, 1, m_items.Size())});
   m_featuresCacheDirty = true;
+  m_structureChanged = true;
+  m_graph.setUpstream(item->id(), upstreamOf(item));
   if (Handle(PlaneFeature) pf = Handle(PlaneFeature)::DownCast(item); !pf.IsNull())
   {
     m_planes.Append(pf);
@@ -63,123 +157,994 @@ const NCollection_Sequence<Handle(Feature)>& Document::features() const
   if (m_featuresCacheDirty)
   {
     m_featuresCache.Clear();
-    for (NCollection_Sequence<Handle(DocumentItem)>::Iterator it(m_items); it.More(); it.Next())
+    for (const Handle(DocumentItem)& di : m_items)
     {
-      const Handle(DocumentItem)& di = it.Value();
-      if (Handle(Feature) f = Handle(Feature)::DownCast(di); !f.IsNull()) {
-        // Exclude fixed-geometry helpers (planes, axes and origin point) from generic features
-        if (Handle(PlaneFeature)::DownCast(f).IsNull() && Handle(PointFeature)::DownCast(f).IsNull() && Handle(AxeFeature)::DownCast(f).IsNull())
-          m_featuresCache.Append(f);
-      }
+      // Exclude fixed-geometry helpers (planes, axes and origin point) from generic features
+      const DocumentItem::Kind k = di->kind();
+      if (isFeatureKind(k) && !isDatumKind(k)) m_featuresCache.Append(Handle(Feature)(static_cast<Feature*>(di.get())));
     }
     m_featuresCacheDirty = false;
   }
   return m_featuresCache;
 }
 
-void Document::recompute()
+std::vector<DocumentItem::Id> Document::upstreamOf(const Handle(DocumentItem)& item) const
+{
+  std::vector<DocumentItem::Id> up;
+  // Links live in the payload; a deferred item is dirty, so refreshDependencies() fills them in
+  if (!item->isLoaded()) return up;
+  if (Handle(ExtrudeFeature) ef = kindCast<ExtrudeFeature>(item); !ef.IsNull())
+  {
+    up.push_back(ef->sketchId());
+    if (ef->sketch()) up.push_back(ef->sketch()->id());
+  }
+  else if (Handle(MoveFeature) mf = kindCast<MoveFeature>(item); !mf.IsNull())
+  {
+    up.push_back(mf->sourceId());
+    if (!mf->source().IsNull()) up.push_back(mf->source()->id());
+  }
+  else if (item->kind() == DocumentItem::Kind::Sketch)
+  {
+    // Timeline entries mirror registered sketches by id; the registered one carries the plane link
+    std::shared_ptr<Sketch> sk = findSketch(item->id());
+    if (sk) up.push_back(sk->planeId());
+    else if (Handle(Sketch) hs = kindCast<Sketch>(item); !hs.IsNull()) up.push_back(hs->planeId());
+  }
+  return up;
+}
+
+void Document::setParam(const Handle(Feature)& f, Feature::ParamKey key, const Feature::ParamValue& value)
+{
+  if (!f.IsNull()) f->setParam(key, value); // journaled through m_journalRecorder
+}
+
+void Document::setSuppressed(const Handle(Feature)& f, bool on)
+{
+  if (!f.IsNull()) f->setSuppressed(on);
+}
+
+void Document::JournalRecorder::paramChanging(Feature& f, Feature::ParamKey key, const Feature::ParamValue* before,
+                                              const Feature::ParamValue& after)
+{
+  UndoJournal::Command c{UndoJournal::Command::Type::Param, Handle(Feature)(&f)};
+  c.key = key;
+  if (before) c.before = *before;
+  c.after = after;
+  doc.m_journal.record(std::move(c));
+}
+
+void Document::JournalRecorder::suppressionChanging(Feature& f, bool after)
+{
+  UndoJournal::Command c{UndoJournal::Command::Type::Suppress, Handle(Feature)(&f)};
+  c.suppressedBefore = !after;
+  c.suppressedAfter = after;
+  doc.m_journal.record(std::move(c));
+}
+
+bool Document::undo()
+{
+  if (inTransaction() || !m_journal.canUndo()) return false;
+  bool chained = false;
+  do
+  {
+    UndoJournal::Command c = m_journal.takeUndo();
+    chained = c.chained; // part of a transaction: keep going back to its first command
+    apply(c, false);
+    m_journal.pushRedo(std::move(c));
+  } while (chained && m_journal.canUndo());
+  return true;
+}
+
+bool Document::redo()
+{
+  if (inTransaction() || !m_journal.canRedo()) return false;
+  do
+  {
+    UndoJournal::Command c = m_journal.takeRedo();
+    apply(c, true);
+    m_journal.pushUndo(std::move(c));
+  } while (m_journal.nextRedoChained());
+  return true;
+}
+
+void Document::apply(const UndoJournal::Command& c, bool forward)
+{
+  using Type = UndoJournal::Command::Type;
+  const bool wasEnabled = m_journal.enabled();
+  m_journal.setEnabled(false);
+  switch (c.type)
+  {
+    case Type::Insert:
+    case Type::Remove:
+      if ((c.type == Type::Insert) == forward)
+      {
+        c.item->markDirty(); // its result was dropped when it left the timeline
+        insertItem(c.index1, c.item);
+      }
+      else
+      {
+        removeItem(c.item);
+        // Results of items parked in the journal are dropped to keep history small; the
+        // result cache usually brings them back on reinsertion
+        if (Handle(Feature) f = asFeature(c.item); !f.IsNull()) f->setShape(TopoDS_Shape());
+      }
+      break;
+    case Type::Param:
+      if (Handle(Feature) f = asFeature(c.item); !f.IsNull())
+      {
+        const std::optional<Feature::ParamValue>& v = forward ? c.after : c.before;
+        if (v) f->setParam(c.key, *v);
+        else f->params().erase(c.key); // non-const params() marks the feature dirty
+      }
+      break;
+    case Type::Suppress:
+      if (Handle(Feature) f = asFeature(c.item); !f.IsNull()) f->setSuppressed(forward ? c.suppressedAfter : c.suppressedBefore);
+      break;
+  }
+  m_journal.setEnabled(wasEnabled);
+}
+
+void Document::setLazyEvaluation(bool on)
+{
+  m_lazyEvaluation = on;
+  if (on) return;
+  // Pending features are still dirty, so the next recompute executes them; evicted (clean)
+  // results stay pending
+  for (const Handle(DocumentItem)& di : m_items)
+  {
+    if (di->isDirty()) dropPending(di);
+  }
+}
+
+void Document::LazyEvaluator::evaluate(const Feature& f)
+{
+  doc.evaluatePending(f);
+}
+
+void Document::evaluatePending(const Feature& cf)
+{
+  Handle(Feature) f(const_cast<Feature*>(&cf)); // items are owned (and mutated) by the document
+  bool stale = false;
+  {
+    // Independent branches may reach the same evicted source concurrently: the first caller
+    // builds it, the others wait for that build. Execution runs unlocked because it can pull
+    // further upstream results.
+    std::unique_lock<std::mutex> lock(m_pendingMutex);
+    const std::thread::id self = std::this_thread::get_id();
+    auto [it, first] = m_evaluating.emplace(f->id(), self);
+    if (!first)
+    {
+      if (it->second == self) return; // re-entered from its own build
+      m_evaluated.wait(lock, [&] { return m_evaluating.find(f->id()) == m_evaluating.end(); });
+      return;
+    }
+    if (!f->isPendingEvaluation())
+    {
+      // Built by another caller between its shape() check and this lock
+      m_evaluating.erase(it);
+      return;
+    }
+    stale = lazyInputsChanged(*f);
+    m_pendingRevisions.erase(f->id());
+  }
+  try
+  {
+    if (stale)
+    {
+      // Edited since recompute(): the planned key no longer matches, so build without caching and
+      // leave the feature dirty for the next recompute
+      f->execute();
+      touched(*f);
+    }
+    else
+    {
+      executeFeature(f, Message_ProgressRange());
+      f->clearDirty();
+    }
+  }
+  catch (...)
+  {
+    finishPending(*f);
+    throw;
+  }
+  finishPending(*f);
+}
+
+void Document::finishPending(Feature& f)
+{
+  // The evaluator goes only once the result is in place: readers that see it cleared skip the lock
+  std::lock_guard<std::mutex> lock(m_pendingMutex);
+  f.setEvaluator(nullptr);
+  m_evaluating.erase(f.id());
+  m_evaluated.notify_all();
+}
+
+bool Document::lazyInputsChanged(const DocumentItem& item) const
 {
-  // Map already-executed features by id for downstream dependency resolution
-  std::unordered_map<DocumentItem::Id, Handle(Feature)> featureById;
-  for (NCollection_Sequence<Handle(DocumentItem)>::Iterator it(m_items); it.More(); it.Next()) {
-    const Handle(DocumentItem)& di = it.Value();
-    Handle(Feature) f = Handle(Feature)::DownCast(di);
+  if (auto it = m_pendingRevisions.find(item.id()); it != m_pendingRevisions.end())
+  {
+    if (it->second != item.revision()) return true;
+  }
+  else if (item.isDirty())
+  {
+    return true; // not planned, edited after the last recompute
+  }
+  for (DocumentItem::Id up : m_graph.upstream(item.id()))
+  {
+    const DocumentItem* input = nullptr;
+    std::shared_ptr<Sketch> sk;
+    if (Handle(DocumentItem) di = m_items.find(up); !di.IsNull() && isFeatureKind(di->kind()))
+      input = di.get();
+    else if ((sk = findSketch(up)))
+      input = sk.get();
+    else if (const auto* ef = dynamic_cast<const ExtrudeFeature*>(&item); ef && ef->sketch() && ef->sketch()->id() == up)
+      input = ef->sketch().get();
+    if (input && lazyInputsChanged(*input)) return true;
+  }
+  return false;
+}
+
+void Document::dropPending(const Handle(DocumentItem)& item)
+{
+  if (item.IsNull() || !isFeatureKind(item->kind())) return;
+  auto* f = static_cast<Feature*>(item.get());
+  if (!f->isPendingEvaluation()) return;
+  std::lock_guard<std::mutex> lock(m_pendingMutex);
+  f->setEvaluator(nullptr);
+  m_pendingRevisions.erase(f->id());
+}
+
+void Document::evict(const Handle(Feature)& f)
+{
+  // Clean and not pending: the planned key is current, so evaluatePending() rebuilds it as is
+  f->setShape(TopoDS_Shape());
+  std::lock_guard<std::mutex> lock(m_pendingMutex);
+  f->setEvaluator(&m_lazyEvaluator);
+  m_pendingRevisions[f->id()] = f->revision();
+}
+
+void Document::attach(const Handle(DocumentItem)& item)
+{
+  item->setObserver(&m_snapshotTracker);
+  if (isFeatureKind(item->kind())) static_cast<Feature*>(item.get())->setEditObserver(&m_journalRecorder);
+  touched(*item);
+  m_snapshotStructure = true;
+}
+
+void Document::detach(const Handle(DocumentItem)& item)
+{
+  item->setObserver(nullptr);
+  if (isFeatureKind(item->kind())) static_cast<Feature*>(item.get())->setEditObserver(nullptr);
+  m_snapshotStructure = true;
+}
+
+void Document::SnapshotTracker::itemChanged(const DocumentItem& item)
+{
+  doc.touched(item);
+}
+
+void Document::touched(const DocumentItem& item) const
+{
+  std::lock_guard<std::mutex> lock(m_snapshotMutex);
+  m_snapshotChanged.insert(item.id());
+}
+
+namespace {
+DocumentSnapshot::ItemPtr makeRecord(const Handle(DocumentItem)& di)
+{
+  auto rec = std::make_shared<DocumentSnapshot::Item>();
+  rec->id = di->id();
+  rec->kind = di->kind();
+  rec->data = di->serialize();
+  rec->dirty = di->isDirty();
+  if (isFeatureKind(di->kind()))
+  {
+    const auto* f = static_cast<const Feature*>(di.get());
+    rec->name = f->name().ToCString();
+    rec->shape = f->currentShape();
+    rec->suppressed = f->isSuppressed();
+    rec->datum = f->isDatumRelated();
+  }
+  return rec;
+}
+}
+
+std::shared_ptr<const DocumentSnapshot> Document::snapshot()
+{
+  std::unordered_set<DocumentItem::Id> changed;
+  {
+    std::lock_guard<std::mutex> lock(m_snapshotMutex);
+    changed.swap(m_snapshotChanged);
+  }
+  const bool structure = std::exchange(m_snapshotStructure, false);
+  if (m_snapshot && !structure && changed.empty()) return m_snapshot;
+
+  auto next = std::make_shared<DocumentSnapshot>();
+  next->m_version = m_snapshot ? m_snapshot->m_version + 1 : 1;
+  next->m_size = static_cast<std::size_t>(m_items.Size());
+  if (m_snapshot && !structure)
+  {
+    // Same order: share the table and copy only the chunks holding changed items
+    next->m_chunks = m_snapshot->m_chunks;
+    next->m_index = m_snapshot->m_index;
+    std::unordered_map<std::size_t, std::shared_ptr<DocumentSnapshot::Chunk>> copied;
+    for (DocumentItem::Id id : changed)
+    {
+      auto it = next->m_index->find(id);
+      if (it == next->m_index->end()) continue; // not in the timeline (e.g. a linked profile)
+      const std::size_t c = it->second / DocumentSnapshot::kChunkSize;
+      auto& chunk = copied[c];
+      if (!chunk)
+      {
+        chunk = std::make_shared<DocumentSnapshot::Chunk>(*next->m_chunks[c]);
+        next->m_chunks[c] = chunk;
+      }
+      (*chunk)[it->second % DocumentSnapshot::kChunkSize] = makeRecord(m_items.Value(static_cast<int>(it->second) + 1));
+      ++next->m_built;
+    }
+  }
+  else
+  {
+    // Order changed: rebuild the table, still reusing the records of unchanged items
+    auto index = std::make_shared<DocumentSnapshot::Index>();
+    index->reserve(next->m_size);
+    std::shared_ptr<DocumentSnapshot::Chunk> chunk;
+    std::size_t pos = 0;
+    for (const Handle(DocumentItem)& di : m_items)
+    {
+      if (pos % DocumentSnapshot::kChunkSize == 0)
+      {
+        chunk = std::make_shared<DocumentSnapshot::Chunk>();
+        chunk->reserve(DocumentSnapshot::kChunkSize);
+        next->m_chunks.push_back(chunk);
+      }
+      DocumentSnapshot::ItemPtr rec;
+      if (m_snapshot && changed.find(di->id()) == changed.end())
+      {
+        if (auto it = m_snapshot->m_index->find(di->id()); it != m_snapshot->m_index->end())
+          rec = m_snapshot->itemPtr(it->second);
+      }
+      if (!rec)
+      {
+        rec = makeRecord(di);
+        ++next->m_built;
+      }
+      chunk->push_back(std::move(rec));
+      index->emplace(di->id(), pos++);
+    }
+    next->m_index = std::move(index);
+  }
+  m_snapshot = std::move(next);
+  return m_snapshot;
+}
+
+void Document::setRetention(Retention policy, std::size_t budgetBytes)
+{
+  m_retention = policy;
+  m_retentionBudget = budgetBytes;
+}
+
+void Document::applyRetention()
+{
+  if (m_retention == Retention::KeepAll) return;
+  // Candidates: built, clean bodies (datum helpers are tiny and always shown)
+  struct Candidate
+  {
+    Handle(Feature) f;
+    int             rank; // 0 hidden intermediate, 1 visible intermediate, 2 leaf
+    std::size_t     bytes;
+  };
+  std::vector<Candidate> candidates;
+  std::size_t total = 0;
+  for (const Handle(DocumentItem)& di : m_items)
+  {
+    Handle(Feature) f = asFeature(di);
+    if (f.IsNull() || isDatumKind(di->kind()) || f->isDirty() || f->isPendingEvaluation() || f->currentShape().IsNull())
+      continue;
+    const bool leaf = m_graph.downstream(f->id()).empty();
+    const int rank = leaf ? 2 : (f->isSuppressed() ? 0 : 1);
+    if (m_retention == Retention::LeafOrVisible)
+    {
+      if (rank == 0) evict(f);
+      continue;
+    }
+    const std::size_t bytes = ShapeCache::estimateBytes(f->currentShape());
+    total += bytes;
+    candidates.push_back({f, rank, bytes});
+  }
+  if (m_retention != Retention::ByteBudget || total <= m_retentionBudget) return;
+  // Stable: timeline order inside each rank
+  std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) { return a.rank < b.rank; });
+  for (const Candidate& c : candidates)
+  {
+    if (total <= m_retentionBudget) break;
+    evict(c.f);
+    total -= c.bytes;
+  }
+}
+
+Document::MemoryStats Document::memoryStats() const
+{
+  MemoryStats stats;
+  for (const Handle(DocumentItem)& di : m_items)
+  {
+    Handle(Feature) f = asFeature(di);
     if (f.IsNull()) continue;
-    if (!f.IsNull() && !f->isSuppressed()) {
-      // Resolve dependencies for known feature types
-      if (Handle(ExtrudeFeature) ef = Handle(ExtrudeFeature)::DownCast(f); !ef.IsNull())
+    MemoryStats::Entry e;
+    e.id = f->id();
+    e.kind = f->kind();
+    e.name = f->name().ToCString();
+    e.bytes = ShapeCache::estimateBytes(f->currentShape());
+    e.evicted = f->isPendingEvaluation() && !f->isDirty();
+    stats.retainedBytes += e.bytes;
+    stats.evictedCount += e.evicted ? 1 : 0;
+    stats.features.push_back(std::move(e));
+  }
+  for (const auto& kv : m_checkpoints) stats.checkpointBytes += ShapeCache::estimateBytes(kv.second.shape);
+  if (m_shapeCache) stats.cacheBytes = m_shapeCache->stats().bytes;
+  return stats;
+}
+
+Document::GeometryMemory Document::geometryMemory() const
+{
+  GeometryMemory memory;
+  ShapeMemory    counter;
+  for (const Handle(DocumentItem)& di : m_items)
+  {
+    Handle(Feature) f = asFeature(di);
+    if (f.IsNull()) continue;
+    GeometryMemory::Entry e;
+    e.id = f->id();
+    e.name = f->name().ToCString();
+    e.usage = ShapeMemory::measure(f->currentShape());
+    e.added = counter.add(f->currentShape());
+    memory.features.push_back(std::move(e));
+  }
+  memory.total = counter.total();
+  return memory;
+}
+
+void Document::setRollback(int index1)
+{
+  m_rollback = std::clamp(index1, 0, m_items.Size());
+}
+
+int Document::rollbackIndex() const
+{
+  return m_rollback < 0 ? m_items.Size() : std::min(m_rollback, m_items.Size());
+}
+
+bool Document::isRolledBack(const Handle(DocumentItem)& item) const
+{
+  if (item.IsNull() || m_rollback < 0) return false;
+  const int idx = timelineIndex(item);
+  return idx > rollbackIndex();
+}
+
+void Document::setCheckpointInterval(int steps)
+{
+  m_checkpointInterval = std::max(steps, 0);
+  m_checkpoints.clear();
+  m_pinnedUpTo = 0;
+}
+
+void Document::shiftRollback(int index1, int delta)
+{
+  // Positions from index1 on moved: re-pin their blocks on the next recompute
+  m_pinnedUpTo = std::min(m_pinnedUpTo, index1 - 1);
+  // Inserting right after the marker counts as inserting at it: the new item stays active
+  if (m_rollback < 0) return;
+  if (delta > 0 && index1 <= m_rollback + 1) m_rollback += delta;
+  else if (delta < 0 && index1 <= m_rollback) m_rollback += delta;
+}
+
+void Document::loadDeferred()
+{
+  std::vector<const DocumentItem*> pending;
+  for (const Handle(DocumentItem)& di : m_items)
+  {
+    if (!di->isLoaded()) pending.push_back(di.get());
+  }
+  for (const auto& sk : m_sketchList)
+  {
+    if (sk && !sk->isLoaded()) pending.push_back(sk.get());
+  }
+  const std::size_t kBlock = 256;
+  const int blocks = static_cast<int>((pending.size() + kBlock - 1) / kBlock);
+  OSD_Parallel::For(0, blocks, [&](int b) {
+    const std::size_t last = std::min(pending.size(), static_cast<std::size_t>(b + 1) * kBlock);
+    for (std::size_t i = static_cast<std::size_t>(b) * kBlock; i < last; ++i) pending[i]->ensureLoaded();
+  }, blocks < 2);
+}
+
+void Document::refreshDependencies()
+{
+  loadDeferred(); // links live in the payloads
+  // Links only change through setters that mark items dirty, so clean items keep their edges
+  for (const Handle(DocumentItem)& di : m_items)
+  {
+    if (di->isDirty()) m_graph.setUpstream(di->id(), upstreamOf(di));
+  }
+  for (const auto& sk : m_sketchList)
+  {
+    if (sk && sk->isDirty()) m_graph.setUpstream(sk->id(), {sk->planeId()});
+  }
+}
+
+void Document::recompute(const Message_ProgressRange& range)
+{
+  if (inTransaction()) return; // commit() recomputes once
+  notifyChange(recomputeNow(range));
+}
+
+std::vector<DocumentItem::Id> Document::recomputeNow(const Message_ProgressRange& range)
+{
+  m_lastProfile = RecomputeProfile();
+  m_profileOrigin = std::chrono::steady_clock::now();
+  refreshDependencies();
+
+  // Seed invalidation with dirty items, then extend to everything downstream of them
+  std::vector<DocumentItem::Id> seeds;
+  std::vector<std::shared_ptr<Sketch>> runtimeSketches; // profiles linked directly to extrudes
+  for (const Handle(DocumentItem)& di : m_items)
+  {
+    if (di->isDirty()) seeds.push_back(di->id());
+  }
+  for (const Handle(DocumentItem)& di : m_items.ofKind(DocumentItem::Kind::ExtrudeFeature))
+  {
+    const auto* ef = static_cast<const ExtrudeFeature*>(di.get());
+    if (!ef->sketch()) continue;
+    runtimeSketches.push_back(ef->sketch());
+    if (ef->sketch()->isDirty()) seeds.push_back(ef->id());
+  }
+  for (const auto& sk : m_sketchList)
+  {
+    if (sk && sk->isDirty()) seeds.push_back(sk->id());
+  }
+  const std::unordered_set<DocumentItem::Id> affected = m_graph.closure(seeds);
+  for (DocumentItem::Id id : affected) m_resultKeys.erase(id);
+
+  // Resolve links in timeline order and collect the features to execute
+  std::vector<Handle(Feature)> plan;
+  std::unordered_set<DocumentItem::Id> planned;
+  std::unordered_map<DocumentItem::Id, Handle(Feature)> featureById; // features seen so far
+  const int active = rollbackIndex();
+  int pos = 0;
+  for (const Handle(DocumentItem)& di : m_items) {
+    ++pos;
+    Handle(Feature) f = asFeature(di);
+    if (f.IsNull()) continue;
+    if (pos > active)
+    {
+      // Rolled back: drop the result (checkpoints keep it) and rebuild it once reactivated
+      dropPending(f);
+      if (!f->currentShape().IsNull())
       {
-        if (!ef->sketch() && ef->sketchId() != 0)
+        f->setShape(TopoDS_Shape());
+        m_rolledBack.insert(f->id());
+      }
+      continue;
+    }
+    featureById[f->id()] = f;
+    const bool reactivated = m_rolledBack.erase(f->id()) != 0;
+    if (!reactivated && affected.find(f->id()) == affected.end()) continue;
+    // Suppressed results are only rebuilt when something consumes them (e.g. a Move source);
+    // otherwise un-suppressing marks the feature dirty again.
+    if (f->isSuppressed() && m_graph.downstream(f->id()).empty())
+    {
+      f->clearDirty();
+      continue;
+    }
+    // Resolve dependencies for known feature types
+    if (Handle(ExtrudeFeature) ef = kindCast<ExtrudeFeature>(f); !ef.IsNull())
+    {
+      if (!ef->sketch() && ef->sketchId() != 0)
+      {
+        if (auto sk = findSketch(ef->sketchId()))
         {
-          if (auto sk = findSketch(ef->sketchId()))
-          {
-            ef->setSketch(sk);
-          }
+          ef->setSketch(sk);
         }
       }
-      // Resolve MoveFeature source by id; allow using suppressed sources as providers
-      if (Handle(MoveFeature) mf = Handle(MoveFeature)::DownCast(f); !mf.IsNull())
+    }
+    // Resolve MoveFeature source by id among previous items; allow using suppressed sources as providers
+    if (Handle(MoveFeature) mf = kindCast<MoveFeature>(f); !mf.IsNull())
+    {
+      if (mf->source().IsNull() && mf->sourceId() != 0)
       {
-        if (mf->source().IsNull() && mf->sourceId() != 0)
+        auto fit = featureById.find(mf->sourceId());
+        if (fit != featureById.end() && fit->second != f)
         {
-          Handle(Feature) src;
-          auto fit = featureById.find(mf->sourceId());
-          if (fit != featureById.end())
-          {
-            src = fit->second;
-          }
-          if (src.IsNull())
-          {
-            // search previous items for a feature with the same id (even if suppressed)
-            for (NCollection_Sequence<Handle(DocumentItem)>::Iterator jt(m_items); jt.More(); jt.Next())
-            {
-              const Handle(DocumentItem)& prev = jt.Value();
-              if (prev == di) break; // stop at current
-              Handle(Feature) pf = Handle(Feature)::DownCast(prev);
-              if (!pf.IsNull() && pf->id() == mf->sourceId()) { src = pf; break; }
-            }
-          }
-          if (!src.IsNull())
+          const Handle(Feature)& src = fit->second;
+          // ensure source has valid shape, even if suppressed
+          if (src->currentShape().IsNull() && !src->isPendingEvaluation() && planned.insert(src->id()).second)
           {
-            // ensure source has valid shape, even if suppressed
-            if (src->shape().IsNull()) { src->execute(); }
-            mf->setSource(src);
+            resultKey(*src, featureById);
+            plan.push_back(src);
           }
+          mf->setSource(src);
         }
       }
-      f->execute();
-      // cache executed (non-suppressed and also MoveFeature) for downstream consumers
-      featureById[f->id()] = f;
+    }
+    // Keys are computed here, single-threaded, so execution only reads them
+    resultKey(*f, featureById);
+    planned.insert(f->id());
+    plan.push_back(f);
+  }
+
+  if (m_profiling)
+    m_lastProfile.planUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - m_profileOrigin).count();
+  if (m_lazyEvaluation)
+  {
+    // Results are built on first shape() access; the planned revision detects later edits
+    for (const Handle(Feature)& f : plan)
+    {
+      f->setEvaluator(&m_lazyEvaluator);
+      m_pendingRevisions[f->id()] = f->revision();
     }
   }
+  else
+  {
+    for (const Handle(Feature)& f : plan) dropPending(f); // executed now
+    executePlan(plan, range);
+  }
+  recordCheckpoints(plan, active);
+  applyRetention();
+
+  // Non-feature inputs have been consumed by every affected dependent
+  for (const Handle(DocumentItem)& di : m_items)
+  {
+    if (!isFeatureKind(di->kind())) di->clearDirty();
+  }
+  for (const auto& sk : m_sketchList)
+  {
+    if (sk) sk->clearDirty();
+  }
+  for (const auto& sk : runtimeSketches) sk->clearDirty();
+  if (m_profiling)
+    m_lastProfile.totalUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - m_profileOrigin).count();
+
+  std::vector<DocumentItem::Id> rebuilt;
+  rebuilt.reserve(plan.size());
+  for (const Handle(Feature)& f : plan)
+  {
+    if (!f->isDirty() || f->isPendingEvaluation()) rebuilt.push_back(f->id());
+  }
+  return rebuilt;
 }
 
-void Document::removeLast()
+void Document::notifyChange(std::vector<DocumentItem::Id> recomputed)
 {
-  if (!m_items.IsEmpty())
+  Change change;
+  change.recomputed = std::move(recomputed);
+  change.structure = std::exchange(m_structureChanged, false);
+  if (change.recomputed.empty() && !change.structure) return;
+  // Copy: a listener may add or remove listeners
+  const auto listeners = m_changeListeners;
+  for (const auto& l : listeners) l.second(change);
+}
+
+void Document::beginTransaction()
+{
+  m_journal.beginGroup();
+  m_transactionMarks.push_back(m_journal.groupSize());
+}
+
+void Document::commit(const Message_ProgressRange& range)
+{
+  if (m_transactionMarks.empty()) return;
+  m_transactionMarks.pop_back();
+  m_journal.endGroup();
+  if (m_transactionMarks.empty()) notifyChange(recomputeNow(range));
+}
+
+void Document::rollback()
+{
+  if (m_transactionMarks.empty()) return;
+  const std::size_t mark = m_transactionMarks.back();
+  while (m_journal.groupSize() > mark) apply(m_journal.popGroupCommand(), false);
+  m_transactionMarks.pop_back();
+  m_journal.endGroup();
+  // Nothing was recomputed; reverted items stay dirty and hit the result cache next time
+  if (m_transactionMarks.empty()) m_structureChanged = false;
+}
+
+int Document::addChangeListener(ChangeListener cb)
+{
+  const int token = m_nextListenerToken++;
+  m_changeListeners.emplace_back(token, std::move(cb));
+  return token;
+}
+
+void Document::removeChangeListener(int token)
+{
+  m_changeListeners.erase(std::remove_if(m_changeListeners.begin(), m_changeListeners.end(),
+                                         [token](const auto& l) { return l.first == token; }),
+                          m_changeListeners.end());
+}
+
+void Document::recordCheckpoints(const std::vector<Handle(Feature)>& plan, int active)
+{
+  if (m_checkpointInterval <= 0) return;
+  const int pinnedEnd = (active / m_checkpointInterval) * m_checkpointInterval; // last completed block
+  auto pin = [this](const Handle(Feature)& f) {
+    auto kit = m_resultKeys.find(f->id());
+    if (kit == m_resultKeys.end() || kit->second == 0 || f->isDirty() || f->currentShape().IsNull()) return;
+    Checkpoint& c = m_checkpoints[f->id()];
+    c.key = kit->second;
+    c.shape = f->currentShape();
+  };
+  // Blocks completed since the last recompute are pinned whole; afterwards only planned
+  // features change their result (reactivated ones are planned too)
+  for (int i = m_pinnedUpTo + 1; i <= pinnedEnd; ++i)
   {
-    m_items.Remove(m_items.Size());
-    m_featuresCacheDirty = true;
+    if (Handle(Feature) f = asFeature(m_items.Value(i)); !f.IsNull()) pin(f);
+  }
+  m_pinnedUpTo = std::max(m_pinnedUpTo, pinnedEnd);
+  for (const Handle(Feature)& f : plan)
+  {
+    const int idx = m_items.indexOf(f->id());
+    if (idx != 0 && idx <= pinnedEnd) pin(f);
   }
 }
 
-void Document::removeFeature(const Handle(Feature)& f)
+void Document::executePlan(const std::vector<Handle(Feature)>& plan, const Message_ProgressRange& range)
 {
-  if (f.IsNull()) return;
-  for (int i = 1; i <= m_items.Size(); ++i)
+  // One progress step per feature, created up front so workers only consume their own range
+  Message_ProgressScope scope(range, "Recompute", static_cast<double>(std::max<std::size_t>(plan.size(), 1)));
+  std::vector<Message_ProgressRange> steps;
+  steps.reserve(plan.size());
+  for (std::size_t i = 0; i < plan.size(); ++i) steps.push_back(scope.Next());
+  std::atomic<std::size_t> done{0};
+
+  // Profiling: each plan slot owns one sample, so workers record without locking
+  RecomputeProfile* profile = m_profiling ? &m_lastProfile : nullptr;
+  std::vector<std::thread::id> threads;
+  if (profile)
   {
-    Handle(Feature) fi = Handle(Feature)::DownCast(m_items.Value(i));
-    if (!fi.IsNull() && fi == f)
+    profile->samples.assign(plan.size(), RecomputeProfile::Sample());
+    threads.resize(plan.size());
+  }
+  auto run = [&](std::size_t i) {
+    const Handle(Feature)& f = plan[i];
+    Message_ProgressRange& step = steps[i];
+    if (step.UserBreak()) return; // cancelled: leave the feature dirty
+    const auto t0 = std::chrono::steady_clock::now();
+    f->setProgressRange(&step);
+    RecomputeProfile::Source source = RecomputeProfile::Source::Executed;
+    try
     {
-      m_items.Remove(i);
-      m_featuresCacheDirty = true;
-      // If it is a plane, remove from planes container as well
-      if (!Handle(PlaneFeature)::DownCast(f).IsNull())
+      source = executeFeature(f, step);
+    }
+    catch (...)
+    {
+      f->setProgressRange(nullptr);
+      throw;
+    }
+    f->setProgressRange(nullptr);
+    const auto t1 = std::chrono::steady_clock::now();
+    if (step.UserBreak()) return; // result may be partial
+    step.Close();
+    f->clearDirty();
+    if (profile)
+    {
+      RecomputeProfile::Sample& s = profile->samples[i];
+      s.id = f->id();
+      s.kind = f->kind();
+      s.name = f->name().ToCString();
+      s.source = source;
+      s.startUs = std::chrono::duration<double, std::micro>(t0 - m_profileOrigin).count();
+      s.durationUs = std::chrono::duration<double, std::micro>(t1 - t0).count();
+      s.solids = countSubShapes(f->currentShape(), TopAbs_SOLID);
+      s.faces = countSubShapes(f->currentShape(), TopAbs_FACE);
+      s.edges = countSubShapes(f->currentShape(), TopAbs_EDGE);
+      threads[i] = std::this_thread::get_id();
+    }
+    const std::size_t n = ++done;
+    if (m_featureCallback) m_featureCallback(f->id(), n, plan.size());
+  };
+
+  if (!m_parallelRecompute || plan.size() < 2)
+  {
+    for (std::size_t i = 0; i < plan.size(); ++i) run(i);
+  }
+  else
+  {
+    // Independent branches share no inputs, so each group runs sequentially on its own worker
+    std::vector<DocumentItem::Id> ids;
+    std::unordered_map<DocumentItem::Id, std::size_t> planIndex;
+    ids.reserve(plan.size());
+    for (std::size_t i = 0; i < plan.size(); ++i)
+    {
+      ids.push_back(plan[i]->id());
+      planIndex.emplace(plan[i]->id(), i);
+    }
+    // Evicted inputs are rebuilt by whichever worker reaches them first, so branches sharing one
+    // behind them are grouped as if it were planned
+    const std::vector<std::vector<DocumentItem::Id>> groups = m_graph.partition(ids, [this](DocumentItem::Id id) {
+      const Handle(DocumentItem) di = m_items.find(id);
+      return !di.IsNull() && isFeatureKind(di->kind()) && static_cast<const Feature*>(di.get())->isPendingEvaluation();
+    });
+    std::vector<std::exception_ptr> errors(groups.size());
+    OSD_Parallel::For(0, static_cast<int>(groups.size()), [&](int g) {
+      try
       {
-        for (NCollection_Sequence<Handle(PlaneFeature)>::Iterator pit(m_planes); pit.More(); pit.Next())
-        {
-          if (pit.Value()->id() == f->id()) { m_planes.Remove(pit); break; }
-        }
+        for (DocumentItem::Id id : groups[g]) run(planIndex.find(id)->second);
       }
+      catch (...)
+      {
+        errors[g] = std::current_exception();
+      }
+    }, groups.size() < 2);
+    for (const std::exception_ptr& e : errors)
+    {
+      if (e) std::rethrow_exception(e);
+    }
+  }
+
+  if (profile)
+  {
+    // Compact thread numbering: calling thread is 0, workers follow in order of first use.
+    // Features skipped by a cancellation have no sample.
+    std::unordered_map<std::thread::id, int> ordinal{{std::this_thread::get_id(), 0}};
+    std::vector<RecomputeProfile::Sample> recorded;
+    recorded.reserve(plan.size());
+    for (std::size_t i = 0; i < plan.size(); ++i)
+    {
+      if (profile->samples[i].id == 0) continue;
+      auto it = ordinal.emplace(threads[i], static_cast<int>(ordinal.size())).first;
+      profile->samples[i].thread = it->second;
+      recorded.push_back(std::move(profile->samples[i]));
+    }
+    profile->samples = std::move(recorded);
+  }
+}
+
+RecomputeProfile::Source Document::executeFeature(const Handle(Feature)& f, const Message_ProgressRange& range) const
+{
+  auto kit = m_resultKeys.find(f->id());
+  const std::uint64_t key = (kit == m_resultKeys.end()) ? 0 : kit->second;
+  if (key == 0)
+  {
+    f->execute();
+    touched(*f);
+    return RecomputeProfile::Source::Executed;
+  }
+  if (auto cit = m_checkpoints.find(f->id()); cit != m_checkpoints.end() && cit->second.key == key)
+  {
+    f->setShape(cit->second.shape);
+    return RecomputeProfile::Source::Checkpoint;
+  }
+  TopoDS_Shape cached;
+  if (m_shapeCache && m_shapeCache->find(key, cached))
+  {
+    f->setShape(cached);
+    return RecomputeProfile::Source::MemoryCache;
+  }
+  if (m_diskCache && m_diskCache->load(key, cached))
+  {
+    f->setShape(cached);
+    if (m_shapeCache) m_shapeCache->insert(key, cached);
+    return RecomputeProfile::Source::DiskCache;
+  }
+  f->execute();
+  touched(*f);
+  if (range.UserBreak()) return RecomputeProfile::Source::Executed; // never cache an interrupted result
+  if (m_shapeCache) m_shapeCache->insert(key, f->currentShape());
+  if (m_diskCache) m_diskCache->store(key, f->currentShape());
+  return RecomputeProfile::Source::Executed;
+}
+
+std::uint64_t Document::resultKey(const DocumentItem& item,
+                                  const std::unordered_map<DocumentItem::Id, Handle(Feature)>& features)
+{
+  auto memo = m_resultKeys.find(item.id());
+  if (memo != m_resultKeys.end()) return memo->second;
+
+  ContentHash h;
+  h.add(item.contentHash());
+  if (const auto* f = dynamic_cast<const Feature*>(&item)) h.add(static_cast<std::uint64_t>(f->algorithmVersion()));
+  std::uint64_t key = 0;
+  bool resolved = true;
+  for (DocumentItem::Id up : m_graph.upstream(item.id()))
+  {
+    // Upstream candidates: earlier features, registered sketches, planes, or a directly linked profile
+    const DocumentItem* input = nullptr;
+    std::shared_ptr<Sketch> sk;
+    if (auto fit = features.find(up); fit != features.end() && fit->second->id() != item.id())
+      input = fit->second.get();
+    else if ((sk = findSketch(up)))
+      input = sk.get();
+    else if (const auto* ef = dynamic_cast<const ExtrudeFeature*>(&item); ef && ef->sketch() && ef->sketch()->id() == up)
+      input = ef->sketch().get();
+    else if (Handle(PlaneFeature) pf = findPlane(up); !pf.IsNull())
+      input = pf.get();
+
+    const std::uint64_t upKey = input ? resultKey(*input, features) : 0;
+    if (upKey == 0)
+    {
+      resolved = false;
       break;
     }
+    h.add(upKey);
   }
+  if (resolved) key = h.value();
+  if (key == 0 && resolved) key = 1; // reserve 0 for "not cacheable"
+  m_resultKeys[item.id()] = key;
+  return key;
 }
 
-void Document::removeItem(const Handle(DocumentItem)& it)
+void Document::removeLast()
 {
-  if (it.IsNull()) return;
+  if (!m_items.IsEmpty())
+  {
+    const DocumentItem::Id id = m_items.Last()->id();
+    m_journal.record({UndoJournal::Command::Type::Remove, m_items.Last(), m_items.Size()});
+    shiftRollback(m_items.Size(), -1);
+    m_graph.remove(id);
+    m_checkpoints.erase(id);
+    m_rolledBack.erase(id);
+    dropPending(m_items.Last());
+    detach(m_items.Last());
+    m_items.removeLast();
+    m_featuresCacheDirty = true;
+    m_structureChanged = true;
+  }
+}
+
+int Document::timelineIndex(const Handle(DocumentItem)& item) const
+{
+  const int idx = m_items.indexOf(item->id());
+  if (idx != 0 && m_items.Value(idx) == item) return idx;
+  // Another item shares the id (e.g. a copied feature): fall back to identity search
   for (int i = 1; i <= m_items.Size(); ++i)
   {
-    if (m_items.Value(i) == it)
+    if (m_items.Value(i) == item) return i;
+  }
+  return 0;
+}
+
+void Document::removeFeature(const Handle(Feature)& f)
+{
+  if (f.IsNull()) return;
+  const int idx = timelineIndex(f);
+  if (idx == 0) return;
+  m_journal.record({UndoJournal::Command::Type::Remove, f, idx});
+  shiftRollback(idx, -1);
+  dropPending(m_items.Value(idx));
+  detach(m_items.Value(idx));
+  m_items.removeAt(idx);
+  m_featuresCacheDirty = true;
+  m_structureChanged = true;
+  m_graph.remove(f->id());
+  m_checkpoints.erase(f->id());
+  m_rolledBack.erase(f->id());
+  // If it is a plane, remove from planes container as well
+  if (!Handle(PlaneFeature)::DownCast(f).IsNull())
+  {
+    for (NCollection_Sequence<Handle(PlaneFeature)>::Iterator pit(m_planes); pit.More(); pit.Next())
     {
-      m_items.Remove(i);
-      m_featuresCacheDirty = true;
-      break;
+      if (pit.Value()->id() == f->id()) { m_planes.Remove(pit); break; }
     }
   }
 }
 
+void Document::removeItem(const Handle(DocumentItem)& it)
+{
+  if (it.IsNull()) return;
+  const int idx = timelineIndex(it);
+  if (idx == 0) return;
+  m_journal.record({UndoJournal::Command::Type::Remove, it, idx});
+  shiftRollback(idx, -1);
+  dropPending(m_items.Value(idx));
+  detach(m_items.Value(idx));
+  m_items.removeAt(idx);
+  m_featuresCacheDirty = true;
+  m_structureChanged = true;
+  m_graph.remove(it->id());
+  m_checkpoints.erase(it->id());
+  m_rolledBack.erase(it->id());
+}
+
 void Document::removeSketchById(DocumentItem::Id id)
 {
   if (id == 0) return;
@@ -201,6 +1166,8 @@ void Document::addSketch(const std::shared_ptr<Sketch>& s)
   const auto sid = s->id();
   // Register in the generic item registry for dependency resolution (overwrites by id)
   m_registry[sid] = s;
+  // A deferred sketch is dirty: refreshDependencies() adds its plane link once loaded
+  if (s->isLoaded()) m_graph.setUpstream(sid, {s->planeId()});
   // Preserve insertion order for sketches; avoid duplicates by id
   const bool exists = std::any_of(m_sketchList.begin(), m_sketchList.end(), [sid](const std::shared_ptr<Sketch>& p){ return p && p->id() == sid; });
   if (!exists)
@@ -209,17 +1176,8 @@ void Document::addSketch(const std::shared_ptr<Sketch>& s)
   }
 
   // Ensure a corresponding timeline entry exists in items() so history reflects sketches
-  bool inTimeline = false;
-  for (NCollection_Sequence<Handle(DocumentItem)>::Iterator it(m_items); it.More(); it.Next())
-  {
-    const Handle(DocumentItem)& di = it.Value();
-    if (!di.IsNull() && di->kind() == DocumentItem::Kind::Sketch && di->id() == sid)
-    {
-      inTimeline = true;
-      break;
-    }
-  }
-  if (!inTimeline)
+  const Handle(DocumentItem) existing = m_items.find(sid);
+  if (existing.IsNull() || existing->kind() != DocumentItem::Kind::Sketch)
   {
     Handle(Sketch) hs = new Sketch(sid); // lightweight handle mirror with same id
     // No need to serialize full geometry for history labeling; id is sufficient
@@ -248,16 +1206,192 @@ void Document::addPlane(const Handle(PlaneFeature)& p)
 
 Handle(PlaneFeature) Document::findPlane(DocumentItem::Id id) const
 {
+  if (Handle(DocumentItem) item = m_items.find(id); !item.IsNull())
+  {
+    if (Handle(PlaneFeature) pf = kindCast<PlaneFeature>(item); !pf.IsNull()) return pf;
+  }
+  // fallback: planes container (a handful of entries; may outlive their timeline entry)
   for (NCollection_Sequence<Handle(PlaneFeature)>::Iterator it(m_planes); it.More(); it.Next())
   {
     const Handle(PlaneFeature)& pf = it.Value();
     if (!pf.IsNull() && pf->id() == id) return pf;
   }
-  // fallback: search timeline
-  for (NCollection_Sequence<Handle(DocumentItem)>::Iterator it(m_items); it.More(); it.Next())
+  return Handle(PlaneFeature)();
+}
+
+std::unique_ptr<Document> Document::createEmpty()
+{
+  std::unique_ptr<Document> doc(new Document(NoDefaults{}));
+  doc->m_datum = std::make_shared<Datum>();
+  return doc;
+}
+
+std::unique_ptr<Document> Document::clone() const
+{
+  std::unique_ptr<Document> copy(new Document(NoDefaults{}));
+  copy->m_datum = m_datum ? std::make_shared<Datum>(*m_datum) : nullptr;
+
+  // Sketches: registered ones first so timeline links resolve to the same copies
+  std::unordered_map<DocumentItem::Id, std::shared_ptr<Sketch>> sketchCopies;
+  auto copySketch = [&](const std::shared_ptr<Sketch>& sk) {
+    auto res = sketchCopies.try_emplace(sk->id(), nullptr);
+    if (res.second) res.first->second = std::make_shared<Sketch>(*sk);
+    return res.first->second;
+  };
+  for (const auto& kv : m_registry)
   {
-    Handle(PlaneFeature) pf = Handle(PlaneFeature)::DownCast(it.Value());
-    if (!pf.IsNull() && pf->id() == id) return pf;
+    if (auto sk = std::dynamic_pointer_cast<Sketch>(kv.second)) copy->m_registry[kv.first] = copySketch(sk);
+    else copy->m_registry[kv.first] = kv.second; // other registered items are not computed
   }
-  return Handle(PlaneFeature)();
+  for (const auto& sk : m_sketchList)
+  {
+    if (sk) copy->m_sketchList.push_back(copySketch(sk));
+  }
+
+  // Timeline: clone features, keep ids; links are remapped below
+  std::unordered_map<DocumentItem::Id, Handle(Feature)> featureCopies;
+  copy->m_items.reserve(static_cast<std::size_t>(m_items.Size()));
+  for (const Handle(DocumentItem)& di : m_items)
+  {
+    Handle(DocumentItem) ci = di;
+    if (Handle(Feature) f = Handle(Feature)::DownCast(di); !f.IsNull())
+    {
+      Handle(Feature) cf = f->clone();
+      cf->setEvaluator(nullptr); // a dirty pending feature is planned again by the copy
+      if (f->isPendingEvaluation() && !f->isDirty())
+      {
+        // Evicted result: the copy rebuilds it on access as well
+        cf->setEvaluator(&copy->m_lazyEvaluator);
+        copy->m_pendingRevisions[cf->id()] = cf->revision();
+      }
+      featureCopies[f->id()] = cf;
+      ci = cf;
+    }
+    else if (Handle(Sketch) hs = Handle(Sketch)::DownCast(di); !hs.IsNull())
+    {
+      ci = new Sketch(*hs);
+    }
+    copy->m_items.append(ci);
+    copy->attach(ci);
+    if (Handle(PlaneFeature) pf = Handle(PlaneFeature)::DownCast(ci); !pf.IsNull()) copy->m_planes.Append(pf);
+  }
+  for (const Handle(DocumentItem)& ci : copy->m_items)
+  {
+    // Relinking must not change the copied dirty state
+    const bool dirty = ci->isDirty();
+    if (Handle(ExtrudeFeature) ef = Handle(ExtrudeFeature)::DownCast(ci); !ef.IsNull() && ef->sketch())
+    {
+      ef->setSketch(copySketch(ef->sketch()));
+    }
+    else if (Handle(MoveFeature) mf = Handle(MoveFeature)::DownCast(ci); !mf.IsNull() && !mf->source().IsNull())
+    {
+      auto fit = featureCopies.find(mf->source()->id());
+      if (fit == featureCopies.end()) fit = featureCopies.emplace(mf->source()->id(), mf->source()->clone()).first;
+      mf->setSource(fit->second);
+    }
+    if (!dirty) ci->clearDirty();
+  }
+
+  copy->m_featuresCacheDirty = true;
+  copy->m_graph = m_graph;
+  copy->m_parallelRecompute = m_parallelRecompute;
+  copy->m_shapeCache = m_shapeCache;
+  copy->m_diskCache = m_diskCache;
+  copy->m_resultKeys = m_resultKeys;
+  copy->m_rollback = m_rollback;
+  copy->m_checkpointInterval = m_checkpointInterval;
+  copy->m_pinnedUpTo = m_pinnedUpTo;
+  copy->m_rolledBack = m_rolledBack;
+  copy->m_checkpoints = m_checkpoints;
+  copy->m_profiling = m_profiling;
+  return copy;
+}
+
+std::shared_ptr<RecomputeJob> Document::recomputeAsync(RecomputeJob::Callbacks callbacks)
+{
+  // Item revisions at snapshot time decide which results publish() may install
+  std::unordered_map<DocumentItem::Id, std::uint64_t> revisions;
+  for (const Handle(DocumentItem)& di : m_items) revisions[di->id()] = di->revision();
+  for (const Handle(DocumentItem)& di : m_items.ofKind(DocumentItem::Kind::ExtrudeFeature))
+  {
+    const auto* ef = static_cast<const ExtrudeFeature*>(di.get());
+    if (ef->sketch()) revisions.emplace(ef->sketch()->id(), ef->sketch()->revision());
+  }
+  for (const auto& sk : m_sketchList)
+  {
+    if (sk) revisions[sk->id()] = sk->revision();
+  }
+  std::unique_ptr<Document> snapshot = clone();
+  snapshot->m_lazyEvaluation = false; // the worker builds everything it publishes
+  std::shared_ptr<RecomputeJob> job(new RecomputeJob(std::move(snapshot), std::move(revisions), std::move(callbacks)));
+  job->start();
+  return job;
+}
+
+bool Document::publish(RecomputeJob& job)
+{
+  if (job.state() != RecomputeJob::State::Finished || job.m_published) return false;
+  job.wait();
+  const Document& snap = *job.m_snapshot;
+  auto unchanged = [&job](const DocumentItem& item) {
+    auto it = job.m_revisions.find(item.id());
+    return it != job.m_revisions.end() && it->second == item.revision();
+  };
+
+  for (const Handle(DocumentItem)& si : snap.m_items)
+  {
+    Handle(DocumentItem) oi = m_items.find(si->id());
+    if (oi.IsNull() || !unchanged(*oi)) continue;
+    Handle(Feature) sf = Handle(Feature)::DownCast(si);
+    Handle(Feature) of = Handle(Feature)::DownCast(oi);
+    if (!sf.IsNull() && !of.IsNull())
+    {
+      // Adopt links the snapshot resolved, then its result
+      if (Handle(MoveFeature) om = Handle(MoveFeature)::DownCast(of); !om.IsNull() && om->source().IsNull())
+      {
+        Handle(MoveFeature) sm = Handle(MoveFeature)::DownCast(sf);
+        if (!sm.IsNull() && !sm->source().IsNull())
+          om->setSource(Handle(Feature)::DownCast(m_items.find(sm->source()->id())));
+      }
+      if (Handle(ExtrudeFeature) oe = Handle(ExtrudeFeature)::DownCast(of); !oe.IsNull() && !oe->sketch())
+      {
+        Handle(ExtrudeFeature) se = Handle(ExtrudeFeature)::DownCast(sf);
+        if (!se.IsNull() && se->sketch())
+          if (auto sk = findSketch(se->sketch()->id())) oe->setSketch(sk);
+      }
+      const bool built = !sf->isPendingEvaluation(); // evicted in the snapshot: keep ours
+      if (built) of->setShape(sf->currentShape());
+      m_graph.setUpstream(of->id(), upstreamOf(oi));
+      if (!si->isDirty())
+      {
+        oi->clearDirty();
+        if (built) dropPending(oi);
+      }
+    }
+    else if (!si->isDirty())
+    {
+      oi->clearDirty();
+    }
+    if (snap.m_rolledBack.count(si->id())) m_rolledBack.insert(si->id());
+    else m_rolledBack.erase(si->id());
+    if (auto cit = snap.m_checkpoints.find(si->id()); cit != snap.m_checkpoints.end()) m_checkpoints[si->id()] = cit->second;
+    if (auto kit = snap.m_resultKeys.find(si->id()); kit != snap.m_resultKeys.end()) m_resultKeys[si->id()] = kit->second;
+    else m_resultKeys.erase(si->id());
+  }
+
+  // Inputs consumed by the snapshot: registered and directly linked sketches
+  auto settle = [&](const std::shared_ptr<Sketch>& sk) {
+    if (!sk || !unchanged(*sk)) return;
+    auto it = snap.m_registry.find(sk->id());
+    auto ssk = it == snap.m_registry.end() ? nullptr : std::dynamic_pointer_cast<Sketch>(it->second);
+    if (!ssk || !ssk->isDirty()) sk->clearDirty();
+  };
+  for (const auto& sk : m_sketchList) settle(sk);
+  for (const Handle(DocumentItem)& di : m_items.ofKind(DocumentItem::Kind::ExtrudeFeature))
+    settle(static_cast<const ExtrudeFeature*>(di.get())->sketch());
+
+  m_lastProfile = snap.m_lastProfile;
+  job.m_published = true;
+  applyRetention();
+  return true;
 }
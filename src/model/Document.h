@@ -1,11 +1,29 @@
 #pragma once
 
 #include "Feature.h"
+#include "DependencyGraph.h"
+#include "ShapeCache.h"
+#include "DiskShapeCache.h"
+#include "Timeline.h"
+#include "RecomputeProfile.h"
+#include "RecomputeJob.h"
+#include "UndoJournal.h"
+#include "DocumentSnapshot.h"
+#include <ShapeMemory.h>
 #include <NCollection_Sequence.hxx>
 
 #include <DocumentItem.h>
+#include <Message_ProgressRange.hxx>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 class Sketch;
@@ -17,17 +35,36 @@ class Document
 {
 public:
   Document();
-  void clear();                                               // Remove all items
+  ~Document();
+  Document(const Document&) = delete;
+  Document& operator=(const Document&) = delete;
+  void clear(bool defaults = true);                           // Remove all items; recreate datum geometry unless !defaults
 
   // Timeline manipulation (ordered history)
   void addItem(const Handle(DocumentItem)& item);             // Append an item
   void insertItem(int index1, const Handle(DocumentItem)& item); // Insert at 1-based index
-  const NCollection_Sequence<Handle(DocumentItem)>& items() const { return m_items; }
+  void reserve(std::size_t items);                            // Capacity for bulk adds (document load)
+  void loadDeferred();                                        // Load all deferred payloads (in parallel); recompute does this first
+  const Timeline& items() const { return m_items; }           // O(1) lookup by id/position
 
   // Convenience helpers for features
   void addFeature(const Handle(Feature)& f) { addItem(Handle(DocumentItem)(f)); }
   const NCollection_Sequence<Handle(Feature)>& features() const; // Filtered view of items()
-  void recompute();                                           // Execute features in order
+
+  // Items of one concrete kind (T::StaticKind) in history order; the per-kind index is
+  // maintained on add/insert/remove, so no RTTI filtering over the whole history
+  template <class T>
+  std::vector<Handle(T)> itemsOfKind() const
+  {
+    const std::vector<Handle(DocumentItem)>& list = m_items.ofKind(T::StaticKind);
+    std::vector<Handle(T)> out;
+    out.reserve(list.size());
+    for (const Handle(DocumentItem)& item : list) out.push_back(Handle(T)(static_cast<T*>(item.get())));
+    return out;
+  }
+  // Execute dirty features and their dependents in order; a user break on the range stops
+  // before the next feature and leaves the remaining ones dirty. Deferred inside a transaction.
+  void recompute(const Message_ProgressRange& range = Message_ProgressRange());
   void removeLast();                                          // Pop last item
   void removeFeature(const Handle(Feature)& f);               // Remove by handle (first match)
   void removeItem(const Handle(DocumentItem)& it);            // Remove any DocumentItem from ordered list
@@ -44,13 +81,157 @@ public:
   Handle(PlaneFeature) findPlane(DocumentItem::Id id) const;   // find plane by id
   const NCollection_Sequence<Handle(PlaneFeature)>& planes() const { return m_planes; }
 
+  // Undo/redo: timeline edits and every parameter or suppression change of a feature in the
+  // document are journaled, whether made here or through the feature's own (typed) setters. Names,
+  // links and Move deltas are not. undo()/redo() only mark the touched items dirty, so the next
+  // recompute() re-executes their dependents and reverted results come back from the result cache.
+  void setParam(const Handle(Feature)& f, Feature::ParamKey key, const Feature::ParamValue& value);
+  void setSuppressed(const Handle(Feature)& f, bool on);
+  bool undo();
+  bool redo();
+  UndoJournal&       journal() { return m_journal; }
+  const UndoJournal& journal() const { return m_journal; }
+
+  // Transactions (nestable): journaled edits up to the outermost commit() form one undo step,
+  // recompute() calls in between are deferred, and commit() runs a single recompute followed by
+  // one change notification. rollback() reverts the journaled edits made since the matching
+  // beginTransaction(), typed feature setters included; reverted features stay dirty and come
+  // back from the result cache on the next recompute().
+  class Transaction; // RAII scope: rolls back unless committed
+  void beginTransaction();
+  void commit(const Message_ProgressRange& range = Message_ProgressRange());
+  void rollback();
+  bool inTransaction() const { return !m_transactionMarks.empty(); }
+
+  // Change notification after every recompute() outside a transaction and once per committed
+  // transaction: items whose result was rebuilt, and whether items were added or removed
+  struct Change
+  {
+    std::vector<DocumentItem::Id> recomputed;
+    bool                          structure{false};
+  };
+  using ChangeListener = std::function<void(const Change& change)>;
+  int  addChangeListener(ChangeListener cb); // returns a token for removeChangeListener()
+  void removeChangeListener(int token);
+
+  // Rollback marker: items after position index1 are rolled back. The next recompute() skips them
+  // and drops their results, so shapes show the history at the marker; moving the marker forward
+  // restores results from checkpoints and executes at most one checkpoint interval of features.
+  void setRollback(int index1);                              // clamped to 0..items().Size()
+  void clearRollback() { m_rollback = -1; }                  // all items active again
+  int  rollbackIndex() const;                                // last active position (Size() if none)
+  bool isRolledBack(const Handle(DocumentItem)& item) const;
+
+  // Checkpoints: after recompute, results of features in every completed block of `steps` timeline
+  // positions before the marker are pinned (shapes are shared, not copied); 0 disables
+  void        setCheckpointInterval(int steps);
+  int         checkpointInterval() const { return m_checkpointInterval; }
+  std::size_t checkpointedResults() const { return m_checkpoints.size(); }
+
+  // Lazy evaluation: recompute() only invalidates and plans; each planned feature executes on its
+  // first shape() access (pulling upstream features through their shape()), so results nobody
+  // reads are never built. Not thread-safe: access shapes from the document's thread.
+  void setLazyEvaluation(bool on);
+  bool lazyEvaluation() const { return m_lazyEvaluation; }
+
+  // Result retention, applied after each recompute(): an evicted result is dropped from its feature
+  // and rebuilt on the next shape() access (served by the result cache when it still holds it)
+  enum class Retention
+  {
+    KeepAll,       // default
+    LeafOrVisible, // drop suppressed results that only feed other features (e.g. hidden Move sources)
+    ByteBudget,    // drop hidden, then visible intermediate, then leaf results until under the budget
+  };
+  void      setRetention(Retention policy, std::size_t budgetBytes = 0);
+  Retention retention() const { return m_retention; }
+
+  // Estimated shape memory (ShapeCache::estimateBytes) per feature, in timeline order
+  struct MemoryStats
+  {
+    struct Entry
+    {
+      DocumentItem::Id   id{0};
+      DocumentItem::Kind kind{DocumentItem::Kind::BoxFeature};
+      std::string        name;
+      std::size_t        bytes{0}; // result currently held by the feature
+      bool               evicted{false};
+    };
+    std::vector<Entry> features;
+    std::size_t        retainedBytes{0};
+    std::size_t        evictedCount{0};
+    std::size_t        checkpointBytes{0}; // rollback checkpoints (often shared with features)
+    std::size_t        cacheBytes{0};      // ShapeCache (often shared with features)
+  };
+  MemoryStats memoryStats() const;
+
+  // Geometry memory (ShapeMemory) of the results currently held, in timeline order. Each entry's
+  // usage counts the feature's shape on its own; added is the part not already counted for an
+  // earlier feature, so the added values sum to total (shared TShapes are counted once).
+  // Evicted or pending results are not evaluated and count as empty.
+  struct GeometryMemory
+  {
+    struct Entry
+    {
+      DocumentItem::Id   id{0};
+      std::string        name;
+      ShapeMemory::Usage usage;
+      ShapeMemory::Usage added;
+    };
+    std::vector<Entry> features;
+    ShapeMemory::Usage total;
+  };
+  GeometryMemory geometryMemory() const;
+
+  // Parallel recompute: independent dependency branches execute concurrently on the OCCT thread pool
+  void setParallelRecompute(bool on) { m_parallelRecompute = on; }
+  bool parallelRecompute() const { return m_parallelRecompute; }
+
+  // Content-addressed result cache consulted before Feature::execute(); may be shared between
+  // documents, or set to null to always execute
+  void setShapeCache(const std::shared_ptr<ShapeCache>& cache) { m_shapeCache = cache; }
+  const std::shared_ptr<ShapeCache>& shapeCache() const { return m_shapeCache; }
+  // Optional persistent cache (e.g. DiskShapeCache::directoryFor(file)); checked after the memory cache
+  void setDiskCache(const std::shared_ptr<DiskShapeCache>& cache) { m_diskCache = cache; }
+  const std::shared_ptr<DiskShapeCache>& diskCache() const { return m_diskCache; }
+
+  // Profiling: when enabled, recompute() records per-feature timings and result statistics
+  void setProfiling(bool on) { m_profiling = on; }
+  bool profiling() const { return m_profiling; }
+  const RecomputeProfile& lastRecomputeProfile() const { return m_lastProfile; } // empty unless profiled
+
+  // Asynchronous recompute against a snapshot taken now (see RecomputeJob). Once the job has
+  // finished, publish() installs its results on this thread in one step; items edited in the
+  // meantime keep their dirty flag. Returns false for unfinished, cancelled or already published jobs.
+  std::shared_ptr<RecomputeJob> recomputeAsync(RecomputeJob::Callbacks callbacks = {});
+  bool                          publish(RecomputeJob& job);
+
+  // Independent copy of the document: cloned features and sketches, shared result caches
+  std::unique_ptr<Document> clone() const;
+  // Default Datum but no datum geometry (loaders; no ids are drawn for throwaway defaults)
+  static std::unique_ptr<Document> createEmpty();
+
+  // Immutable copy-on-write view for readers on other threads (viewer, exporters). Call on the
+  // writer thread: only items changed since the previous snapshot get new records, and an
+  // unchanged document returns the previous snapshot.
+  std::shared_ptr<const DocumentSnapshot> snapshot();
+
+  // Called after each feature of a recompute (possibly from worker threads)
+  using FeatureCallback = std::function<void(DocumentItem::Id id, std::size_t done, std::size_t total)>;
+  void setFeatureCallback(FeatureCallback cb) { m_featureCallback = std::move(cb); }
+
+  // Dependency graph between items (refreshed for dirty items on recompute)
+  const DependencyGraph& dependencies() const { return m_graph; }
+
   // Global Datum of the document
   std::shared_ptr<Datum> datum() const { return m_datum; }
   void setDatum(const std::shared_ptr<Datum>& d) { m_datum = d; }
 
 private:
+  struct NoDefaults {};
+  explicit Document(NoDefaults) {} // empty document for clone()
+
   // Ordered document history (sketches, features, etc.)
-  NCollection_Sequence<Handle(DocumentItem)> m_items;
+  Timeline m_items;
   // Cached filtered view for features()
   mutable NCollection_Sequence<Handle(Feature)> m_featuresCache;
   mutable bool m_featuresCacheDirty{true};
@@ -65,4 +246,123 @@ private:
 
   // Document's global datum
   std::shared_ptr<Datum> m_datum;
+
+  // Upstream links of every known item; drives incremental recompute
+  DependencyGraph m_graph;
+  bool            m_parallelRecompute{false};
+
+  // Result cache and per-item input keys: hash(content, upstream keys); 0 when an input is unresolved
+  std::shared_ptr<ShapeCache>                         m_shapeCache = std::make_shared<ShapeCache>();
+  std::shared_ptr<DiskShapeCache>                     m_diskCache;
+  std::unordered_map<DocumentItem::Id, std::uint64_t> m_resultKeys;
+
+  // Rollback marker (-1: none), results dropped by it, and pinned results (valid while the key matches)
+  struct Checkpoint
+  {
+    std::uint64_t key{0};
+    TopoDS_Shape  shape;
+  };
+  int                                              m_rollback{-1};
+  int                                              m_checkpointInterval{10};
+  int                                              m_pinnedUpTo{0}; // blocks up to this position are pinned
+  std::unordered_set<DocumentItem::Id>             m_rolledBack;
+  std::unordered_map<DocumentItem::Id, Checkpoint> m_checkpoints;
+
+  UndoJournal m_journal;
+  // Attached features report parameter and suppression edits here, whichever setter made them
+  struct JournalRecorder final : Feature::EditObserver
+  {
+    explicit JournalRecorder(Document& d) : doc(d) {}
+    void      paramChanging(Feature& f, Feature::ParamKey key, const Feature::ParamValue* before,
+                            const Feature::ParamValue& after) override;
+    void      suppressionChanging(Feature& f, bool after) override;
+    Document& doc;
+  };
+  JournalRecorder m_journalRecorder{*this};
+
+  // Lazy mode: pending features point at m_lazyEvaluator; revisions recorded when planned
+  struct LazyEvaluator final : Feature::Evaluator
+  {
+    explicit LazyEvaluator(Document& d) : doc(d) {}
+    void      evaluate(const Feature& f) override;
+    Document& doc;
+  };
+  bool                                                m_lazyEvaluation{false};
+  LazyEvaluator                                       m_lazyEvaluator{*this};
+  std::unordered_map<DocumentItem::Id, std::uint64_t> m_pendingRevisions;
+  std::mutex                                          m_pendingMutex; // evictions may be rebuilt from workers
+  std::unordered_map<DocumentItem::Id, std::thread::id> m_evaluating;   // builds in progress and their thread
+  std::condition_variable                             m_evaluated;      // signalled when a build finishes
+
+  // Snapshots: items report changes through m_snapshotTracker (also from recompute workers)
+  struct SnapshotTracker final : DocumentItem::Observer
+  {
+    explicit SnapshotTracker(Document& d) : doc(d) {}
+    void      itemChanged(const DocumentItem& item) override;
+    Document& doc;
+  };
+  SnapshotTracker                              m_snapshotTracker{*this};
+  mutable std::mutex                           m_snapshotMutex; // guards m_snapshotChanged
+  mutable std::unordered_set<DocumentItem::Id> m_snapshotChanged;
+  bool                                         m_snapshotStructure{true}; // timeline order changed
+  std::shared_ptr<const DocumentSnapshot>      m_snapshot;
+
+  Retention   m_retention{Retention::KeepAll};
+  std::size_t m_retentionBudget{0};
+
+  // Open transactions (journal group size at each begin) and listeners
+  std::vector<std::size_t>                   m_transactionMarks;
+  bool                                       m_structureChanged{false};
+  std::vector<std::pair<int, ChangeListener>> m_changeListeners;
+  int                                        m_nextListenerToken{1};
+
+  bool                                  m_profiling{false};
+  RecomputeProfile                      m_lastProfile;
+  std::chrono::steady_clock::time_point m_profileOrigin;
+  FeatureCallback                       m_featureCallback;
+
+  int                           timelineIndex(const Handle(DocumentItem)& item) const; // 1-based, 0 if absent
+  std::vector<DocumentItem::Id> upstreamOf(const Handle(DocumentItem)& item) const;
+  void                          refreshDependencies();
+  std::vector<DocumentItem::Id> recomputeNow(const Message_ProgressRange& range); // ids rebuilt
+  void                          notifyChange(std::vector<DocumentItem::Id> recomputed);
+  void                          apply(const UndoJournal::Command& c, bool forward);
+  void                          evaluatePending(const Feature& f);
+  void                          finishPending(Feature& f);
+  bool                          lazyInputsChanged(const DocumentItem& item) const;
+  void                          dropPending(const Handle(DocumentItem)& item);
+  void                          applyRetention();
+  void                          evict(const Handle(Feature)& f);
+  void                          attach(const Handle(DocumentItem)& item); // joins the timeline
+  void                          detach(const Handle(DocumentItem)& item); // leaves the timeline
+  void                          touched(const DocumentItem& item) const;  // snapshot record is stale
+  void                          shiftRollback(int index1, int delta); // timeline edit at index1
+  void                          recordCheckpoints(const std::vector<Handle(Feature)>& plan, int active);
+  void                          executePlan(const std::vector<Handle(Feature)>& plan, const Message_ProgressRange& range);
+  RecomputeProfile::Source      executeFeature(const Handle(Feature)& f, const Message_ProgressRange& range) const;
+  std::uint64_t                 resultKey(const DocumentItem& item,
+                                          const std::unordered_map<DocumentItem::Id, Handle(Feature)>& features);
+};
+
+// Scoped Document transaction: commit() explicitly, otherwise edits are rolled back on scope exit
+class Document::Transaction
+{
+public:
+  explicit Transaction(Document& doc) : m_doc(&doc) { doc.beginTransaction(); }
+  ~Transaction() { rollback(); }
+
+  Transaction(const Transaction&) = delete;
+  Transaction& operator=(const Transaction&) = delete;
+
+  void commit(const Message_ProgressRange& range = Message_ProgressRange())
+  {
+    if (Document* doc = std::exchange(m_doc, nullptr)) doc->commit(range);
+  }
+  void rollback()
+  {
+    if (Document* doc = std::exchange(m_doc, nullptr)) doc->rollback();
+  }
+
+private:
+  Document* m_doc;
 };
@@ -0,0 +1,335 @@
+#include "DocumentAutosave.h"
+
+#include "Document.h"
+#include "DocumentIO.h"
+#include <ContentHash.h>
+#include <MappedFile.h>
+#include <Sketch.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+namespace {
+constexpr char          kJournalMagic[8] = {'V', 'C', 'A', 'D', 'J', 'N', 'L', '\0'};
+constexpr std::uint32_t kJournalVersion = 1;
+constexpr std::size_t   kJournalHeaderBytes = 16; // magic, u32 version, u32 generation
+constexpr std::uint64_t kMinCompactionBytes = 64 * 1024;
+constexpr const char*   kSegmentSuffix = ".journal";
+
+// Record: u32 body length, u8 type, body, u64 hash of type and body
+enum class Record : std::uint8_t
+{
+  Insert = 1,       // u64 id, u16 kind, u64 predecessor id (0: first), blob
+  Remove = 2,       // u64 id
+  Update = 3,       // u64 id, blob
+  Sketch = 4,       // u64 id, blob (registered sketch added or edited)
+  SketchRemove = 5, // u64 id
+};
+
+void put(std::string& out, std::uint64_t v, int bytes)
+{
+  for (int i = 0; i < bytes; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+}
+
+std::uint64_t get(const char* p, int bytes)
+{
+  std::uint64_t v = 0;
+  for (int i = 0; i < bytes; ++i) v |= static_cast<std::uint64_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+  return v;
+}
+
+void appendRecord(std::string& out, Record type, DocumentItem::Id id, std::string_view blob = {},
+                  const std::uint64_t* kind = nullptr, const DocumentItem::Id* after = nullptr)
+{
+  std::string body;
+  body.reserve(8 + 10 + blob.size());
+  put(body, id, 8);
+  if (kind) put(body, *kind, 2);
+  if (after) put(body, *after, 8);
+  body.append(blob.data(), blob.size());
+
+  const char t = static_cast<char>(type);
+  put(out, body.size(), 4);
+  out.push_back(t);
+  out += body;
+  put(out, ContentHash().add(&t, 1).add(body.data(), body.size()).value(), 8);
+}
+
+// Generations of the segments next to file, ascending
+std::vector<std::uint32_t> segments(const std::filesystem::path& file)
+{
+  std::vector<std::uint32_t> out;
+  const std::string prefix = file.filename().string() + ".";
+  std::error_code ec;
+  std::filesystem::path dir = file.parent_path();
+  if (dir.empty()) dir = ".";
+  for (const auto& de : std::filesystem::directory_iterator(dir, ec))
+  {
+    const std::string name = de.path().filename().string();
+    if (name.size() <= prefix.size() + std::strlen(kSegmentSuffix) || name.compare(0, prefix.size(), prefix) != 0) continue;
+    if (name.compare(name.size() - std::strlen(kSegmentSuffix), std::string::npos, kSegmentSuffix) != 0) continue;
+    const std::string number = name.substr(prefix.size(), name.size() - prefix.size() - std::strlen(kSegmentSuffix));
+    if (number.empty() || !std::all_of(number.begin(), number.end(), [](char c) { return c >= '0' && c <= '9'; })) continue;
+    out.push_back(static_cast<std::uint32_t>(std::stoul(number)));
+  }
+  std::sort(out.begin(), out.end());
+  return out;
+}
+
+// Replays one segment onto doc; stops at the first torn or corrupt record
+void replay(Document& doc, const std::filesystem::path& segment)
+{
+  const MappedFile mapped(segment);
+  if (!mapped.isOpen() || mapped.size() < kJournalHeaderBytes) return;
+  const char* data = mapped.data();
+  if (std::memcmp(data, kJournalMagic, sizeof(kJournalMagic)) != 0 || get(data + 8, 4) != kJournalVersion) return;
+
+  std::size_t pos = kJournalHeaderBytes;
+  while (mapped.size() - pos >= 4 + 1 + 8)
+  {
+    const std::uint64_t length = get(data + pos, 4);
+    if (length < 8 || length > mapped.size() - pos - 4 - 1 - 8) break;
+    const char* t = data + pos + 4;
+    const char* body = t + 1;
+    if (ContentHash().add(t, 1).add(body, static_cast<std::size_t>(length)).value() != get(body + length, 8)) break;
+    pos += 4 + 1 + static_cast<std::size_t>(length) + 8;
+
+    const DocumentItem::Id id = get(body, 8);
+    switch (static_cast<Record>(*t))
+    {
+      case Record::Insert:
+      {
+        if (length < 8 + 2 + 8) return;
+        if (Handle(DocumentItem) old = doc.items().find(id); !old.IsNull()) doc.removeItem(old);
+        Handle(DocumentItem) item = DocumentIO::createItem(static_cast<DocumentItem::Kind>(get(body + 8, 2)), id);
+        if (item.IsNull()) break;
+        item->deserialize(std::string_view(body + 18, static_cast<std::size_t>(length) - 18));
+        const DocumentItem::Id after = get(body + 10, 8);
+        const int index = after ? doc.items().indexOf(after) : 0;
+        doc.insertItem(after && index == 0 ? doc.items().Size() + 1 : index + 1, item);
+        break;
+      }
+      case Record::Remove:
+        if (Handle(DocumentItem) old = doc.items().find(id); !old.IsNull()) doc.removeItem(old);
+        break;
+      case Record::Update:
+        if (Handle(DocumentItem) item = doc.items().find(id); !item.IsNull())
+        {
+          item->deserialize(std::string_view(body + 8, static_cast<std::size_t>(length) - 8));
+        }
+        break;
+      case Record::Sketch:
+      {
+        std::shared_ptr<Sketch> sk = doc.findSketch(id);
+        const bool added = !sk;
+        if (added) sk = std::make_shared<Sketch>(id);
+        sk->deserialize(std::string_view(body + 8, static_cast<std::size_t>(length) - 8));
+        if (added) doc.addSketch(sk);
+        break;
+      }
+      case Record::SketchRemove:
+        doc.removeSketchById(id);
+        break;
+    }
+  }
+}
+}
+
+DocumentAutosave::DocumentAutosave(Document& doc, std::filesystem::path file)
+  : m_doc(doc), m_file(std::move(file))
+{
+  m_generation = DocumentIO::generation(m_file);
+  const std::vector<std::uint32_t> leftover = segments(m_file);
+  if (!leftover.empty()) m_generation = std::max(m_generation, leftover.back()); // compact() moves past them
+  std::error_code ec;
+  const bool current = leftover.empty() && std::filesystem::exists(m_file, ec);
+  m_last = m_doc.snapshot();
+  for (const auto& sk : m_doc.sketches())
+  {
+    if (sk) m_sketchRevisions[sk->id()] = sk->revision();
+  }
+  if (current)
+  {
+    m_fileBytes = std::filesystem::file_size(m_file, ec);
+    openSegment();
+  }
+  else
+  {
+    compact(true);
+  }
+  m_listener = m_doc.addChangeListener([this](const Document::Change&) { flush(); });
+}
+
+DocumentAutosave::~DocumentAutosave()
+{
+  m_doc.removeChangeListener(m_listener);
+  waitForCompaction();
+}
+
+std::filesystem::path DocumentAutosave::segmentPath(const std::filesystem::path& file, std::uint32_t generation)
+{
+  std::filesystem::path p = file;
+  p += "." + std::to_string(generation) + kSegmentSuffix;
+  return p;
+}
+
+bool DocumentAutosave::hasJournal(const std::filesystem::path& file)
+{
+  return !segments(file).empty();
+}
+
+void DocumentAutosave::discard(const std::filesystem::path& file)
+{
+  std::error_code ec;
+  for (std::uint32_t g : segments(file)) std::filesystem::remove(segmentPath(file, g), ec);
+}
+
+std::unique_ptr<Document> DocumentAutosave::recover(const std::filesystem::path& file, std::string* error)
+{
+  std::unique_ptr<Document> doc = DocumentIO::load(file, error);
+  if (!doc) return nullptr;
+  const std::uint32_t base = DocumentIO::generation(file);
+  doc->journal().setEnabled(false);
+  for (std::uint32_t g : segments(file))
+  {
+    if (g >= base) replay(*doc, segmentPath(file, g));
+  }
+  doc->journal().setEnabled(true);
+  doc->journal().clear(); // recovery is not undoable
+  return doc;
+}
+
+bool DocumentAutosave::openSegment()
+{
+  m_out.close();
+  m_out.clear();
+  m_out.open(segmentPath(m_file, m_generation), std::ios::binary | std::ios::trunc);
+  std::string header(kJournalMagic, sizeof(kJournalMagic));
+  put(header, kJournalVersion, 4);
+  put(header, m_generation, 4);
+  m_out.write(header.data(), static_cast<std::streamsize>(header.size()));
+  m_out.flush();
+  m_journalBytes = header.size();
+  return m_out.good();
+}
+
+bool DocumentAutosave::flush()
+{
+  const bool ok = appendChanges();
+  const std::uint64_t limit = std::max(kMinCompactionBytes, static_cast<std::uint64_t>(m_ratio * m_fileBytes));
+  if (!m_compacting && m_journalBytes > limit) compact();
+  return ok;
+}
+
+bool DocumentAutosave::appendChanges()
+{
+  std::shared_ptr<const DocumentSnapshot> next = m_doc.snapshot();
+  std::string records;
+  if (next != m_last) diffTimeline(*m_last, *next, records);
+  diffSketches(records);
+  m_last = std::move(next);
+  m_lastFlushBytes = records.size();
+  if (records.empty()) return true;
+
+  m_out.write(records.data(), static_cast<std::streamsize>(records.size()));
+  m_out.flush();
+  m_journalBytes += records.size();
+  return m_out.good();
+}
+
+void DocumentAutosave::diffTimeline(const DocumentSnapshot& before, const DocumentSnapshot& after, std::string& out) const
+{
+  if (after.sameStructure(before))
+  {
+    // Same order: only records rebuilt since, and only when their blob changed (not just the result)
+    for (std::size_t i : after.changedSince(before))
+    {
+      const DocumentSnapshot::Item& item = after.at(i);
+      if (item.data != before.at(i).data) appendRecord(out, Record::Update, item.id, item.data);
+    }
+    return;
+  }
+
+  for (std::size_t i = 0; i < before.size(); ++i)
+  {
+    const DocumentItem::Id id = before.at(i).id;
+    if (after.indexOf(id) == after.size()) appendRecord(out, Record::Remove, id);
+  }
+  // Items keep their place while their old positions stay increasing; the rest are reinserted
+  // after their new predecessor, which replay has placed by then
+  DocumentItem::Id previous = 0;
+  std::size_t keptUpTo = 0;
+  for (std::size_t i = 0; i < after.size(); ++i)
+  {
+    const DocumentSnapshot::ItemPtr& item = after.itemPtr(i);
+    const std::size_t old = before.indexOf(item->id);
+    if (old == before.size() || old < keptUpTo)
+    {
+      const std::uint64_t kind = static_cast<std::uint64_t>(item->kind);
+      appendRecord(out, Record::Insert, item->id, item->data, &kind, &previous);
+    }
+    else
+    {
+      keptUpTo = old;
+      if (item != before.itemPtr(old) && item->data != before.at(old).data) appendRecord(out, Record::Update, item->id, item->data);
+    }
+    previous = item->id;
+  }
+}
+
+void DocumentAutosave::diffSketches(std::string& out)
+{
+  // A handful of registered sketches: compare edit revisions, serialize only the edited ones
+  std::unordered_map<DocumentItem::Id, std::uint64_t> seen;
+  for (const auto& sk : m_doc.sketches())
+  {
+    if (!sk) continue;
+    seen[sk->id()] = sk->revision();
+    auto it = m_sketchRevisions.find(sk->id());
+    if (it == m_sketchRevisions.end() || it->second != sk->revision()) appendRecord(out, Record::Sketch, sk->id(), sk->serialize());
+  }
+  for (const auto& [id, revision] : m_sketchRevisions)
+  {
+    if (seen.find(id) == seen.end()) appendRecord(out, Record::SketchRemove, id);
+  }
+  m_sketchRevisions.swap(seen);
+}
+
+void DocumentAutosave::compact(bool wait)
+{
+  if (m_compacting && !wait) return;
+  waitForCompaction(); // reaps a finished thread before starting the next one
+  appendChanges();
+
+  std::shared_ptr<const DocumentSnapshot> snapshot = m_last;
+  std::vector<DocumentIO::SketchBlob> sketches;
+  for (const auto& sk : m_doc.sketches())
+  {
+    if (sk) sketches.push_back({sk->id(), sk->serialize(Sketch::Encoding::Binary)});
+  }
+  // Edits from here on go to the next segment; the file written below holds everything before it
+  const std::uint32_t generation = ++m_generation;
+  openSegment();
+
+  m_compacting = true;
+  m_compactor = std::thread([this, snapshot, sketches = std::move(sketches), generation] {
+    if (DocumentIO::save(*snapshot, sketches, m_file, generation)) // on failure older segments still replay
+    {
+      std::error_code ec;
+      m_fileBytes = std::filesystem::file_size(m_file, ec);
+      for (std::uint32_t g : segments(m_file))
+      {
+        if (g < generation) std::filesystem::remove(segmentPath(m_file, g), ec);
+      }
+    }
+    m_compacting = false;
+  });
+  if (wait) waitForCompaction();
+}
+
+void DocumentAutosave::waitForCompaction()
+{
+  if (m_compactor.joinable()) m_compactor.join();
+}
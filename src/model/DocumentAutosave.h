@@ -0,0 +1,78 @@
+#pragma once
+
+#include "DocumentSnapshot.h"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+class Document;
+
+// Append-only autosave journal next to a document file
+// - flush() appends what changed since the previous flush: inserted and removed timeline items and
+//   the serialize() blobs of edited items and registered sketches, so its cost follows the edit size.
+//   It runs after every change notification of the document; call it from a timer for edits that
+//   are not recomputed yet
+// - Once the journal outgrows compactionRatio() of the file, the file is rewritten from a snapshot
+//   on a background thread and the journal continues in a new segment
+// - recover() loads the file and replays the segments it does not hold yet
+// Segments are <file>.<generation>.journal. The file header stores the generation it was compacted
+// at (DocumentIO::generation), so a crash at any point replays exactly the missing edits; a torn
+// record at the end of a segment is ignored.
+class DocumentAutosave
+{
+public:
+  // Leftover segments (a recovered or declined session) are folded in by rewriting the file from
+  // doc first; otherwise file must hold the document's current state (just saved or loaded)
+  DocumentAutosave(Document& doc, std::filesystem::path file);
+  ~DocumentAutosave(); // waits for a running compaction; the journal stays until the next one
+  DocumentAutosave(const DocumentAutosave&) = delete;
+  DocumentAutosave& operator=(const DocumentAutosave&) = delete;
+
+  // Append the edits since the last flush; document thread only. False on write errors
+  bool flush();
+
+  // Rewrite the file from the current state and start a new segment (background unless wait)
+  void compact(bool wait = false);
+  void waitForCompaction();
+  bool compacting() const { return m_compacting; } // a background compaction is still running
+
+  void   setCompactionRatio(double ratio) { m_ratio = ratio; } // journal bytes / file bytes
+  double compactionRatio() const { return m_ratio; }
+
+  std::uint32_t generation() const { return m_generation; }         // current segment
+  std::uint64_t journalBytes() const { return m_journalBytes; }     // current segment size
+  std::uint64_t lastFlushBytes() const { return m_lastFlushBytes; } // appended by the last flush()
+
+  static std::filesystem::path segmentPath(const std::filesystem::path& file, std::uint32_t generation);
+  static bool                  hasJournal(const std::filesystem::path& file);
+  // The file plus its newer journal segments; null (error set) when the file cannot be loaded
+  static std::unique_ptr<Document> recover(const std::filesystem::path& file, std::string* error = nullptr);
+  // Delete all segments, e.g. when the user declines recovery
+  static void discard(const std::filesystem::path& file);
+
+private:
+  bool appendChanges();
+  void diffTimeline(const DocumentSnapshot& before, const DocumentSnapshot& after, std::string& out) const;
+  void diffSketches(std::string& out);
+  bool openSegment();
+
+  Document&                               m_doc;
+  std::filesystem::path                   m_file;
+  std::ofstream                           m_out;
+  std::shared_ptr<const DocumentSnapshot> m_last;           // state already in file + journal
+  std::unordered_map<DocumentItem::Id, std::uint64_t> m_sketchRevisions;
+  std::uint32_t                           m_generation{0};
+  std::uint64_t                           m_journalBytes{0};
+  std::uint64_t                           m_lastFlushBytes{0};
+  std::atomic<std::uint64_t>              m_fileBytes{0};
+  double                                  m_ratio{0.5};
+  std::thread                             m_compactor;      // joinable until reaped, even when done
+  std::atomic<bool>                       m_compacting{false};
+  int                                     m_listener{0};
+};
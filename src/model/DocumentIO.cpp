@@ -0,0 +1,529 @@
+#include "DocumentIO.h"
+
+#include "Document.h"
+#include "PlaneFeature.h"
+#include <MappedFile.h>
+#include <Sketch.h>
+
+#include <OSD_Parallel.hxx>
+#include <Standard_Failure.hxx>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <sstream>
+#include <string_view>
+#include <vector>
+
+namespace {
+constexpr const char* kMagic = "vibecad-document";
+constexpr int         kVersion = 1;
+
+constexpr char          kBinaryMagic[8] = {'V', 'C', 'A', 'D', 'D', 'O', 'C', '\0'};
+constexpr std::uint32_t kBinaryVersion = 1;
+constexpr std::size_t   kHeaderBytes = 32;
+constexpr std::size_t   kEntryBytes = 40;
+constexpr std::size_t   kBlock = 512; // items per parallel task
+
+enum class Role : std::uint8_t
+{
+  Timeline = 0,
+  Sketch = 1,
+};
+
+enum EntryFlags : std::uint8_t
+{
+  kSuppressed = 1,
+  kDatumRelated = 2,
+};
+
+struct Entry
+{
+  DocumentItem::Kind kind;
+  Role               role;
+  std::uint8_t       flags{0};
+  DocumentItem::Id   id;
+  std::uint64_t      offset;
+  std::uint64_t      length;
+  std::uint64_t      nameOffset{0};
+  std::uint64_t      nameLength{0};
+};
+
+// Bytes of a binary document and its parsed table; items whose payload is deferred keep it alive
+class FileBytes final : public DocumentItem::PayloadSource
+{
+public:
+  explicit FileBytes(std::unique_ptr<MappedFile> file)
+    : m_file(std::move(file)), m_data(m_file->data()), m_size(m_file->size())
+  {
+  }
+  explicit FileBytes(std::string bytes) : m_buffer(std::move(bytes)), m_data(m_buffer.data()), m_size(m_buffer.size()) {}
+
+  const char* data() const { return m_data; }
+  std::size_t size() const { return m_size; }
+
+  std::string_view payload(std::size_t entry) const override
+  {
+    const Entry& e = entries[entry];
+    return std::string_view(m_data + e.offset, static_cast<std::size_t>(e.length));
+  }
+
+  std::vector<Entry> entries;
+
+private:
+  std::unique_ptr<MappedFile> m_file;
+  std::string                 m_buffer;
+  const char*                 m_data;
+  std::size_t                 m_size;
+};
+
+// Items rebuilt from a file, before they join a document
+struct Decoded
+{
+  std::vector<Handle(DocumentItem)>    timeline;
+  std::vector<std::shared_ptr<Sketch>> sketches;
+};
+
+void put(std::ostream& os, std::uint64_t v, int bytes)
+{
+  char buf[8];
+  for (int i = 0; i < bytes; ++i) buf[i] = static_cast<char>((v >> (8 * i)) & 0xFF);
+  os.write(buf, bytes);
+}
+
+std::uint64_t get(const char* p, int bytes)
+{
+  std::uint64_t v = 0;
+  for (int i = 0; i < bytes; ++i) v |= static_cast<std::uint64_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+  return v;
+}
+
+bool isBinary(const char* data, std::size_t size)
+{
+  return size >= sizeof(kBinaryMagic) && std::memcmp(data, kBinaryMagic, sizeof(kBinaryMagic)) == 0;
+}
+
+void writeRecord(std::ostream& os, const std::string& blob)
+{
+  os << blob.size() << '\n';
+  os.write(blob.data(), static_cast<std::streamsize>(blob.size()));
+  os << '\n';
+}
+
+bool readRecord(std::istream& is, std::string& blob)
+{
+  std::size_t bytes = 0;
+  if (!(is >> bytes) || is.get() != '\n') return false;
+  // The size comes from the file: grow the blob as the bytes arrive so a bad one just runs out of input
+  constexpr std::size_t kChunk = std::size_t{1} << 16;
+  blob.clear();
+  while (blob.size() < bytes)
+  {
+    const std::size_t at = blob.size();
+    blob.resize(at + std::min(kChunk, bytes - at));
+    if (!is.read(&blob[at], static_cast<std::streamsize>(blob.size() - at))) return false;
+  }
+  return is.get() == '\n';
+}
+
+std::unique_ptr<Document> fail(std::string* error, const std::string& reason)
+{
+  if (error) *error = reason;
+  return nullptr;
+}
+
+// Sketches use their text encoding here so the whole file stays diffable
+bool saveText(const Document& doc, std::ostream& os)
+{
+  os << kMagic << ' ' << kVersion << '\n';
+  for (const Handle(DocumentItem)& di : doc.items())
+  {
+    os << "item " << static_cast<int>(di->kind()) << ' ' << di->id() << ' ';
+    const Sketch* sk = dynamic_cast<const Sketch*>(di.get());
+    writeRecord(os, sk ? sk->serialize(Sketch::Encoding::Text) : di->serialize());
+  }
+  for (const auto& sk : doc.sketches())
+  {
+    if (!sk) continue;
+    os << "sketch " << sk->id() << ' ';
+    writeRecord(os, sk->serialize(Sketch::Encoding::Text));
+  }
+  return static_cast<bool>(os);
+}
+
+// Entries carry kind, role, id, flags and name spans into names; offsets follow from the blob sizes
+bool writeBinary(std::ostream& os, const std::vector<Entry>& entries, const std::vector<std::string_view>& blobs,
+                 const std::string& names, std::uint32_t generation)
+{
+  const std::uint64_t tableOffset = kHeaderBytes;
+  const std::uint64_t namesOffset = tableOffset + kEntryBytes * entries.size();
+  os.write(kBinaryMagic, sizeof(kBinaryMagic));
+  put(os, kBinaryVersion, 4);
+  put(os, generation, 4);
+  put(os, entries.size(), 8);
+  put(os, tableOffset, 8);
+
+  std::uint64_t offset = namesOffset + names.size();
+  for (std::size_t i = 0; i < entries.size(); ++i)
+  {
+    const Entry& e = entries[i];
+    put(os, static_cast<std::uint64_t>(e.kind), 2);
+    put(os, static_cast<std::uint64_t>(e.role), 1);
+    put(os, e.flags, 1);
+    put(os, e.nameLength, 4);
+    put(os, e.id, 8);
+    put(os, offset, 8);
+    put(os, blobs[i].size(), 8);
+    put(os, namesOffset + e.nameOffset, 8);
+    offset += blobs[i].size();
+  }
+  os.write(names.data(), static_cast<std::streamsize>(names.size()));
+  for (std::string_view b : blobs) os.write(b.data(), static_cast<std::streamsize>(b.size()));
+  return static_cast<bool>(os);
+}
+
+void setHeader(Entry& e, std::string& names, const char* name, std::size_t length, bool suppressed, bool datum)
+{
+  e.flags = static_cast<std::uint8_t>((suppressed ? kSuppressed : 0) | (datum ? kDatumRelated : 0));
+  e.nameOffset = names.size();
+  e.nameLength = length;
+  names.append(name, length);
+}
+
+bool saveBinary(const Document& doc, std::ostream& os)
+{
+  std::vector<const DocumentItem*> items;
+  std::vector<Role>                roles;
+  items.reserve(static_cast<std::size_t>(doc.items().Size()) + doc.sketches().size());
+  for (const Handle(DocumentItem)& di : doc.items())
+  {
+    items.push_back(di.get());
+    roles.push_back(Role::Timeline);
+  }
+  for (const auto& sk : doc.sketches())
+  {
+    if (!sk) continue;
+    items.push_back(sk.get());
+    roles.push_back(Role::Sketch);
+  }
+
+  // serialize() only reads the item, so the blobs are produced concurrently
+  std::vector<std::string> blobs(items.size());
+  const int blocks = static_cast<int>((items.size() + kBlock - 1) / kBlock);
+  OSD_Parallel::For(0, blocks, [&](int b) {
+    const std::size_t last = std::min(items.size(), static_cast<std::size_t>(b + 1) * kBlock);
+    for (std::size_t i = static_cast<std::size_t>(b) * kBlock; i < last; ++i)
+    {
+      // Sketches are stored packed so loadBinary() can read them straight into the vectors
+      const Sketch* sk = dynamic_cast<const Sketch*>(items[i]);
+      blobs[i] = sk ? sk->serialize(Sketch::Encoding::Binary) : items[i]->serialize();
+    }
+  }, blocks < 2);
+
+  // Names and flags go to the table of contents so history views need no payload
+  std::string names;
+  std::vector<Entry> entries(items.size());
+  for (std::size_t i = 0; i < items.size(); ++i)
+  {
+    Entry& e = entries[i];
+    e.kind = items[i]->kind();
+    e.role = roles[i];
+    e.id = items[i]->id();
+    if (const Feature* f = dynamic_cast<const Feature*>(items[i]))
+    {
+      setHeader(e, names, f->name().ToCString(), static_cast<std::size_t>(f->name().Length()), f->isSuppressed(),
+                f->isDatumRelated());
+    }
+  }
+  return writeBinary(os, entries, std::vector<std::string_view>(blobs.begin(), blobs.end()), names, 0);
+}
+
+// Write aside and rename so a crash never leaves a truncated document
+template <class Writer>
+bool writeFile(const std::filesystem::path& file, const Writer& write)
+{
+  std::filesystem::path tmp = file;
+  tmp += ".tmp";
+  {
+    std::ofstream os(tmp, std::ios::binary | std::ios::trunc);
+    if (!os || !write(os)) return false;
+    os.close();
+    if (os.fail())
+    {
+      std::error_code ec;
+      std::filesystem::remove(tmp, ec);
+      return false;
+    }
+  }
+  std::error_code ec;
+  std::filesystem::rename(tmp, file, ec);
+  if (ec)
+  {
+    std::filesystem::remove(tmp, ec);
+    return false;
+  }
+  return true;
+}
+
+// Adds decoded items in file order; loading is not undoable
+std::unique_ptr<Document> assemble(Decoded& d)
+{
+  std::unique_ptr<Document> doc = Document::createEmpty(); // the file carries its own datum items
+  doc->journal().setEnabled(false);
+  doc->reserve(d.timeline.size() + d.sketches.size());
+  for (const Handle(DocumentItem)& item : d.timeline)
+  {
+    if (Handle(PlaneFeature) pf = Handle(PlaneFeature)::DownCast(item); !pf.IsNull()) doc->addPlane(pf);
+    else doc->addItem(item);
+  }
+  for (const auto& sk : d.sketches) doc->addSketch(sk);
+  doc->journal().setEnabled(true);
+  doc->journal().clear();
+  return doc;
+}
+
+// deserialize() throws on malformed blobs; reported as "malformed item <id>: ..." like binary loads
+bool deserializeRecord(DocumentItem& item, std::string_view blob, std::string* error)
+{
+  try
+  {
+    item.deserialize(blob);
+    return true;
+  }
+  catch (const Standard_Failure& ex)
+  {
+    fail(error, "malformed item " + std::to_string(item.id()) + ": " + ex.GetMessageString());
+  }
+  catch (const std::exception& ex)
+  {
+    fail(error, "malformed item " + std::to_string(item.id()) + ": " + ex.what());
+  }
+  return false;
+}
+
+std::unique_ptr<Document> loadText(std::istream& is, std::string* error)
+{
+  std::string magic;
+  int version = 0;
+  if (!(is >> magic >> version) || magic != kMagic) return fail(error, "not a vibecad document");
+  if (version != kVersion) return fail(error, "unsupported document version " + std::to_string(version));
+
+  Decoded d;
+  std::string tag;
+  std::string blob;
+  while (is >> tag)
+  {
+    if (tag == "item")
+    {
+      int kind = 0;
+      DocumentItem::Id id = 0;
+      if (!(is >> kind >> id) || !readRecord(is, blob)) return fail(error, "truncated item record");
+      Handle(DocumentItem) item = DocumentIO::createItem(static_cast<DocumentItem::Kind>(kind), id);
+      if (item.IsNull()) return fail(error, "unknown item kind " + std::to_string(kind));
+      if (!deserializeRecord(*item, blob, error)) return nullptr;
+      d.timeline.push_back(item);
+    }
+    else if (tag == "sketch")
+    {
+      DocumentItem::Id id = 0;
+      if (!(is >> id) || !readRecord(is, blob)) return fail(error, "truncated sketch record");
+      auto sk = std::make_shared<Sketch>(id);
+      if (!deserializeRecord(*sk, blob, error)) return nullptr;
+      d.sketches.push_back(sk);
+    }
+    else
+    {
+      return fail(error, "unexpected record '" + tag + "'");
+    }
+  }
+  return assemble(d);
+}
+
+// Lazy: items get their table fields and keep a reference to the bytes;
+// otherwise every payload is copied into its item and the bytes can go
+std::unique_ptr<Document> loadBinary(const std::shared_ptr<FileBytes>& file, DocumentIO::LoadMode mode, std::string* error)
+{
+  const char* data = file->data();
+  const std::size_t size = file->size();
+  if (size < kHeaderBytes) return fail(error, "truncated document header");
+  const std::uint32_t version = static_cast<std::uint32_t>(get(data + 8, 4));
+  if (version != kBinaryVersion) return fail(error, "unsupported document version " + std::to_string(version));
+  const std::uint64_t count = get(data + 16, 8);
+  const std::uint64_t tableOffset = get(data + 24, 8);
+  if (tableOffset < kHeaderBytes || tableOffset > size || count > (size - tableOffset) / kEntryBytes)
+  {
+    return fail(error, "truncated item table");
+  }
+
+  std::vector<Entry>& entries = file->entries;
+  entries.resize(static_cast<std::size_t>(count));
+  std::size_t timelineCount = 0;
+  DocumentItem::Id maxId = 0;
+  for (std::size_t i = 0; i < entries.size(); ++i)
+  {
+    const char* p = data + tableOffset + i * kEntryBytes;
+    Entry& e = entries[i];
+    e.kind = static_cast<DocumentItem::Kind>(get(p, 2));
+    e.role = static_cast<Role>(get(p + 2, 1));
+    e.id = get(p + 8, 8);
+    e.offset = get(p + 16, 8);
+    e.length = get(p + 24, 8);
+    e.flags = static_cast<std::uint8_t>(get(p + 3, 1));
+    e.nameLength = get(p + 4, 4);
+    e.nameOffset = get(p + 32, 8);
+    if (e.offset > size || e.length > size - e.offset || e.nameOffset > size || e.nameLength > size - e.nameOffset)
+    {
+      return fail(error, "item payload out of range");
+    }
+    maxId = std::max(maxId, e.id);
+    if (e.role == Role::Timeline) ++timelineCount;
+    else if (e.role != Role::Sketch || e.kind != DocumentItem::Kind::Sketch)
+    {
+      return fail(error, "unexpected table entry " + std::to_string(i));
+    }
+  }
+  const bool lazy = mode == DocumentIO::LoadMode::Lazy;
+
+  // Rebuild items in parallel: with the id range reserved up front, construction and deserialize()
+  // touch no shared state (the id counter is only read)
+  DocumentItem::reserveIds(maxId);
+  Decoded d;
+  d.timeline.resize(timelineCount);
+  d.sketches.resize(entries.size() - timelineCount);
+  std::vector<std::size_t> slot(entries.size());
+  for (std::size_t i = 0, t = 0, s = 0; i < entries.size(); ++i) slot[i] = entries[i].role == Role::Timeline ? t++ : s++;
+
+  const int blocks = static_cast<int>((entries.size() + kBlock - 1) / kBlock);
+  std::vector<std::string> errors(static_cast<std::size_t>(blocks));
+  OSD_Parallel::For(0, blocks, [&](int b) {
+    const std::size_t first = static_cast<std::size_t>(b) * kBlock;
+    const std::size_t last = std::min(entries.size(), first + kBlock);
+    std::size_t i = first;
+    try
+    {
+      for (; i < last; ++i)
+      {
+        const Entry& e = entries[i];
+        Handle(DocumentItem) item;
+        std::shared_ptr<Sketch> sk;
+        if (e.role == Role::Timeline)
+        {
+          item = DocumentIO::createItem(e.kind, e.id);
+          if (item.IsNull())
+          {
+            errors[b] = "unknown item kind " + std::to_string(static_cast<int>(e.kind));
+            return;
+          }
+          d.timeline[slot[i]] = item;
+        }
+        else
+        {
+          sk = std::make_shared<Sketch>(e.id);
+          d.sketches[slot[i]] = sk;
+        }
+        DocumentItem& di = sk ? static_cast<DocumentItem&>(*sk) : *item;
+        if (!lazy)
+        {
+          di.deserialize(file->payload(i));
+          continue;
+        }
+        if (Feature* f = dynamic_cast<Feature*>(&di))
+        {
+          const TCollection_AsciiString name(data + e.nameOffset, static_cast<int>(e.nameLength));
+          f->restoreHeader(name, (e.flags & kSuppressed) != 0, (e.flags & kDatumRelated) != 0);
+        }
+        di.deferPayload(file, i);
+      }
+    }
+    catch (const Standard_Failure& ex)
+    {
+      errors[b] = "malformed item " + std::to_string(entries[i].id) + ": " + ex.GetMessageString();
+    }
+    catch (const std::exception& ex)
+    {
+      errors[b] = "malformed item " + std::to_string(entries[i].id) + ": " + ex.what();
+    }
+  }, blocks < 2);
+
+  for (const std::string& e : errors)
+  {
+    if (!e.empty()) return fail(error, e);
+  }
+  return assemble(d);
+}
+}
+
+namespace DocumentIO {
+
+bool save(const Document& doc, std::ostream& os, Format format)
+{
+  return format == Format::Binary ? saveBinary(doc, os) : saveText(doc, os);
+}
+
+bool save(const Document& doc, const std::filesystem::path& file, Format format)
+{
+  return writeFile(file, [&](std::ostream& os) { return save(doc, os, format); });
+}
+
+bool save(const DocumentSnapshot& snapshot, const std::vector<SketchBlob>& sketches, const std::filesystem::path& file,
+          std::uint32_t generation)
+{
+  std::string names;
+  std::vector<Entry> entries(snapshot.size() + sketches.size());
+  std::vector<std::string_view> blobs(entries.size());
+  for (std::size_t i = 0; i < snapshot.size(); ++i)
+  {
+    const DocumentSnapshot::Item& it = snapshot.at(i);
+    Entry& e = entries[i];
+    e.kind = it.kind;
+    e.role = Role::Timeline;
+    e.id = it.id;
+    if (it.kind != DocumentItem::Kind::Sketch) setHeader(e, names, it.name.data(), it.name.size(), it.suppressed, it.datum);
+    blobs[i] = it.data;
+  }
+  for (std::size_t j = 0; j < sketches.size(); ++j)
+  {
+    Entry& e = entries[snapshot.size() + j];
+    e.kind = DocumentItem::Kind::Sketch;
+    e.role = Role::Sketch;
+    e.id = sketches[j].id;
+    blobs[snapshot.size() + j] = sketches[j].data;
+  }
+  return writeFile(file, [&](std::ostream& os) { return writeBinary(os, entries, blobs, names, generation); });
+}
+
+std::uint32_t generation(const std::filesystem::path& file)
+{
+  std::ifstream is(file, std::ios::binary);
+  char header[kHeaderBytes];
+  if (!is.read(header, sizeof(header)) || !isBinary(header, sizeof(header))) return 0;
+  return get(header + 8, 4) == kBinaryVersion ? static_cast<std::uint32_t>(get(header + 12, 4)) : 0;
+}
+
+Handle(DocumentItem) createItem(DocumentItem::Kind kind, DocumentItem::Id id)
+{
+  return DocumentItem::create(kind, DocumentItem::PersistedId{id});
+}
+
+std::unique_ptr<Document> load(std::istream& is, std::string* error, LoadMode mode)
+{
+  std::string content{std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>()};
+  if (isBinary(content.data(), content.size())) return loadBinary(std::make_shared<FileBytes>(std::move(content)), mode, error);
+  std::istringstream text(content);
+  return loadText(text, error);
+}
+
+std::unique_ptr<Document> load(const std::filesystem::path& file, std::string* error, LoadMode mode)
+{
+  auto mapped = std::make_unique<MappedFile>(file);
+  if (!mapped->isOpen()) return fail(error, "cannot open " + file.string());
+  if (isBinary(mapped->data(), mapped->size())) return loadBinary(std::make_shared<FileBytes>(std::move(mapped)), mode, error);
+  std::istringstream text(mapped->size() ? std::string(mapped->data(), mapped->size()) : std::string());
+  return loadText(text, error);
+}
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <DocumentItem.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Document;
+class DocumentSnapshot;
+
+// Document files: timeline items and registered sketches as their serialized blobs, ids preserved.
+// Results are not stored (see DiskShapeCache::directoryFor); loaded items are dirty until recomputed.
+//
+// Binary container (default), little-endian:
+//   header   32 bytes  "VCADDOC\0", u32 version, u32 autosave generation (0 for plain saves),
+//                      u64 entry count, u64 table offset
+//   table    40 bytes per entry, timeline entries in history order, then registered sketches:
+//            u16 kind, u8 role (0 timeline, 1 registered sketch), u8 flags (1 suppressed, 2 datum related),
+//            u32 name length, u64 id, u64 offset, u64 length, u64 name offset
+//   names    feature names, referenced from the table
+//   payloads the serialize() blobs at their table offsets
+// Loading maps the file and rebuilds the items in parallel before adding them in table order.
+//
+// Text (diffable, kept for debugging and older files):
+//   vibecad-document 1
+//   item <kind> <id> <bytes>\n<blob>\n   timeline entry, in history order
+//   sketch <id> <bytes>\n<blob>\n        registered sketch (its timeline entry is a mirror item)
+namespace DocumentIO
+{
+  enum class Format
+  {
+    Binary,
+    Text,
+  };
+
+  // Lazy: items get only their table fields (kind, id, name, flags) and deserialize their payload on
+  // first access (DocumentItem::ensureLoaded); the bytes stay mapped until the last one is loaded.
+  // Text files load eagerly.
+  enum class LoadMode
+  {
+    Eager,
+    Lazy,
+  };
+
+  bool save(const Document& doc, std::ostream& os, Format format = Format::Binary);
+  bool save(const Document& doc, const std::filesystem::path& file, Format format = Format::Binary);
+
+  // Binary file from a snapshot and the registered sketches' blobs, callable from any thread
+  // (DocumentAutosave compaction); generation tells recovery which journal segments it already holds
+  struct SketchBlob
+  {
+    DocumentItem::Id id{0};
+    std::string      data;
+  };
+  bool save(const DocumentSnapshot& snapshot, const std::vector<SketchBlob>& sketches, const std::filesystem::path& file,
+            std::uint32_t generation);
+  // Autosave generation in a binary file's header; 0 for text and unreadable files
+  std::uint32_t generation(const std::filesystem::path& file);
+
+  // Either format, detected from the first bytes. Returns null on unreadable or malformed input
+  // and unknown kinds; error receives the reason
+  std::unique_ptr<Document> load(std::istream& is, std::string* error = nullptr, LoadMode mode = LoadMode::Eager);
+  std::unique_ptr<Document> load(const std::filesystem::path& file, std::string* error = nullptr,
+                                 LoadMode mode = LoadMode::Eager);
+
+  // Empty item of a stored kind with its persisted id (null when the kind is unknown), for loaders
+  // and journal replay. Built through the DocumentItem factory table; the item never draws from
+  // the id counter, so ids handed out after a load do not depend on how the load was scheduled.
+  Handle(DocumentItem) createItem(DocumentItem::Kind kind, DocumentItem::Id id);
+}
@@ -0,0 +1,30 @@
+#include "DocumentSnapshot.h"
+
+const DocumentSnapshot::Item* DocumentSnapshot::find(DocumentItem::Id id) const
+{
+  const std::size_t i = indexOf(id);
+  return i == m_size ? nullptr : &at(i);
+}
+
+std::size_t DocumentSnapshot::indexOf(DocumentItem::Id id) const
+{
+  if (!m_index) return m_size;
+  auto it = m_index->find(id);
+  return it == m_index->end() ? m_size : it->second;
+}
+
+std::vector<std::size_t> DocumentSnapshot::changedSince(const DocumentSnapshot& other) const
+{
+  std::vector<std::size_t> changed;
+  for (std::size_t c = 0; c < m_chunks.size() && c < other.m_chunks.size(); ++c)
+  {
+    if (m_chunks[c] == other.m_chunks[c]) continue;
+    const Chunk& mine = *m_chunks[c];
+    const Chunk& theirs = *other.m_chunks[c];
+    for (std::size_t k = 0; k < mine.size() && k < theirs.size(); ++k)
+    {
+      if (mine[k] != theirs[k]) changed.push_back(c * kChunkSize + k);
+    }
+  }
+  return changed;
+}
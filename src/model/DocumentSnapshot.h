@@ -0,0 +1,68 @@
+#pragma once
+
+#include <DocumentItem.h>
+#include <TopoDS_Shape.hxx>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Immutable view of a Document at one version (see Document::snapshot())
+// - Safe to hold and read from any thread while the document keeps changing
+// - Items are shared records; consecutive snapshots share the records of unchanged items and
+//   whole chunks of the item table, so a new snapshot costs O(changed items)
+// - Shapes are shared with the document (TShapes are never modified in place by recompute)
+class DocumentSnapshot
+{
+public:
+  struct Item
+  {
+    DocumentItem::Id   id{0};
+    DocumentItem::Kind kind{DocumentItem::Kind::BoxFeature};
+    std::string        name;
+    std::string        data;  // DocumentItem::serialize()
+    TopoDS_Shape       shape; // result as held (null while pending, rolled back or unbuilt)
+    bool               suppressed{false};
+    bool               dirty{false};
+    bool               datum{false};
+  };
+  using ItemPtr = std::shared_ptr<const Item>;
+
+  static constexpr std::size_t kChunkSize = 64;
+
+  std::uint64_t version() const { return m_version; }
+  std::size_t   size() const { return m_size; }
+  bool          empty() const { return m_size == 0; }
+
+  // Timeline order, 0-based
+  const Item& at(std::size_t index0) const { return *itemPtr(index0); }
+  // Shared record, for readers that keep one item beyond the snapshot
+  const ItemPtr& itemPtr(std::size_t index0) const { return (*m_chunks[index0 / kChunkSize])[index0 % kChunkSize]; }
+  // nullptr if the id is not in the timeline
+  const Item* find(DocumentItem::Id id) const;
+  // 0-based position; size() if the id is not in the timeline
+  std::size_t indexOf(DocumentItem::Id id) const;
+
+  // Same ids at the same positions as other (the table was not rebuilt in between)
+  bool sameStructure(const DocumentSnapshot& other) const { return m_index == other.m_index; }
+  // Positions whose record is not shared with other; requires sameStructure(). Whole shared
+  // chunks are skipped, so the cost follows the number of edited chunks
+  std::vector<std::size_t> changedSince(const DocumentSnapshot& other) const;
+
+  // Records built for this version (the rest are shared with the previous snapshot)
+  std::size_t builtItems() const { return m_built; }
+
+private:
+  friend class Document;
+  using Chunk = std::vector<ItemPtr>;
+  using Index = std::unordered_map<DocumentItem::Id, std::size_t>;
+
+  std::vector<std::shared_ptr<const Chunk>> m_chunks;
+  std::shared_ptr<const Index>              m_index; // id -> position; shared until the structure changes
+  std::size_t                               m_size{0};
+  std::size_t                               m_built{0};
+  std::uint64_t                             m_version{0};
+};
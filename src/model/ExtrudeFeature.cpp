@@ -1,20 +1,29 @@
 #include "ExtrudeFeature.h"
 
+#include <FieldText.h>
 #include <KernelAPI.h>
 #include <Sketch.h>
 #include <variant>
-#include <sstream>
 
 IMPLEMENT_STANDARD_RTTIEXT(ExtrudeFeature, Feature)
 
 namespace {
 const bool kExtrudeFeatureReg = [](){
-  DocumentItem::registerFactory(DocumentItem::Kind::ExtrudeFeature, [](){ return std::shared_ptr<DocumentItem>(new ExtrudeFeature()); });
+  DocumentItem::registerFactory(DocumentItem::Kind::ExtrudeFeature, [](DocumentItem::PersistedId id) -> DocumentItem* { return new ExtrudeFeature(id); });
   return true;
 }();
 }
 
 
+void ExtrudeFeature::setSketchId(DocumentItem::Id id)
+{
+  ensureLoaded();
+  if (id == m_sketchId) return;
+  if (m_sketch && m_sketch->id() != id) m_sketch.reset();
+  m_sketchId = id;
+  markDirty();
+}
+
 double ExtrudeFeature::distance() const
 {
   return Feature::paramAsDouble(params(), Feature::ParamKey::Distance, 0.0);
@@ -31,30 +40,18 @@ void ExtrudeFeature::execute()
   // Extrude along sketch plane normal scaled by distance
   gp_Vec dir(m_sketch->plane().Direction().XYZ());
   dir.Multiply(distance());
-  m_shape = KernelAPI::extrude(wires, dir);
+  m_shape = KernelAPI::extrude(wires, dir, progressRange());
 }
 
-// Append base Feature encoding + extrude-specific fields
-std::string ExtrudeFeature::serialize() const
+// Link after the base Feature encoding
+void ExtrudeFeature::serializeFields(std::string& out) const
 {
-  std::ostringstream os;
-  os << Feature::serialize();
-  os << "sketchId=" << m_sketchId << "\n";
-  return os.str();
+  out += "sketchId=";
+  FieldText::appendInteger(out, m_sketchId);
+  out += '\n';
 }
 
-void ExtrudeFeature::deserialize(const std::string& data)
+void ExtrudeFeature::deserializeField(const FieldText::Field& f)
 {
-  Feature::deserialize(data);
-  std::size_t pos = 0;
-  while (pos < data.size())
-  {
-    std::size_t eol = data.find('\n', pos);
-    std::string line = data.substr(pos, eol == std::string::npos ? std::string::npos : eol - pos);
-    pos = (eol == std::string::npos) ? data.size() : eol + 1;
-    if (line.rfind("sketchId=", 0) == 0)
-    {
-      m_sketchId = static_cast<DocumentItem::Id>(std::stoull(line.substr(9)));
-    }
-  }
+  if (f.key == "sketchId") FieldText::parseInteger(f.value, m_sketchId);
 }
@@ -17,31 +17,51 @@ class ExtrudeFeature : public Feature
   DEFINE_STANDARD_RTTIEXT(ExtrudeFeature, Feature)
 
 public:
-  ExtrudeFeature() = default;
+  ExtrudeFeature() : Feature(kSchema) {}
+  explicit ExtrudeFeature(PersistedId id) : Feature(id, kSchema) {} // loaders
 
   // ID-based constructor for upstream reference
   ExtrudeFeature(DocumentItem::Id sketchId, double distance)
-    : m_sketchId(sketchId) { setDistance(distance); }
+    : Feature(kSchema), m_sketchId(sketchId) { setDistance(distance); }
 
-  void setSketch(const std::shared_ptr<Sketch>& sk) { m_sketch = sk; }
+  void setSketch(const std::shared_ptr<Sketch>& sk)
+  {
+    m_sketch = sk;
+    markDirty();
+  }
   const std::shared_ptr<Sketch>& sketch() const { return m_sketch; }
 
   // ID-based linkage for serialization-friendly dependency tracking
-  void setSketchId(DocumentItem::Id id) { m_sketchId = id; }
-  DocumentItem::Id sketchId() const { return m_sketchId; }
+  // Changing the id drops a runtime profile resolved for the previous id
+  void setSketchId(DocumentItem::Id id);
+  DocumentItem::Id sketchId() const
+  {
+    ensureLoaded();
+    return m_sketchId;
+  }
 
-  void setDistance(double d) { params()[Feature::ParamKey::Distance] = d; }
+  void setDistance(double d) { setParam(Feature::ParamKey::Distance, d); }
   double distance() const;
 
   void execute() override;
+  std::uint32_t algorithmVersion() const override { return 2; } // 2: one fuse over all profiles
+  Handle(Feature) clone() const override { return new ExtrudeFeature(*this); }
 
 private:
   std::shared_ptr<Sketch> m_sketch; // runtime profile (optional)
   DocumentItem::Id        m_sketchId{0}; // persistent reference
 
 public:
+  // Parameter layout: declared keys are stored in flat slots
+  static constexpr ParamSchema kSchema{
+      {ParamKey::Distance, ParamType::Double},
+  };
+
   // DocumentItem
-  Kind kind() const override { return Kind::ExtrudeFeature; }
-  std::string serialize() const override;
-  void        deserialize(const std::string& data) override;
+  static constexpr Kind StaticKind = Kind::ExtrudeFeature; // for Document::itemsOfKind<T>()
+  Kind kind() const override { return StaticKind; }
+
+protected:
+  void serializeFields(std::string& out) const override;
+  void deserializeField(const FieldText::Field& f) override;
 };
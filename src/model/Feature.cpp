@@ -1,114 +1,150 @@
 #include "Feature.h"
 
-#include <sstream>
+#include <ContentHash.h>
+#include <FieldText.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 IMPLEMENT_STANDARD_RTTIEXT(Feature, DocumentItem)
-// Very simple key=value; encoding for base fields and params; not robust JSON.
-// Keys: name, suppressed, p_<keyIndex> for numeric params (int/double), s_<keyIndex> for string params
-static std::string escape(const std::string& s)
-{
-  std::string out; out.reserve(s.size());
-  for (char c : s) { if (c == '\\' || c == '=') out.push_back('\\'); out.push_back(c); }
-  return out;
-}
-
-static std::string toString(const TCollection_AsciiString& s)
-{
-  return std::string(s.ToCString());
-}
-
-static TCollection_AsciiString toAscii(const std::string& s)
-{
-  return TCollection_AsciiString(s.c_str());
-}
-
+// Line-based key=value blob (FieldText): name, suppressed, datum_related, then parameters in key
+// order as p_<keyIndex> (double, or int where the schema declares Int), i_<keyIndex> (other ints)
+// or s_<keyIndex> (string), then the subclass fields
 std::string Feature::serialize() const
 {
-  std::ostringstream os;
-  os << "name=" << escape(toString(m_name)) << "\n";
-  os << "suppressed=" << (m_suppressed ? 1 : 0) << "\n";
-  os << "datum_related=" << (m_isDatumRelated ? 1 : 0) << "\n";
-  for (const auto& kv : m_params)
+  ensureLoaded();
+  std::string out;
+  out.reserve(48 + static_cast<std::size_t>(m_name.Length()) + 24 * m_params.size());
+  out += "name=";
+  FieldText::appendEscaped(out, std::string_view(m_name.ToCString(), static_cast<std::size_t>(m_name.Length())));
+  out += m_suppressed ? "\nsuppressed=1\n" : "\nsuppressed=0\n";
+  out += m_isDatumRelated ? "datum_related=1\n" : "datum_related=0\n";
+  // Declared slots and overflow keys iterate as two runs; walk the keys for one ascending order
+  for (std::size_t k = 0; k < kParamKeyCount; ++k)
   {
-    const int keyIdx = static_cast<int>(kv.first);
-    if (std::holds_alternative<int>(kv.second))
+    const ParamValue* v = m_params.get(static_cast<ParamKey>(k));
+    if (!v) continue;
+    if (const int* i = std::get_if<int>(v))
     {
-      os << "p_" << keyIdx << '=' << std::get<int>(kv.second) << "\n";
+      const bool declared = m_params.schema().typeOf(static_cast<ParamKey>(k), ParamType::Double) == ParamType::Int;
+      out += declared ? "p_" : "i_";
+      FieldText::appendInteger(out, k);
+      out += '=';
+      FieldText::appendInteger(out, *i);
     }
-    else if (std::holds_alternative<double>(kv.second))
+    else if (const double* d = std::get_if<double>(v))
     {
-      os << "p_" << keyIdx << '=' << std::get<double>(kv.second) << "\n";
+      out += "p_";
+      FieldText::appendInteger(out, k);
+      out += '=';
+      FieldText::appendNumber(out, *d);
     }
     else
     {
-      os << "s_" << keyIdx << '=' << escape(toString(std::get<TCollection_AsciiString>(kv.second))) << "\n";
+      const TCollection_AsciiString& str = std::get<TCollection_AsciiString>(*v);
+      out += "s_";
+      FieldText::appendInteger(out, k);
+      out += '=';
+      FieldText::appendEscaped(out, std::string_view(str.ToCString(), static_cast<std::size_t>(str.Length())));
     }
+    out += '\n';
   }
-  return os.str();
+  serializeFields(out);
+  return out;
 }
 
-void Feature::deserialize(const std::string& data)
+void Feature::deserialize(std::string_view data)
 {
+  markDirty();
   m_params.clear();
-  std::string key, val;
-  std::size_t pos = 0;
-  while (pos < data.size())
+  std::string scratch;
+  FieldText::Reader reader(data);
+  FieldText::Field f;
+  while (reader.next(f))
   {
-    std::size_t eol = data.find('\n', pos);
-    std::string line = data.substr(pos, eol == std::string::npos ? std::string::npos : eol - pos);
-    pos = (eol == std::string::npos) ? data.size() : eol + 1;
-    if (line.empty()) continue;
-    std::size_t eq = std::string::npos;
-    bool esc = false;
-    for (std::size_t i = 0; i < line.size(); ++i)
-    {
-      if (!esc && line[i] == '=') { eq = i; break; }
-      esc = (!esc && line[i] == '\\');
-    }
-    if (eq == std::string::npos) continue;
-    key = line.substr(0, eq);
-    val.clear();
-    esc = false;
-    for (std::size_t i = eq + 1; i < line.size(); ++i)
+    if (f.key == "name")
     {
-      char c = line[i];
-      if (!esc && c == '\\') { esc = true; continue; }
-      val.push_back(c); esc = false;
+      const std::string_view v = FieldText::unescaped(f, scratch);
+      m_name = TCollection_AsciiString(v.data(), static_cast<int>(v.size()));
     }
-
-    if (key == "name") m_name = toAscii(val);
-    else if (key == "suppressed") m_suppressed = (val == "1");
-    else if (key == "datum_related") m_isDatumRelated = (val == "1");
-    else if (key.rfind("p_", 0) == 0)
+    else if (f.key == "suppressed") m_suppressed = (f.value == "1");
+    else if (f.key == "datum_related") m_isDatumRelated = (f.value == "1");
+    else if (f.key.size() > 2 && (f.key[0] == 'p' || f.key[0] == 'i' || f.key[0] == 's') && f.key[1] == '_')
     {
-      int idx = std::stoi(key.substr(2));
-      // try parse as double, then as int
-      try {
-        double d = std::stod(val);
-        m_params[static_cast<ParamKey>(idx)] = d;
-      } catch (...) {
-        try { int i = std::stoi(val); m_params[static_cast<ParamKey>(idx)] = i; } catch (...) {}
+      std::size_t idx = 0;
+      if (!FieldText::parseInteger(f.key.substr(2), idx) || idx >= kParamKeyCount) continue;
+      const ParamKey pk = static_cast<ParamKey>(idx);
+      ParamValue value;
+      if (f.key[0] == 's')
+      {
+        const std::string_view v = FieldText::unescaped(f, scratch);
+        value = TCollection_AsciiString(v.data(), static_cast<int>(v.size()));
       }
+      else if (f.key[0] == 'i')
+      {
+        int i = 0;
+        if (!FieldText::parseInteger(f.value, i)) continue;
+        value = i;
+      }
+      else
+      {
+        // Integral values of keys the schema declares as Int stay int; everything else reads as double
+        double d = 0.0;
+        if (!FieldText::parseNumber(f.value, d)) continue;
+        const bool asInt = m_params.schema().typeOf(pk, ParamType::Double) == ParamType::Int
+                           && std::fabs(d) <= std::numeric_limits<int>::max() && d == std::floor(d);
+        if (asInt) value = static_cast<int>(d);
+        else value = d;
+      }
+      // A value its declared slot cannot hold is skipped like an unparsable one
+      if (fitSchema(pk, value)) m_params[pk] = std::move(value);
     }
-    else if (key.rfind("s_", 0) == 0)
-    {
-      int idx = std::stoi(key.substr(2));
-      m_params[static_cast<ParamKey>(idx)] = toAscii(val);
-    }
+    else deserializeField(f);
+  }
+}
+
+bool Feature::fitSchema(ParamKey key, ParamValue& value) const
+{
+  const int slot = m_params.schema().slot(key);
+  if (slot < 0) return true; // overflow keys hold any type
+  switch (m_params.schema().entries[static_cast<std::size_t>(slot)].type)
+  {
+    case ParamType::Int:
+      return std::holds_alternative<int>(value);
+    case ParamType::Double:
+      if (const int* i = std::get_if<int>(&value)) value = static_cast<double>(*i);
+      return std::holds_alternative<double>(value);
+    case ParamType::String:
+      return std::holds_alternative<TCollection_AsciiString>(value);
   }
+  return false;
 }
 
-double Feature::paramAsDouble(const ParamMap& pm, ParamKey key, double defVal)
+std::uint64_t Feature::contentHash() const
 {
-  auto it = pm.find(key);
-  if (it == pm.end())
-    return defVal;
-  const ParamValue& v = it->second;
-  if (std::holds_alternative<double>(v))
-    return std::get<double>(v);
-  if (std::holds_alternative<int>(v))
-    return static_cast<double>(std::get<int>(v));
-  return defVal;
+  ensureLoaded();
+  // Declared slots come first, then overflow keys; merge into global key order
+  std::vector<const ParamMap::value_type*> sorted;
+  sorted.reserve(m_params.size());
+  for (const auto& kv : m_params) sorted.push_back(&kv);
+  std::sort(sorted.begin(), sorted.end(), [](const auto* a, const auto* b) { return a->first < b->first; });
+
+  ContentHash h;
+  h.add(static_cast<int>(kind()));
+  for (const auto* kv : sorted)
+  {
+    h.add(static_cast<int>(kv->first)).add(static_cast<int>(kv->second.index()));
+    if (std::holds_alternative<int>(kv->second))
+      h.add(std::get<int>(kv->second));
+    else if (std::holds_alternative<double>(kv->second))
+      h.add(std::get<double>(kv->second));
+    else
+      h.add(std::string(std::get<TCollection_AsciiString>(kv->second).ToCString()));
+  }
+  return h.value();
 }
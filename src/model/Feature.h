@@ -4,14 +4,19 @@
 #include <Standard_Transient.hxx>
 #include <TopoDS_Shape.hxx>
 #include <TCollection_AsciiString.hxx>
+#include <Message_ProgressRange.hxx>
 
-#include <unordered_map>
+#include <atomic>
+#include <cstdint>
+#include <utility>
 #include <variant>
 #include <string>
 
 #include <DocumentItem.h>
+#include <ParamStore.h>
 
 class Feature;
+namespace FieldText { struct Field; }
 DEFINE_STANDARD_HANDLE(Feature, Standard_Transient)
 
 // Abstract feature with typed parameter map and resulting shape
@@ -46,6 +51,7 @@ public:
     Length,
     FixedGeometry,        // bool stored as 0/1
     Transparency, // 0..1 where 0=opaque, 1=fully transparent
+    Count,        // number of keys; not a parameter
   };
 
   struct ParamKeyHash
@@ -53,43 +59,166 @@ public:
     std::size_t operator()(ParamKey k) const noexcept { return static_cast<std::size_t>(k); }
   };
 
-  using ParamValue = std::variant<int, double, TCollection_AsciiString>;     // numeric or string param
-  using ParamMap   = std::unordered_map<ParamKey, ParamValue, ParamKeyHash>; // keyed parameter map
-
+  static constexpr std::size_t kParamKeyCount = static_cast<std::size_t>(ParamKey::Count);
+
+  using ParamValue  = std::variant<int, double, TCollection_AsciiString>;           // numeric or string param
+  using ParamSchema = ::ParamSchema<ParamKey, kParamKeyCount>;                      // per-type key layout
+  using ParamMap    = FlatParamStore<ParamKey, ParamValue, kParamKeyCount>;         // keyed parameter map
+
+  Feature() = default;
+  // Subclasses pass their static schema so declared keys get flat slots
+  explicit Feature(const ParamSchema& schema) : m_params(schema) {}
+  Feature(PersistedId id, const ParamSchema& schema) : DocumentItem(id.value), m_params(schema) {}
+  // Copies carry the pending state with them (Document::clone() re-targets it) but not the edit
+  // hook: edits of a copy are not part of the original's history
+  Feature(const Feature& o)
+    : DocumentItem(o),
+      m_name(o.m_name),
+      m_params(o.m_params),
+      m_shape(o.m_shape),
+      m_suppressed(o.m_suppressed),
+      m_isDatumRelated(o.m_isDatumRelated),
+      m_evaluator(o.m_evaluator.load(std::memory_order_acquire))
+  {
+  }
   virtual ~Feature() = default;
 
   // Compute the resulting shape using current parameters
   virtual void execute() = 0;
 
-  // Access computed shape
-  virtual const TopoDS_Shape& shape() const { return m_shape; }
+  // Revision of execute() that goes into result cache keys; bumped when a kind builds a different shape
+  // from the same inputs, so results cached on disk by an older build are not served
+  virtual std::uint32_t algorithmVersion() const { return 1; }
+
+  // Independent copy with the same id, parameters, links and current result (used for recompute snapshots)
+  virtual Handle(Feature) clone() const = 0;
+
+  // Progress/cancellation for the running execute(); installed by Document::recompute()
+  void setProgressRange(const Message_ProgressRange* range) { m_progress = range; }
+
+  // Access computed shape; a feature left pending by a lazy recompute is evaluated here first
+  virtual const TopoDS_Shape& shape() const
+  {
+    if (Evaluator* e = m_evaluator.load(std::memory_order_acquire)) e->evaluate(*this);
+    return m_shape;
+  }
+
+  // Result as currently held, without triggering lazy evaluation
+  const TopoDS_Shape& currentShape() const { return m_shape; }
+
+  // Deferred execution hook installed by Document's lazy mode; the evaluator clears it once the
+  // result is in place, so a reader that sees no evaluator also sees the shape
+  class Evaluator
+  {
+  public:
+    virtual ~Evaluator() = default;
+    virtual void evaluate(const Feature& f) = 0;
+  };
+  void setEvaluator(Evaluator* e) { m_evaluator.store(e, std::memory_order_release); }
+  bool isPendingEvaluation() const { return m_evaluator.load(std::memory_order_acquire) != nullptr; }
+
+  // Edit hook installed by the owning Document (undo journal): setParam() and setSuppressed(), and
+  // so every typed setter, report the previous value just before applying a change
+  class EditObserver
+  {
+  public:
+    virtual ~EditObserver() = default;
+    virtual void paramChanging(Feature& f, ParamKey key, const ParamValue* before, const ParamValue& after) = 0;
+    virtual void suppressionChanging(Feature& f, bool after) = 0;
+  };
+  void setEditObserver(EditObserver* o) { m_editObserver = o; }
+
+  // Install a result computed elsewhere (e.g. a shape cache hit) instead of executing
+  void setShape(const TopoDS_Shape& s)
+  {
+    m_shape = s;
+    touch();
+  }
 
   // Optional: basic name and parameter accessors
+  // Name, suppression and datum flags are read without loading a deferred payload (history views);
+  // their setters load it first so the payload cannot overwrite them later
   const TCollection_AsciiString& name() const { return m_name; }
 
-  void setName(const TCollection_AsciiString& theName) { m_name = theName; }
+  void setName(const TCollection_AsciiString& theName)
+  {
+    ensureLoaded();
+    m_name = theName;
+    touch();
+  }
 
-  const ParamMap& params() const { return m_params; }
+  const ParamMap& params() const
+  {
+    ensureLoaded();
+    return m_params;
+  }
 
-  ParamMap& params() { return m_params; }
+  // Mutable access marks the feature dirty so the next recompute re-executes it
+  ParamMap& params()
+  {
+    ensureLoaded();
+    markDirty();
+    return m_params;
+  }
+
+  // Declared keys keep their schema type: an int widens into a Double slot, any other mismatch is
+  // rejected (false) and leaves the parameter as it was
+  bool setParam(ParamKey key, ParamValue value)
+  {
+    ensureLoaded();
+    if (!fitSchema(key, value)) return false;
+    if (m_editObserver) m_editObserver->paramChanging(*this, key, m_params.get(key), value);
+    m_params[key] = std::move(value);
+    markDirty();
+    return true;
+  }
+
+  // Loaders only: table-of-contents fields of an item whose payload is deferred
+  void restoreHeader(const TCollection_AsciiString& name, bool suppressed, bool datumRelated)
+  {
+    m_name = name;
+    m_suppressed = suppressed;
+    m_isDatumRelated = datumRelated;
+  }
 
-  // Suppression flag: suppressed features are skipped during recompute and not displayed
+  // Suppression flag: suppressed features are skipped during recompute and not displayed.
+  // Un-suppressing marks the feature dirty since its result may be stale.
   bool isSuppressed() const { return m_suppressed; }
-  void setSuppressed(bool on) { m_suppressed = on; }
+  void setSuppressed(bool on)
+  {
+    ensureLoaded();
+    if (m_suppressed == on) return;
+    if (m_editObserver) m_editObserver->suppressionChanging(*this, on);
+    m_suppressed = on;
+    if (!on) markDirty();
+    else touch();
+  }
 
   // Fixed-geometry flag: common helper for datum-like immutable features
-  void setFixedGeometry(bool on) { m_params[ParamKey::FixedGeometry] = on ? 1 : 0; }
-  bool isFixedGeometry() const { return paramAsDouble(m_params, ParamKey::FixedGeometry, 0.0) != 0.0; }
+  void setFixedGeometry(bool on) { setParam(ParamKey::FixedGeometry, on ? 1 : 0); }
+  bool isFixedGeometry() const { return paramAsDouble(params(), ParamKey::FixedGeometry, 0.0) != 0.0; }
 
   // Datum-related flag: marks helper items created from DocumentInitializer (planes, axes, origin point)
   bool isDatumRelated() const { return m_isDatumRelated; }
-  void setDatumRelated(bool on) { m_isDatumRelated = on; }
+  void setDatumRelated(bool on)
+  {
+    ensureLoaded();
+    m_isDatumRelated = on;
+    touch();
+  }
 
   // DocumentItem interface
   // Base Feature encodes common fields: name, suppressed flag, and params
   virtual Kind kind() const override = 0;
   std::string serialize() const override;
-  void        deserialize(const std::string& data) override;
+  void        deserialize(std::string_view data) override;
+  // Kind and parameters in key order; name and suppression do not affect the result
+  std::uint64_t contentHash() const override;
+
+protected:
+  // Subclass fields after the parameters (links); deserialize() hands over the keys it does not know
+  virtual void serializeFields(std::string& /*out*/) const {}
+  virtual void deserializeField(const FieldText::Field& /*f*/) {}
 
 protected:
   TCollection_AsciiString m_name;
@@ -97,7 +226,23 @@ protected:
   TopoDS_Shape            m_shape; // resulting shape
   bool                    m_suppressed = false; // execution/display suppressed
   bool                    m_isDatumRelated = false; // true for features tied to Datum helpers
+  const Message_ProgressRange* m_progress = nullptr;    // valid only during execute()
+  std::atomic<Evaluator*> m_evaluator{nullptr};       // set while a lazy result is pending
+  EditObserver*           m_editObserver = nullptr;   // set while the feature is in a document
+
+  // Converts value to the type the schema declares for key (int to double); false when it cannot hold it
+  bool fitSchema(ParamKey key, ParamValue& value) const;
+
+  // Range to hand to long-running kernel calls; inactive outside recompute
+  Message_ProgressRange progressRange() const { return m_progress ? *m_progress : Message_ProgressRange(); }
 
   // Helper: read numeric parameter as double (accepts int/double; otherwise returns defVal)
-  static double paramAsDouble(const ParamMap& pm, ParamKey key, double defVal);
+  static double paramAsDouble(const ParamMap& pm, ParamKey key, double defVal)
+  {
+    const ParamValue* v = pm.get(key);
+    if (!v) return defVal;
+    if (const double* d = std::get_if<double>(v)) return *d;
+    if (const int* i = std::get_if<int>(v)) return static_cast<double>(*i);
+    return defVal;
+  }
 };
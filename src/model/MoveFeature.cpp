@@ -1,21 +1,23 @@
 #include "MoveFeature.h"
 
 #include <DocumentItem.h>
+#include <ContentHash.h>
+#include <FieldText.h>
 #include <BRepBuilderAPI_Transform.hxx>
 #include <gp_Ax1.hxx>
 #include <gp_Trsf.hxx>
+#include <TopLoc_Location.hxx>
 #include <gp_Quaternion.hxx>
 #include <gp_EulerSequence.hxx>
 #include <gp.hxx>
 
-#include <sstream>
 #include <cmath>
 
 IMPLEMENT_STANDARD_RTTIEXT(MoveFeature, Feature)
 
 namespace {
 const bool kMoveFeatureReg = [](){
-  DocumentItem::registerFactory(DocumentItem::Kind::MoveFeature, [](){ return std::shared_ptr<DocumentItem>(new MoveFeature()); });
+  DocumentItem::registerFactory(DocumentItem::Kind::MoveFeature, [](DocumentItem::PersistedId id) -> DocumentItem* { return new MoveFeature(id); });
   return true;
 }();
 }
@@ -45,31 +47,48 @@ void MoveFeature::execute()
     trsf.SetTransformation(q, gp_Vec(tx(), ty(), tz()));
   }
 
-  BRepBuilderAPI_Transform tr(m_source->shape(), trsf, true);
+  const TopoDS_Shape& src = m_source->shape();
+  if (src.IsNull())
+  {
+    m_shape = TopoDS_Shape();
+    return;
+  }
+
+  // Rigid motions become a location on the shared source geometry (no BRep copy).
+  // Folding the source's own location in keeps a chain of moves as one composed gp_Trsf.
+  const bool rigid = std::abs(trsf.ScaleFactor() - 1.0) <= gp::Resolution() && !trsf.IsNegative();
+  if (rigid)
+  {
+    gp_Trsf composed = trsf;
+    composed.Multiply(src.Location().Transformation());
+    m_shape = src.Located(TopLoc_Location(composed));
+    return;
+  }
+
+  // Scaling/mirroring cannot live in a location: transform a copy
+  BRepBuilderAPI_Transform tr(src, trsf, true);
   m_shape = tr.Shape();
 }
 
-// Append base Feature encoding + move-specific fields
-std::string MoveFeature::serialize() const
+std::uint64_t MoveFeature::contentHash() const
 {
-  std::ostringstream os;
-  os << Feature::serialize();
-  os << "sourceId=" << m_sourceId << "\n";
-  return os.str();
+  ContentHash h;
+  h.add(Feature::contentHash()).add(static_cast<int>(m_delta.Form()));
+  for (int r = 1; r <= 3; ++r)
+    for (int c = 1; c <= 4; ++c)
+      h.add(m_delta.Value(r, c));
+  return h.value();
 }
 
-void MoveFeature::deserialize(const std::string& data)
+// Link after the base Feature encoding
+void MoveFeature::serializeFields(std::string& out) const
 {
-  Feature::deserialize(data);
-  std::size_t pos = 0;
-  while (pos < data.size())
-  {
-    std::size_t eol = data.find('\n', pos);
-    std::string line = data.substr(pos, eol == std::string::npos ? std::string::npos : eol - pos);
-    pos = (eol == std::string::npos) ? data.size() : eol + 1;
-    if (line.rfind("sourceId=", 0) == 0)
-    {
-      m_sourceId = static_cast<DocumentItem::Id>(std::stoull(line.substr(9)));
-    }
-  }
+  out += "sourceId=";
+  FieldText::appendInteger(out, m_sourceId);
+  out += '\n';
+}
+
+void MoveFeature::deserializeField(const FieldText::Field& f)
+{
+  if (f.key == "sourceId") FieldText::parseInteger(f.value, m_sourceId);
 }
@@ -9,42 +9,60 @@ class MoveFeature;
 DEFINE_STANDARD_HANDLE(MoveFeature, Feature)
 
 // Move feature: applies a rigid transform (T + R) to a source Feature's shape
+// - The result shares the source geometry through a TopLoc_Location; chained moves compose into one gp_Trsf
 class MoveFeature : public Feature
 {
   DEFINE_STANDARD_RTTIEXT(MoveFeature, Feature)
 
 public:
-  MoveFeature() = default;
+  MoveFeature() : Feature(kSchema) {}
+  explicit MoveFeature(PersistedId id) : Feature(id, kSchema) {} // loaders
 
   // Construct with explicit source link and params
   MoveFeature(DocumentItem::Id sourceId,
               double tx, double ty, double tz,
               double rxDeg, double ryDeg, double rzDeg)
-    : m_sourceId(sourceId)
+    : Feature(kSchema), m_sourceId(sourceId)
   {
     setTranslation(tx, ty, tz);
     setRotation(rxDeg, ryDeg, rzDeg);
   }
 
   // Runtime linkage helpers
-  void setSource(const Handle(Feature)& src) { m_source = src; }
+  void setSource(const Handle(Feature)& src)
+  {
+    m_source = src;
+    markDirty();
+  }
   Handle(Feature) source() const { return m_source; }
 
-  void setSourceId(DocumentItem::Id id) { m_sourceId = id; }
-  DocumentItem::Id sourceId() const { return m_sourceId; }
+  // Changing the id drops a runtime source resolved for the previous id
+  void setSourceId(DocumentItem::Id id)
+  {
+    ensureLoaded();
+    if (id == m_sourceId) return;
+    if (!m_source.IsNull() && m_source->id() != id) m_source.Nullify();
+    m_sourceId = id;
+    markDirty();
+  }
+  DocumentItem::Id sourceId() const
+  {
+    ensureLoaded();
+    return m_sourceId;
+  }
 
   // Param setters/getters
   void setTranslation(double tx, double ty, double tz)
   {
-    params()[Feature::ParamKey::Tx] = tx;
-    params()[Feature::ParamKey::Ty] = ty;
-    params()[Feature::ParamKey::Tz] = tz;
+    setParam(Feature::ParamKey::Tx, tx);
+    setParam(Feature::ParamKey::Ty, ty);
+    setParam(Feature::ParamKey::Tz, tz);
   }
   void setRotation(double rxDeg, double ryDeg, double rzDeg)
   {
-    params()[Feature::ParamKey::Rx] = rxDeg;
-    params()[Feature::ParamKey::Ry] = ryDeg;
-    params()[Feature::ParamKey::Rz] = rzDeg;
+    setParam(Feature::ParamKey::Rx, rxDeg);
+    setParam(Feature::ParamKey::Ry, ryDeg);
+    setParam(Feature::ParamKey::Rz, rzDeg);
   }
 
   double tx() const { return Feature::paramAsDouble(params(), Feature::ParamKey::Tx, 0.0); }
@@ -55,16 +73,36 @@ public:
   double rzDeg() const { return Feature::paramAsDouble(params(), Feature::ParamKey::Rz, 0.0); }
 
   void execute() override;
+  std::uint32_t algorithmVersion() const override { return 2; } // 2: located instead of copied
+  Handle(Feature) clone() const override { return new MoveFeature(*this); }
 
   // Provide exact affine delta from interactive manipulator
-  void setDeltaTrsf(const gp_Trsf& t) { m_delta = t; }
+  void setDeltaTrsf(const gp_Trsf& t)
+  {
+    m_delta = t;
+    markDirty();
+  }
   const gp_Trsf& deltaTrsf() const { return m_delta; }
 
 public:
+  // Parameter layout: declared keys are stored in flat slots
+  static constexpr ParamSchema kSchema{
+      {ParamKey::Tx, ParamType::Double},
+      {ParamKey::Ty, ParamType::Double},
+      {ParamKey::Tz, ParamType::Double},
+      {ParamKey::Rx, ParamType::Double},
+      {ParamKey::Ry, ParamType::Double},
+      {ParamKey::Rz, ParamType::Double},
+  };
+
   // DocumentItem
-  Kind kind() const override { return Kind::MoveFeature; }
-  std::string serialize() const override;
-  void        deserialize(const std::string& data) override;
+  static constexpr Kind StaticKind = Kind::MoveFeature; // for Document::itemsOfKind<T>()
+  Kind kind() const override { return StaticKind; }
+  std::uint64_t contentHash() const override; // params + exact delta
+
+protected:
+  void serializeFields(std::string& out) const override;
+  void deserializeField(const FieldText::Field& f) override;
 
 private:
   Handle(Feature)  m_source;   // runtime resolved source feature (optional)
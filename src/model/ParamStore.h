@@ -0,0 +1,213 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+// Value type a schema declares for a parameter key
+enum class ParamType : std::uint8_t
+{
+  Int,
+  Double,
+  String,
+};
+
+// Compile-time parameter layout of one feature type: declared keys get dense slots in key order
+// - Key is a small enum with values 0..N-1
+template <class Key, std::size_t N>
+struct ParamSchema
+{
+  struct Entry
+  {
+    Key       key;
+    ParamType type;
+  };
+
+  std::array<std::int8_t, N> slotOf{};   // slot index per key, -1 when not declared
+  std::array<Entry, N>       entries{};  // declared keys, ascending
+  std::size_t                size = 0;
+
+  constexpr ParamSchema() { for (auto& s : slotOf) s = -1; }
+  constexpr ParamSchema(std::initializer_list<Entry> declared)
+  {
+    for (auto& s : slotOf) s = -1;
+    for (const Entry& e : declared)
+    {
+      // Insertion sort keeps slots in key order
+      std::size_t i = size++;
+      while (i > 0 && static_cast<std::size_t>(entries[i - 1].key) > static_cast<std::size_t>(e.key))
+      {
+        entries[i] = entries[i - 1];
+        --i;
+      }
+      entries[i] = e;
+    }
+    for (std::size_t i = 0; i < size; ++i) slotOf[static_cast<std::size_t>(entries[i].key)] = static_cast<std::int8_t>(i);
+  }
+
+  int       slot(Key k) const { return slotOf[static_cast<std::size_t>(k)]; }
+  ParamType typeOf(Key k, ParamType fallback) const
+  {
+    const int s = slot(k);
+    return s < 0 ? fallback : entries[static_cast<std::size_t>(s)].type;
+  }
+};
+
+// Flat parameter storage indexed by key through a ParamSchema
+// - Declared keys live in one contiguous block (a single allocation per feature)
+// - Undeclared keys still work through a sorted overflow list (binary search)
+// - The store holds any Value in any slot; Feature::setParam() keeps declared slots to their ParamType
+// - Map-like surface (operator[], find/count/erase, iteration over (key, value) pairs)
+//   so callers written against std::unordered_map keep compiling
+template <class Key, class Value, std::size_t N>
+class FlatParamStore
+{
+  static_assert(N <= 64, "presence mask holds at most 64 keys");
+
+public:
+  using Schema     = ParamSchema<Key, N>;
+  using value_type = std::pair<Key, Value>;
+
+  explicit FlatParamStore(const Schema& schema = emptySchema())
+    : m_schema(&schema)
+  {
+    m_slots.reserve(schema.size);
+    for (std::size_t i = 0; i < schema.size; ++i) m_slots.emplace_back(schema.entries[i].key, Value());
+  }
+
+  const Schema& schema() const { return *m_schema; }
+
+  // Lookup: nullptr when the key is absent
+  const Value* get(Key k) const
+  {
+    const int s = m_schema->slot(k);
+    if (s >= 0) return (m_present >> s) & 1u ? &m_slots[static_cast<std::size_t>(s)].second : nullptr;
+    auto it = findExtra(k);
+    return (it != m_extra.end() && it->first == k) ? &it->second : nullptr;
+  }
+  std::size_t count(Key k) const { return get(k) ? 1 : 0; }
+  bool        contains(Key k) const { return get(k) != nullptr; }
+
+  void set(Key k, const Value& v) { (*this)[k] = v; }
+
+  // Inserts a default value when absent (std::map semantics)
+  Value& operator[](Key k)
+  {
+    const int s = m_schema->slot(k);
+    if (s >= 0)
+    {
+      m_present |= std::uint64_t(1) << s;
+      return m_slots[static_cast<std::size_t>(s)].second;
+    }
+    auto it = findExtra(k);
+    if (it == m_extra.end() || it->first != k) it = m_extra.emplace(it, k, Value());
+    return it->second;
+  }
+
+  bool erase(Key k)
+  {
+    const int s = m_schema->slot(k);
+    if (s >= 0)
+    {
+      const std::uint64_t bit = std::uint64_t(1) << s;
+      if (!(m_present & bit)) return false;
+      m_present &= ~bit;
+      m_slots[static_cast<std::size_t>(s)].second = Value();
+      return true;
+    }
+    auto it = findExtra(k);
+    if (it == m_extra.end() || it->first != k) return false;
+    m_extra.erase(it);
+    return true;
+  }
+
+  void clear()
+  {
+    for (std::size_t i = 0; i < m_slots.size(); ++i)
+      if ((m_present >> i) & 1u) m_slots[i].second = Value();
+    m_present = 0;
+    m_extra.clear();
+  }
+
+  std::size_t size() const { return static_cast<std::size_t>(popcount(m_present)) + m_extra.size(); }
+  bool        empty() const { return m_present == 0 && m_extra.empty(); }
+
+  // Iterates present entries: declared slots (ascending key), then overflow (ascending key)
+  class const_iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = FlatParamStore::value_type;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const value_type*;
+    using reference         = const value_type&;
+
+    const_iterator(const FlatParamStore* s, std::size_t i) : m_store(s), m_index(i) { skip(); }
+    reference       operator*() const { return m_store->at(m_index); }
+    pointer         operator->() const { return &m_store->at(m_index); }
+    const_iterator& operator++()
+    {
+      ++m_index;
+      skip();
+      return *this;
+    }
+    bool operator==(const const_iterator& o) const { return m_index == o.m_index; }
+    bool operator!=(const const_iterator& o) const { return m_index != o.m_index; }
+
+  private:
+    void skip()
+    {
+      while (m_index < m_store->m_slots.size() && !((m_store->m_present >> m_index) & 1u)) ++m_index;
+    }
+    const FlatParamStore* m_store;
+    std::size_t           m_index;
+  };
+
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, m_slots.size() + m_extra.size()); }
+  const_iterator find(Key k) const
+  {
+    const int s = m_schema->slot(k);
+    if (s >= 0) return (m_present >> s) & 1u ? const_iterator(this, static_cast<std::size_t>(s)) : end();
+    auto it = findExtra(k);
+    if (it == m_extra.end() || it->first != k) return end();
+    return const_iterator(this, m_slots.size() + static_cast<std::size_t>(it - m_extra.begin()));
+  }
+
+  static const Schema& emptySchema()
+  {
+    static const Schema kEmpty;
+    return kEmpty;
+  }
+
+private:
+  const value_type& at(std::size_t i) const { return i < m_slots.size() ? m_slots[i] : m_extra[i - m_slots.size()]; }
+
+  // First overflow entry not below k
+  static bool keyBelow(const value_type& e, Key k) { return static_cast<std::size_t>(e.first) < static_cast<std::size_t>(k); }
+  typename std::vector<value_type>::const_iterator findExtra(Key k) const
+  {
+    return std::lower_bound(m_extra.begin(), m_extra.end(), k, keyBelow);
+  }
+  typename std::vector<value_type>::iterator findExtra(Key k)
+  {
+    return std::lower_bound(m_extra.begin(), m_extra.end(), k, keyBelow);
+  }
+
+  static int popcount(std::uint64_t v)
+  {
+    int n = 0;
+    for (; v; v &= v - 1) ++n;
+    return n;
+  }
+
+  const Schema*           m_schema;
+  std::vector<value_type> m_slots;    // one per declared key
+  std::uint64_t           m_present{0};
+  std::vector<value_type> m_extra;    // undeclared keys, sorted
+};
@@ -11,7 +11,7 @@ IMPLEMENT_STANDARD_RTTIEXT(PlaneFeature, Feature)
 
 namespace {
 const bool kPlaneFeatureReg = [](){
-  DocumentItem::registerFactory(DocumentItem::Kind::PlaneFeature, [](){ return std::shared_ptr<DocumentItem>(new PlaneFeature()); });
+  DocumentItem::registerFactory(DocumentItem::Kind::PlaneFeature, [](DocumentItem::PersistedId id) -> DocumentItem* { return new PlaneFeature(id); });
   return true;
 }();
 }
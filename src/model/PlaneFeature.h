@@ -21,9 +21,11 @@ class PlaneFeature : public Feature
   DEFINE_STANDARD_RTTIEXT(PlaneFeature, Feature)
 
 public:
-  PlaneFeature() = default;
+  PlaneFeature() : Feature(kSchema) {}
+  explicit PlaneFeature(PersistedId id) : Feature(id, kSchema) {} // loaders
 
   PlaneFeature(const gp_Pnt& origin, const gp_Dir& normal, double size)
+    : Feature(kSchema)
   {
     setOrigin(origin);
     setNormal(normal);
@@ -33,17 +35,17 @@ public:
   // Param setters
   void setOrigin(const gp_Pnt& p)
   {
-    params()[Feature::ParamKey::Ox] = p.X();
-    params()[Feature::ParamKey::Oy] = p.Y();
-    params()[Feature::ParamKey::Oz] = p.Z();
+    setParam(Feature::ParamKey::Ox, p.X());
+    setParam(Feature::ParamKey::Oy, p.Y());
+    setParam(Feature::ParamKey::Oz, p.Z());
   }
   void setNormal(const gp_Dir& n)
   {
-    params()[Feature::ParamKey::Nx] = n.X();
-    params()[Feature::ParamKey::Ny] = n.Y();
-    params()[Feature::ParamKey::Nz] = n.Z();
+    setParam(Feature::ParamKey::Nx, n.X());
+    setParam(Feature::ParamKey::Ny, n.Y());
+    setParam(Feature::ParamKey::Nz, n.Z());
   }
-  void setSize(double s) { params()[Feature::ParamKey::Size] = s; }
+  void setSize(double s) { setParam(Feature::ParamKey::Size, s); }
 
   // Param getters
   gp_Pnt origin() const;
@@ -51,11 +53,12 @@ public:
   double size() const;
 
   // Modifiers
-  void  setTransparency(double t) { params()[Feature::ParamKey::Transparency] = t; }
+  void  setTransparency(double t) { setParam(Feature::ParamKey::Transparency, t); }
   double transparency() const;
 
   // Feature API
   void execute() override;
+  Handle(Feature) clone() const override { return new PlaneFeature(*this); }
 
   // Default visual style for all datum planes
   static Quantity_Color defaultColor()
@@ -67,6 +70,20 @@ public:
   // Apply visual style to an AIS shape (color + transparency)
   void applyStyle(const Handle(AIS_Shape)& ais) const;
 
+  // Parameter layout: declared keys are stored in flat slots
+  static constexpr ParamSchema kSchema{
+      {ParamKey::Ox, ParamType::Double},
+      {ParamKey::Oy, ParamType::Double},
+      {ParamKey::Oz, ParamType::Double},
+      {ParamKey::Nx, ParamType::Double},
+      {ParamKey::Ny, ParamType::Double},
+      {ParamKey::Nz, ParamType::Double},
+      {ParamKey::Size, ParamType::Double},
+      {ParamKey::FixedGeometry, ParamType::Int},
+      {ParamKey::Transparency, ParamType::Double},
+  };
+
   // DocumentItem
-  Kind kind() const override { return Kind::PlaneFeature; }
+  static constexpr Kind StaticKind = Kind::PlaneFeature; // for Document::itemsOfKind<T>()
+  Kind kind() const override { return StaticKind; }
 };
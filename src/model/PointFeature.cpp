@@ -7,7 +7,7 @@ IMPLEMENT_STANDARD_RTTIEXT(PointFeature, Feature)
 
 namespace {
 const bool kPointFeatureReg = [](){
-  DocumentItem::registerFactory(DocumentItem::Kind::PointFeature, [](){ return std::shared_ptr<DocumentItem>(new PointFeature()); });
+  DocumentItem::registerFactory(DocumentItem::Kind::PointFeature, [](DocumentItem::PersistedId id) -> DocumentItem* { return new PointFeature(id); });
   return true;
 }();
 }
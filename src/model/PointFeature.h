@@ -17,9 +17,11 @@ class PointFeature : public Feature
   DEFINE_STANDARD_RTTIEXT(PointFeature, Feature)
 
 public:
-  PointFeature() = default;
+  PointFeature() : Feature(kSchema) {}
+  explicit PointFeature(PersistedId id) : Feature(id, kSchema) {} // loaders
 
   explicit PointFeature(const gp_Pnt& origin, double radius = 10.0)
+    : Feature(kSchema)
   {
     setOrigin(origin);
     setRadius(radius);
@@ -28,23 +30,35 @@ public:
   // Param setters
   void setOrigin(const gp_Pnt& p)
   {
-    params()[Feature::ParamKey::Ox] = p.X();
-    params()[Feature::ParamKey::Oy] = p.Y();
-    params()[Feature::ParamKey::Oz] = p.Z();
+    setParam(Feature::ParamKey::Ox, p.X());
+    setParam(Feature::ParamKey::Oy, p.Y());
+    setParam(Feature::ParamKey::Oz, p.Z());
   }
-  void setRadius(double r) { params()[Feature::ParamKey::Radius] = r; }
+  void setRadius(double r) { setParam(Feature::ParamKey::Radius, r); }
 
   // Param getters
   gp_Pnt origin() const;
   double radius() const;
 
   // Modifiers
-  void  setTransparency(double t) { params()[Feature::ParamKey::Transparency] = t; }
+  void  setTransparency(double t) { setParam(Feature::ParamKey::Transparency, t); }
   double transparency() const;
 
   // Feature API
   void execute() override;
+  Handle(Feature) clone() const override { return new PointFeature(*this); }
+
+  // Parameter layout: declared keys are stored in flat slots
+  static constexpr ParamSchema kSchema{
+      {ParamKey::Ox, ParamType::Double},
+      {ParamKey::Oy, ParamType::Double},
+      {ParamKey::Oz, ParamType::Double},
+      {ParamKey::Radius, ParamType::Double},
+      {ParamKey::FixedGeometry, ParamType::Int},
+      {ParamKey::Transparency, ParamType::Double},
+  };
 
   // DocumentItem
-  Kind kind() const override { return Kind::PointFeature; }
+  static constexpr Kind StaticKind = Kind::PointFeature; // for Document::itemsOfKind<T>()
+  Kind kind() const override { return StaticKind; }
 };
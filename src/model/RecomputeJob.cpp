@@ -0,0 +1,102 @@
+#include "RecomputeJob.h"
+
+#include "Document.h"
+
+#include <Message_ProgressIndicator.hxx>
+#include <Message_ProgressScope.hxx>
+#include <Standard_Failure.hxx>
+
+#include <exception>
+
+namespace {
+// Bridges the job's cancel flag into OCCT progress ranges
+class JobProgressIndicator : public Message_ProgressIndicator
+{
+public:
+  explicit JobProgressIndicator(const std::atomic<bool>& cancel) : m_cancel(cancel) {}
+  Standard_Boolean UserBreak() override { return m_cancel.load(); }
+  void Show(const Message_ProgressScope&, const Standard_Boolean) override {}
+
+private:
+  const std::atomic<bool>& m_cancel;
+};
+}
+
+RecomputeJob::RecomputeJob(std::unique_ptr<Document> snapshot,
+                           std::unordered_map<DocumentItem::Id, std::uint64_t> revisions,
+                           Callbacks callbacks)
+  : m_snapshot(std::move(snapshot))
+  , m_revisions(std::move(revisions))
+  , m_callbacks(std::move(callbacks))
+{
+  m_indicator = new JobProgressIndicator(m_cancel);
+}
+
+RecomputeJob::~RecomputeJob()
+{
+  cancel();
+  // The last reference may be dropped from onFinished on the worker itself
+  if (m_worker.joinable() && m_worker.get_id() == std::this_thread::get_id())
+    m_worker.detach();
+  wait();
+}
+
+void RecomputeJob::start()
+{
+  m_snapshot->setFeatureCallback([this](DocumentItem::Id id, std::size_t done, std::size_t total) {
+    m_done = done;
+    m_total = total;
+    if (m_callbacks.onFeatureDone) m_callbacks.onFeatureDone(id, done, total);
+  });
+  m_worker = std::thread([this]() { run(); });
+}
+
+void RecomputeJob::run()
+{
+  State result = State::Finished;
+  try
+  {
+    m_snapshot->recompute(m_indicator->Start());
+    if (m_cancel) result = State::Cancelled;
+  }
+  catch (const Standard_Failure& e)
+  {
+    std::lock_guard<std::mutex> lock(m_errorMutex);
+    m_error = e.GetMessageString() ? e.GetMessageString() : "OCCT failure";
+    result = State::Failed;
+  }
+  catch (const std::exception& e)
+  {
+    std::lock_guard<std::mutex> lock(m_errorMutex);
+    m_error = e.what();
+    result = State::Failed;
+  }
+  catch (...)
+  {
+    std::lock_guard<std::mutex> lock(m_errorMutex);
+    m_error = "unknown error";
+    result = State::Failed;
+  }
+  // Copy first: the callback may release the last reference to this job
+  const std::function<void(State)> onFinished = m_callbacks.onFinished;
+  m_state = result;
+  if (onFinished) onFinished(result);
+}
+
+void RecomputeJob::wait()
+{
+  if (m_worker.joinable() && m_worker.get_id() != std::this_thread::get_id()) m_worker.join();
+}
+
+double RecomputeJob::progress() const
+{
+  if (m_state == State::Finished) return 1.0;
+  const std::size_t total = m_total;
+  return total == 0 ? 0.0 : static_cast<double>(m_done) / static_cast<double>(total);
+}
+
+std::string RecomputeJob::error() const
+{
+  std::lock_guard<std::mutex> lock(m_errorMutex);
+  return m_error;
+}
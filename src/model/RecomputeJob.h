@@ -0,0 +1,76 @@
+#pragma once
+
+#include <DocumentItem.h>
+#include <Message_ProgressIndicator.hxx>
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+class Document;
+
+// Background recompute started by Document::recomputeAsync()
+// - Runs Document::recompute() on a worker thread against a private snapshot of the document
+// - Reports per-feature progress; cancel() aborts through the Message_ProgressRange passed to the kernel
+// - Results stay in the snapshot until Document::publish() installs them in one step on the owner thread
+class RecomputeJob
+{
+public:
+  enum class State
+  {
+    Running,
+    Finished,  // snapshot holds a complete result; ready to publish
+    Cancelled,
+    Failed,
+  };
+
+  struct Callbacks
+  {
+    // After each feature (worker thread; concurrently from several workers in parallel mode)
+    std::function<void(DocumentItem::Id id, std::size_t done, std::size_t total)> onFeatureDone;
+    // Once, from the worker thread, when the job leaves Running
+    std::function<void(State state)> onFinished;
+  };
+
+  ~RecomputeJob(); // cancels and joins the worker
+
+  RecomputeJob(const RecomputeJob&) = delete;
+  RecomputeJob& operator=(const RecomputeJob&) = delete;
+
+  void   cancel() { m_cancel = true; }
+  bool   cancelRequested() const { return m_cancel; }
+  void   wait();                 // block until the worker exits
+  State  state() const { return m_state; }
+  bool   isDone() const { return m_state != State::Running; }
+  double progress() const;       // 0..1
+  std::size_t completedFeatures() const { return m_done; }
+  std::size_t totalFeatures() const { return m_total; }
+  std::string error() const;     // message when Failed
+
+private:
+  friend class Document;
+
+  RecomputeJob(std::unique_ptr<Document> snapshot,
+               std::unordered_map<DocumentItem::Id, std::uint64_t> revisions,
+               Callbacks callbacks);
+  void start();
+  void run();
+
+  std::unique_ptr<Document>                           m_snapshot;
+  std::unordered_map<DocumentItem::Id, std::uint64_t> m_revisions; // item revisions at snapshot time
+  Callbacks                                           m_callbacks;
+  Handle(Message_ProgressIndicator)                   m_indicator;
+  std::thread                                         m_worker;
+  std::atomic<bool>                                   m_cancel{false};
+  std::atomic<State>                                  m_state{State::Running};
+  std::atomic<std::size_t>                            m_done{0};
+  std::atomic<std::size_t>                            m_total{0};
+  mutable std::mutex                                  m_errorMutex;
+  std::string                                         m_error;
+  bool                                                m_published{false};
+};
@@ -0,0 +1,102 @@
+#include "RecomputeProfile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace {
+// Minimal JSON string escaping for names
+std::string jsonEscape(const std::string& s)
+{
+  std::string out;
+  out.reserve(s.size());
+  for (char c : s)
+  {
+    switch (c)
+    {
+      case '"': out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\t': out += "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20)
+        {
+          char buf[8];
+          std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+          out += buf;
+        }
+        else
+        {
+          out += c;
+        }
+    }
+  }
+  return out;
+}
+}
+
+const char* RecomputeProfile::kindName(DocumentItem::Kind kind)
+{
+  switch (kind)
+  {
+    case DocumentItem::Kind::Sketch: return "Sketch";
+    case DocumentItem::Kind::BoxFeature: return "Box";
+    case DocumentItem::Kind::CylinderFeature: return "Cylinder";
+    case DocumentItem::Kind::ExtrudeFeature: return "Extrude";
+    case DocumentItem::Kind::MoveFeature: return "Move";
+    case DocumentItem::Kind::PlaneFeature: return "Plane";
+    case DocumentItem::Kind::PointFeature: return "Point";
+    case DocumentItem::Kind::AxeFeature: return "Axe";
+  }
+  return "Item";
+}
+
+const char* RecomputeProfile::sourceName(Source source)
+{
+  switch (source)
+  {
+    case Source::Executed: return "execute";
+    case Source::MemoryCache: return "memory-cache";
+    case Source::DiskCache: return "disk-cache";
+    case Source::Checkpoint: return "checkpoint";
+  }
+  return "execute";
+}
+
+std::vector<RecomputeProfile::Sample> RecomputeProfile::slowest(std::size_t count) const
+{
+  std::vector<Sample> sorted = samples;
+  std::sort(sorted.begin(), sorted.end(), [](const Sample& a, const Sample& b) { return a.durationUs > b.durationUs; });
+  if (sorted.size() > count) sorted.resize(count);
+  return sorted;
+}
+
+std::string RecomputeProfile::toChromeTrace() const
+{
+  // Complete ("X") events on pid 1; one tid per recompute thread
+  std::ostringstream os;
+  os.precision(3);
+  os << std::fixed;
+  os << "{\"traceEvents\":[\n";
+  os << "{\"name\":\"recompute\",\"cat\":\"document\",\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":0,\"dur\":" << totalUs
+     << ",\"args\":{\"plan_us\":" << planUs << ",\"features\":" << samples.size() << "}}";
+  for (const Sample& s : samples)
+  {
+    const std::string label = s.name.empty() ? std::string(kindName(s.kind)) : s.name;
+    os << ",\n{\"name\":\"" << jsonEscape(label) << "\",\"cat\":\"" << kindName(s.kind) << "\",\"ph\":\"X\",\"pid\":1"
+       << ",\"tid\":" << s.thread << ",\"ts\":" << s.startUs << ",\"dur\":" << s.durationUs
+       << ",\"args\":{\"id\":" << s.id << ",\"source\":\"" << sourceName(s.source) << "\",\"solids\":" << s.solids
+       << ",\"faces\":" << s.faces << ",\"edges\":" << s.edges << "}}";
+  }
+  os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  return os.str();
+}
+
+bool RecomputeProfile::writeChromeTrace(const std::string& path) const
+{
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) return false;
+  out << toChromeTrace();
+  return static_cast<bool>(out);
+}
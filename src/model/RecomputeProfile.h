@@ -0,0 +1,50 @@
+#pragma once
+
+#include <DocumentItem.h>
+
+#include <string>
+#include <vector>
+
+// Timings collected by Document::recompute() when profiling is enabled
+// - One sample per planned feature, in plan order
+// - Times are microseconds relative to the start of the recompute
+// - Exportable as Chrome trace-event JSON (chrome://tracing, Perfetto)
+struct RecomputeProfile
+{
+  enum class Source
+  {
+    Executed,    // Feature::execute() ran
+    MemoryCache, // served by ShapeCache
+    DiskCache,   // served by DiskShapeCache
+    Checkpoint,  // restored from a rollback checkpoint
+  };
+
+  struct Sample
+  {
+    DocumentItem::Id   id{0};
+    DocumentItem::Kind kind{DocumentItem::Kind::BoxFeature};
+    std::string        name;          // Feature::name(), may be empty
+    Source             source{Source::Executed};
+    double             startUs{0.0};
+    double             durationUs{0.0};
+    int                thread{0};     // 0 = calling thread, then workers in order of first use
+    int                solids{0};
+    int                faces{0};
+    int                edges{0};
+  };
+
+  std::vector<Sample> samples;
+  double              planUs{0.0};  // dependency refresh + planning
+  double              totalUs{0.0}; // whole recompute()
+
+  bool empty() const { return samples.empty(); }
+
+  // Samples sorted by descending duration (hot features first)
+  std::vector<Sample> slowest(std::size_t count) const;
+
+  std::string toChromeTrace() const;
+  bool        writeChromeTrace(const std::string& path) const;
+
+  static const char* kindName(DocumentItem::Kind kind);
+  static const char* sourceName(Source source);
+};
@@ -0,0 +1,113 @@
+#include "ShapeCache.h"
+
+#include <TopAbs_ShapeEnum.hxx>
+#include <TopExp.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+
+namespace {
+// Approximate per-entity footprint (topology + geometry + small triangulation)
+constexpr std::size_t kBytesPerFace   = 1024;
+constexpr std::size_t kBytesPerEdge   = 256;
+constexpr std::size_t kBytesPerVertex = 96;
+constexpr std::size_t kBytesMinimum   = 128;
+
+std::size_t countUnique(const TopoDS_Shape& s, TopAbs_ShapeEnum type)
+{
+  TopTools_IndexedMapOfShape m;
+  TopExp::MapShapes(s, type, m);
+  return static_cast<std::size_t>(m.Extent());
+}
+}
+
+std::size_t ShapeCache::estimateBytes(const TopoDS_Shape& shape)
+{
+  if (shape.IsNull()) return 0;
+  return kBytesMinimum
+       + countUnique(shape, TopAbs_FACE) * kBytesPerFace
+       + countUnique(shape, TopAbs_EDGE) * kBytesPerEdge
+       + countUnique(shape, TopAbs_VERTEX) * kBytesPerVertex;
+}
+
+bool ShapeCache::find(Key key, TopoDS_Shape& out)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_index.find(key);
+  if (it == m_index.end())
+  {
+    ++m_stats.misses;
+    return false;
+  }
+  m_lru.splice(m_lru.begin(), m_lru, it->second);
+  out = it->second->shape;
+  ++m_stats.hits;
+  return true;
+}
+
+void ShapeCache::insert(Key key, const TopoDS_Shape& shape)
+{
+  if (shape.IsNull()) return;
+  // Size the entry outside the lock; walking topology may be slow
+  const std::size_t bytes = estimateBytes(shape);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (bytes > m_budget) return; // never fits
+  auto it = m_index.find(key);
+  if (it != m_index.end())
+  {
+    m_stats.bytes -= it->second->bytes;
+    m_lru.erase(it->second);
+    m_index.erase(it);
+  }
+  m_lru.push_front(Entry{key, shape, bytes});
+  m_index[key] = m_lru.begin();
+  m_stats.bytes += bytes;
+  evictOverBudget();
+}
+
+void ShapeCache::evictOverBudget()
+{
+  while (m_stats.bytes > m_budget && !m_lru.empty())
+  {
+    const Entry& victim = m_lru.back();
+    m_stats.bytes -= victim.bytes;
+    m_index.erase(victim.key);
+    m_lru.pop_back();
+    ++m_stats.evictions;
+  }
+}
+
+void ShapeCache::setBudget(std::size_t bytes)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_budget = bytes;
+  evictOverBudget();
+}
+
+std::size_t ShapeCache::budget() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_budget;
+}
+
+void ShapeCache::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_lru.clear();
+  m_index.clear();
+  m_stats.bytes = 0;
+}
+
+ShapeCache::Stats ShapeCache::stats() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Stats s = m_stats;
+  s.entries = m_index.size();
+  return s;
+}
+
+void ShapeCache::resetCounters()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_stats.hits = 0;
+  m_stats.misses = 0;
+  m_stats.evictions = 0;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <TopoDS_Shape.hxx>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+// Content-addressed memo of feature results keyed by input hash (see Document::recompute)
+// - LRU eviction under a byte budget (estimated from sub-shape counts)
+// - Hit/miss/eviction counters
+// - Thread-safe: parallel recompute looks up and inserts from worker threads
+class ShapeCache
+{
+public:
+  using Key = std::uint64_t;
+
+  struct Stats
+  {
+    std::size_t hits{0};
+    std::size_t misses{0};
+    std::size_t evictions{0};
+    std::size_t entries{0};
+    std::size_t bytes{0};
+  };
+
+  static constexpr std::size_t kDefaultBudget = std::size_t(256) << 20; // 256 MB
+
+  explicit ShapeCache(std::size_t budgetBytes = kDefaultBudget)
+    : m_budget(budgetBytes)
+  {
+  }
+
+  // Lookup; a hit refreshes the entry's LRU position
+  bool find(Key key, TopoDS_Shape& out);
+  // Insert or replace; evicts least recently used entries beyond the budget
+  void insert(Key key, const TopoDS_Shape& shape);
+
+  void        setBudget(std::size_t bytes);
+  std::size_t budget() const;
+
+  void  clear();
+  Stats stats() const;
+  void  resetCounters();
+
+  // Rough in-memory size of a shape used for budgeting
+  static std::size_t estimateBytes(const TopoDS_Shape& shape);
+
+private:
+  struct Entry
+  {
+    Key          key;
+    TopoDS_Shape shape;
+    std::size_t  bytes;
+  };
+
+  void evictOverBudget(); // caller holds m_mutex
+
+  mutable std::mutex                                     m_mutex;
+  std::list<Entry>                                       m_lru; // front = most recently used
+  std::unordered_map<Key, std::list<Entry>::iterator>    m_index;
+  std::size_t                                            m_budget;
+  Stats                                                  m_stats;
+};
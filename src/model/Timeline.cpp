@@ -0,0 +1,168 @@
+#include "Timeline.h"
+
+#include <algorithm>
+
+void Timeline::append(const Handle(DocumentItem)& item)
+{
+  if (item.IsNull()) return;
+  const std::uint64_t order = (m_order.empty() ? 0 : m_order.back()) + kOrderGap;
+  m_items.push_back(item);
+  m_order.push_back(order);
+  KindIndex& k = m_byKind[item->kind()];
+  k.orders.push_back(order);
+  k.items.push_back(item);
+  track(item);
+  // Keep the index current when it already covers everything before the new slot
+  if (m_indexedUpTo + 1 == m_items.size())
+  {
+    m_pos[item->id()] = m_items.size() - 1;
+    m_indexedUpTo = m_items.size();
+  }
+}
+
+void Timeline::insert(int index1, const Handle(DocumentItem)& item)
+{
+  if (item.IsNull()) return;
+  const std::size_t at = static_cast<std::size_t>(std::clamp(index1, 1, Size() + 1) - 1);
+  if (at == m_items.size())
+  {
+    append(item);
+    return;
+  }
+  const std::uint64_t order = orderBefore(at);
+  m_items.insert(m_items.begin() + static_cast<std::ptrdiff_t>(at), item);
+  m_order.insert(m_order.begin() + static_cast<std::ptrdiff_t>(at), order);
+  KindIndex& k = m_byKind[item->kind()];
+  const auto slot = std::lower_bound(k.orders.begin(), k.orders.end(), order) - k.orders.begin();
+  k.orders.insert(k.orders.begin() + slot, order);
+  k.items.insert(k.items.begin() + slot, item);
+  track(item);
+  m_indexedUpTo = std::min(m_indexedUpTo, at);
+}
+
+void Timeline::removeAt(int index1)
+{
+  if (index1 < 1 || index1 > Size()) return;
+  const std::size_t at = static_cast<std::size_t>(index1 - 1);
+  const Handle(DocumentItem) item = m_items[at];
+  const std::uint64_t order = m_order[at];
+  m_items.erase(m_items.begin() + static_cast<std::ptrdiff_t>(at));
+  m_order.erase(m_order.begin() + static_cast<std::ptrdiff_t>(at));
+  auto kit = m_byKind.find(item->kind());
+  if (kit != m_byKind.end())
+  {
+    KindIndex& k = kit->second;
+    const auto slot = std::lower_bound(k.orders.begin(), k.orders.end(), order) - k.orders.begin();
+    if (slot < static_cast<std::ptrdiff_t>(k.orders.size()) && k.orders[slot] == order)
+    {
+      k.orders.erase(k.orders.begin() + slot);
+      k.items.erase(k.items.begin() + slot);
+    }
+  }
+  m_indexedUpTo = std::min(m_indexedUpTo, at);
+  auto bit = m_byId.find(item->id());
+  if (bit == m_byId.end()) return;
+  if (--bit->second.count == 0)
+  {
+    m_byId.erase(bit);
+    m_pos.erase(item->id());
+    return;
+  }
+  // Repeated id (rare): point the map at the latest remaining occurrence
+  if (bit->second.item == item)
+  {
+    for (std::size_t i = m_items.size(); i-- > 0;)
+    {
+      if (m_items[i]->id() == item->id())
+      {
+        bit->second.item = m_items[i];
+        m_indexedUpTo = std::min(m_indexedUpTo, i);
+        break;
+      }
+    }
+  }
+}
+
+void Timeline::track(const Handle(DocumentItem)& item)
+{
+  auto res = m_byId.try_emplace(item->id(), Slot{item, 0});
+  res.first->second.item = item;
+  ++res.first->second.count;
+}
+
+std::uint64_t Timeline::orderBefore(std::size_t at)
+{
+  const std::uint64_t hi = m_order[at];
+  std::uint64_t lo = at == 0 ? 0 : m_order[at - 1];
+  if (hi - lo < 2)
+  {
+    renumber();
+    return at == 0 ? kOrderGap / 2 : m_order[at - 1] + kOrderGap / 2;
+  }
+  return lo + (hi - lo) / 2;
+}
+
+void Timeline::renumber()
+{
+  for (std::size_t i = 0; i < m_order.size(); ++i) m_order[i] = (i + 1) * kOrderGap;
+  // Kind lists hold the same items in the same relative order; refresh their keys
+  for (auto& kv : m_byKind)
+  {
+    kv.second.orders.clear();
+    kv.second.items.clear();
+  }
+  for (std::size_t i = 0; i < m_items.size(); ++i)
+  {
+    KindIndex& k = m_byKind[m_items[i]->kind()];
+    k.orders.push_back(m_order[i]);
+    k.items.push_back(m_items[i]);
+  }
+}
+
+const std::vector<Handle(DocumentItem)>& Timeline::ofKind(Kind kind) const
+{
+  static const std::vector<Handle(DocumentItem)> kEmpty;
+  auto it = m_byKind.find(kind);
+  return it == m_byKind.end() ? kEmpty : it->second.items;
+}
+
+void Timeline::clear()
+{
+  m_items.clear();
+  m_order.clear();
+  m_byKind.clear();
+  m_byId.clear();
+  m_pos.clear();
+  m_indexedUpTo = 0;
+}
+
+Handle(DocumentItem) Timeline::find(Id id) const
+{
+  auto it = m_byId.find(id);
+  return it == m_byId.end() ? Handle(DocumentItem)() : it->second.item;
+}
+
+int Timeline::indexOf(Id id) const
+{
+  auto bit = m_byId.find(id);
+  if (bit == m_byId.end()) return 0;
+  auto pit = m_pos.find(id);
+  if (pit == m_pos.end() || pit->second >= m_indexedUpTo || m_items[pit->second] != bit->second.item)
+  {
+    reindex();
+    pit = m_pos.find(id);
+  }
+  return static_cast<int>(pit->second) + 1;
+}
+
+void Timeline::reindex() const
+{
+  for (std::size_t i = m_indexedUpTo; i < m_items.size(); ++i)
+  {
+    const Handle(DocumentItem)& item = m_items[i];
+    // Only the item the id map points at owns the position of a repeated id
+    auto bit = m_byId.find(item->id());
+    if (bit != m_byId.end() && bit->second.item == item) m_pos[item->id()] = i;
+  }
+  m_indexedUpTo = m_items.size();
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <DocumentItem.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Ordered document history backed by a contiguous array plus id indexes
+// - Read API mirrors NCollection_Sequence (1-based Value/Size/First/Last, Iterator) and supports range-for
+// - find/contains are O(1) through an id -> item map
+// - indexOf is O(1) amortized: positions are reindexed lazily from the first edited slot
+// - ofKind keeps one list per DocumentItem::Kind in history order, updated on every edit
+//   (items carry monotone order keys, so inserts find their slot by binary search)
+class Timeline
+{
+public:
+  using Id = DocumentItem::Id;
+  using Kind = DocumentItem::Kind;
+  using const_iterator = std::vector<Handle(DocumentItem)>::const_iterator;
+
+  // Sequence-style iteration: for (Timeline::Iterator it(t); it.More(); it.Next())
+  class Iterator
+  {
+  public:
+    explicit Iterator(const Timeline& t) : m_it(t.m_items.begin()), m_end(t.m_items.end()) {}
+    bool                        More() const { return m_it != m_end; }
+    void                        Next() { ++m_it; }
+    const Handle(DocumentItem)& Value() const { return *m_it; }
+
+  private:
+    const_iterator m_it;
+    const_iterator m_end;
+  };
+
+  int                         Size() const { return static_cast<int>(m_items.size()); }
+  bool                        IsEmpty() const { return m_items.empty(); }
+  const Handle(DocumentItem)& Value(int index1) const { return m_items[static_cast<std::size_t>(index1 - 1)]; }
+  const Handle(DocumentItem)& First() const { return m_items.front(); }
+  const Handle(DocumentItem)& Last() const { return m_items.back(); }
+  const_iterator              begin() const { return m_items.begin(); }
+  const_iterator              end() const { return m_items.end(); }
+
+  void append(const Handle(DocumentItem)& item);
+  void insert(int index1, const Handle(DocumentItem)& item); // before 1-based index, clamped
+  void removeAt(int index1);
+  void removeLast() { if (!m_items.empty()) removeAt(Size()); }
+  void clear();
+  void reserve(std::size_t n)
+  {
+    m_items.reserve(n);
+    m_order.reserve(n);
+    m_byId.reserve(n);
+  }
+
+  // Id lookups (when ids repeat, the most recently added item wins)
+  Handle(DocumentItem) find(Id id) const;
+  bool                 contains(Id id) const { return m_byId.find(id) != m_byId.end(); }
+  int                  indexOf(Id id) const; // 1-based, 0 when absent
+
+  // Items of one kind in history order (empty list for kinds never added)
+  const std::vector<Handle(DocumentItem)>& ofKind(Kind kind) const;
+
+private:
+  struct KindIndex
+  {
+    std::vector<std::uint64_t>        orders; // ascending, parallel to items
+    std::vector<Handle(DocumentItem)> items;
+  };
+  struct KindHash
+  {
+    std::size_t operator()(Kind k) const noexcept { return static_cast<std::size_t>(k); }
+  };
+
+  static constexpr std::uint64_t kOrderGap = std::uint64_t(1) << 20;
+
+  std::uint64_t orderBefore(std::size_t at); // key for a new slot at 0-based position
+  void          renumber();                  // respace order keys when a gap is exhausted
+
+  void track(const Handle(DocumentItem)& item);
+  void reindex() const;
+
+  std::vector<Handle(DocumentItem)>                  m_items;
+  std::vector<std::uint64_t>                         m_order; // parallel to m_items, ascending
+  std::unordered_map<Kind, KindIndex, KindHash>      m_byKind;
+  struct Slot
+  {
+    Handle(DocumentItem) item;  // most recently added item with this id
+    int                  count; // occurrences of the id in the history
+  };
+
+  std::unordered_map<Id, Slot>                       m_byId;
+  mutable std::unordered_map<Id, std::size_t>        m_pos;          // 0-based, valid below m_indexedUpTo
+  mutable std::size_t                                m_indexedUpTo{0};
+};
@@ -0,0 +1,179 @@
+#include "UndoJournal.h"
+#include "ShapeCache.h"
+
+#include <Sketch.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+std::size_t valueBytes(const Feature::ParamValue& v)
+{
+  if (const auto* s = std::get_if<TCollection_AsciiString>(&v)) return static_cast<std::size_t>(s->Length()) + 1;
+  return 0;
+}
+
+std::size_t valueBytes(const std::optional<Feature::ParamValue>& v)
+{
+  return v ? valueBytes(*v) : 0;
+}
+
+// Parked item state from element counts: serializing a large sketch on every insert would cost
+// more than the edit itself. A deferred payload stays with its source and is not counted.
+std::size_t itemBytes(const DocumentItem& item)
+{
+  if (!item.isLoaded()) return 0;
+  if (const auto* f = dynamic_cast<const Feature*>(&item))
+  {
+    std::size_t bytes = static_cast<std::size_t>(f->name().Length());
+    for (const auto& [key, value] : f->params()) bytes += sizeof(key) + sizeof(value) + valueBytes(value);
+    return bytes;
+  }
+  if (const auto* sk = dynamic_cast<const Sketch*>(&item))
+  {
+    return sk->curves().size() * sizeof(Sketch::Curve) + sk->points().size() * sizeof(gp_Pnt2d) +
+           sk->constraints().size() * sizeof(Sketch::Constraint);
+  }
+  return 0;
+}
+}
+
+std::size_t UndoJournal::estimateBytes(const Command& c)
+{
+  std::size_t bytes = sizeof(Command) + valueBytes(c.before) + valueBytes(c.after);
+  // Structural commands keep the item alive: count its state and, for removals, the result it
+  // still holds (counted even if the result cache shares it)
+  if ((c.type == Command::Type::Insert || c.type == Command::Type::Remove) && !c.item.IsNull())
+  {
+    bytes += itemBytes(*c.item);
+    if (c.type == Command::Type::Remove)
+      if (const auto* f = dynamic_cast<const Feature*>(c.item.get())) bytes += ShapeCache::estimateBytes(f->currentShape());
+  }
+  return bytes;
+}
+
+void UndoJournal::record(Command c)
+{
+  if (!m_enabled) return;
+  for (const Command& r : m_redo) m_bytes -= r.bytes;
+  m_redo.clear();
+
+  bool sameFeature = false;
+  if (c.type == Command::Type::Param && m_groupOpen && m_runStart < m_undo.size())
+  {
+    // The open run: parameter edits of one feature since the last step or group boundary
+    for (std::size_t i = m_undo.size(); i-- > m_runStart;)
+    {
+      Command& r = m_undo[i];
+      if (r.key == c.key && r.item == c.item)
+      {
+        // Same parameter edited again: keep the original value, take the newest one
+        m_bytes -= r.bytes;
+        r.after = std::move(c.after);
+        r.bytes = estimateBytes(r);
+        m_bytes += r.bytes;
+        return;
+      }
+    }
+    // Another parameter of the same feature (e.g. the three of MoveFeature::setTranslation)
+    sameFeature = m_undo.back().item == c.item;
+  }
+  if (!sameFeature) m_runStart = m_undo.size();
+  m_groupOpen = (c.type == Command::Type::Param);
+  c.chained = (m_groupDepth > 0 && m_groupCount > 0) || sameFeature;
+  if (m_groupDepth > 0) ++m_groupCount;
+  c.bytes = estimateBytes(c);
+  m_bytes += c.bytes;
+  m_undo.push_back(std::move(c));
+  trimToBudget();
+}
+
+UndoJournal::Command UndoJournal::takeUndo()
+{
+  Command c = std::move(m_undo.back());
+  m_undo.pop_back();
+  m_bytes -= c.bytes;
+  m_groupOpen = false;
+  return c;
+}
+
+UndoJournal::Command UndoJournal::takeRedo()
+{
+  Command c = std::move(m_redo.back());
+  m_redo.pop_back();
+  m_bytes -= c.bytes;
+  return c;
+}
+
+void UndoJournal::pushUndo(Command c)
+{
+  m_bytes += c.bytes;
+  m_undo.push_back(std::move(c));
+  m_groupOpen = false;
+  trimToBudget();
+}
+
+void UndoJournal::pushRedo(Command c)
+{
+  m_bytes += c.bytes;
+  m_redo.push_back(std::move(c));
+}
+
+void UndoJournal::beginGroup()
+{
+  if (m_groupDepth++ == 0) m_groupCount = 0;
+  m_groupOpen = false;
+}
+
+void UndoJournal::endGroup()
+{
+  if (m_groupDepth > 0 && --m_groupDepth == 0)
+  {
+    m_groupCount = 0;
+    trimToBudget();
+  }
+  m_groupOpen = false;
+}
+
+UndoJournal::Command UndoJournal::popGroupCommand()
+{
+  Command c = std::move(m_undo.back());
+  m_undo.pop_back();
+  m_bytes -= c.bytes;
+  --m_groupCount;
+  m_groupOpen = false;
+  return c;
+}
+
+void UndoJournal::setBudget(std::size_t bytes)
+{
+  m_budget = bytes;
+  trimToBudget();
+}
+
+void UndoJournal::clear()
+{
+  m_undo.clear();
+  m_redo.clear();
+  m_bytes = 0;
+  m_groupOpen = false;
+  m_groupCount = 0;
+  m_runStart = 0;
+}
+
+void UndoJournal::trimToBudget()
+{
+  // Oldest steps go first (whole groups); the newest step and an open group always stay
+  std::size_t newest = m_undo.empty() ? 0 : 1;
+  while (newest < m_undo.size() && m_undo[m_undo.size() - newest].chained) ++newest;
+  const std::size_t keep = std::max(m_groupCount, newest);
+  while (m_bytes > m_budget && m_undo.size() > keep)
+  {
+    do
+    {
+      m_bytes -= m_undo.front().bytes;
+      m_undo.pop_front();
+      if (m_runStart > 0) --m_runStart;
+    } while (m_undo.size() > keep && m_undo.front().chained);
+  }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "Feature.h"
+
+#include <DocumentItem.h>
+
+#include <cstddef>
+#include <deque>
+#include <optional>
+#include <vector>
+
+// Undo/redo history of Document edits stored as deltas, not document snapshots
+// - Commands: timeline insert/remove, one parameter change, suppression toggle
+// - Consecutive parameter changes of the same feature form one undo step until closeGroup() (e.g.
+//   at the end of a slider drag); repeated changes of one parameter coalesce into one command
+// - Groups (Document transactions): commands recorded between beginGroup()/endGroup() form one
+//   undo step
+// - Memory cap: the oldest undo steps are dropped once the estimated size exceeds the budget
+// - Applying commands is Document's job (Document::undo()/redo()); the journal only stores them
+class UndoJournal
+{
+public:
+  struct Command
+  {
+    enum class Type
+    {
+      Insert,   // item added at index1
+      Remove,   // item removed from index1
+      Param,    // params()[key]: before -> after (nullopt = key not set)
+      Suppress, // suppression flag: suppressedBefore -> suppressedAfter
+    };
+
+    Type                              type{Type::Param};
+    Handle(DocumentItem)              item;
+    int                               index1{0};
+    Feature::ParamKey                 key{};
+    std::optional<Feature::ParamValue> before;
+    std::optional<Feature::ParamValue> after;
+    bool                              suppressedBefore{false};
+    bool                              suppressedAfter{false};
+    bool                              chained{false}; // undone/redone together with the previous command
+    std::size_t                       bytes{0}; // estimate, filled by record()
+  };
+
+  static constexpr std::size_t kDefaultBudget = std::size_t(16) << 20; // 16 MB
+
+  explicit UndoJournal(std::size_t budgetBytes = kDefaultBudget)
+    : m_budget(budgetBytes)
+  {
+  }
+
+  // Recording: a new command clears the redo branch
+  void record(Command c);
+  void closeGroup() { m_groupOpen = false; } // next Param command starts a new step
+
+  // Nested groups: everything recorded until the outermost endGroup() is one undo step
+  void        beginGroup();
+  void        endGroup();
+  std::size_t groupSize() const { return m_groupCount; } // commands recorded in the open group
+  Command     popGroupCommand();                         // newest command of the open group, not redoable
+
+  // Disabled journals ignore record(); Document disables recording while it applies commands
+  void setEnabled(bool on) { m_enabled = on; }
+  bool enabled() const { return m_enabled; }
+
+  bool canUndo() const { return !m_undo.empty(); }
+  bool canRedo() const { return !m_redo.empty(); }
+  bool nextRedoChained() const { return !m_redo.empty() && m_redo.back().chained; }
+  std::size_t undoCount() const { return m_undo.size(); }
+  std::size_t redoCount() const { return m_redo.size(); }
+
+  // Move the newest command between the stacks; the caller applies it
+  Command takeUndo();
+  Command takeRedo();
+  void    pushUndo(Command c); // after redo(): keeps the redo branch
+  void    pushRedo(Command c);
+
+  void        setBudget(std::size_t bytes);
+  std::size_t budget() const { return m_budget; }
+  std::size_t bytes() const { return m_bytes; }
+  void        clear();
+
+  // Estimated footprint of one command (strings, state of inserted/removed items, removed results)
+  static std::size_t estimateBytes(const Command& c);
+
+private:
+  void trimToBudget();
+
+  std::deque<Command>  m_undo; // back = newest
+  std::vector<Command> m_redo; // back = next to redo
+  std::size_t          m_budget;
+  std::size_t          m_bytes{0};
+  bool                 m_enabled{true};
+  bool                 m_groupOpen{false};  // Param coalescing allowed
+  std::size_t          m_runStart{0};       // first command of the open Param run (m_undo index)
+  int                  m_groupDepth{0};
+  std::size_t          m_groupCount{0};
+};
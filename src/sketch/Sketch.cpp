@@ -1,17 +1,23 @@
 #include "Sketch.h"
 #include <DocumentItem.h>
-#include <sstream>
+#include <ContentHash.h>
+#include <FieldText.h>
 
 IMPLEMENT_STANDARD_RTTIEXT(Sketch, DocumentItem)
 
 namespace {
 const bool kSketchReg = [](){
-  DocumentItem::registerFactory(DocumentItem::Kind::Sketch, [](){ return std::shared_ptr<DocumentItem>(new Sketch()); });
+  DocumentItem::registerFactory(DocumentItem::Kind::Sketch, [](DocumentItem::PersistedId id) -> DocumentItem* { return new Sketch(id.value); });
   return true;
 }();
 }
 
+#include <cctype>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
 #include <deque>
 #include <unordered_set>
 #include <algorithm>
@@ -153,15 +159,19 @@ inline bool samePoint(const gp_Pnt2d& a, const gp_Pnt2d& b, double tol)
 
 Sketch::CurveId Sketch::addLine(const gp_Pnt2d& a, const gp_Pnt2d& b)
 {
+  ensureLoaded();
   Curve c;
   c.type = CurveType::Line;
   c.line = Line{a, b};
   curves_.push_back(c);
+  markDirty();
   return static_cast<CurveId>(curves_.size() - 1);
 }
 
 Sketch::CurveId Sketch::addLineAuto(const gp_Pnt2d& aIn, const gp_Pnt2d& bIn, double tol)
 {
+  ensureLoaded();
+  markDirty(); // may split existing curves in place
   auto sqr = [](double v){ return v*v; };
   auto dist2 = [&](const gp_Pnt2d& p, const gp_Pnt2d& q) {
     return sqr(p.X() - q.X()) + sqr(p.Y() - q.Y());
@@ -394,26 +404,33 @@ Sketch::CurveId Sketch::addLineAuto(const gp_Pnt2d& aIn, const gp_Pnt2d& bIn, do
 
 Sketch::CurveId Sketch::addArc(const gp_Pnt2d& center, const gp_Pnt2d& a, const gp_Pnt2d& b, bool clockwise)
 {
+  ensureLoaded();
   Curve c;
   c.type = CurveType::Arc;
   c.arc = Arc{center, a, b, clockwise};
   curves_.push_back(c);
+  markDirty();
   return static_cast<CurveId>(curves_.size() - 1);
 }
 
 int Sketch::addPoint(const gp_Pnt2d& p)
 {
+  ensureLoaded();
   points_.push_back(p);
+  markDirty();
   return static_cast<int>(points_.size() - 1);
 }
 
 void Sketch::addCoincident(const EndpointRef& a, const EndpointRef& b)
 {
+  ensureLoaded();
   constraints_.push_back(Constraint{ConstraintType::Coincident, a, b});
+  markDirty();
 }
 
 void Sketch::solveConstraints(double tol)
 {
+  ensureLoaded();
   // Initialize union-find for all endpoints
   const std::size_t epCount = curves_.size() * 2;
   ufInit(epCount);
@@ -510,6 +527,7 @@ void Sketch::solveConstraints(double tol)
 
 std::vector<Sketch::Wire> Sketch::computeWires(double tol) const
 {
+  ensureLoaded();
   // Build adjacency graph among curves via endpoint coincidence
   const std::size_t n = curves_.size();
   std::vector<std::vector<int>> adj(n);
@@ -614,6 +632,7 @@ std::vector<Sketch::Wire> Sketch::computeWires(double tol) const
 
 std::vector<Sketch::OrderedPath> Sketch::computeOrderedPaths(double tol) const
 {
+  ensureLoaded();
   // Establish unions consistently, then build wires and cluster references using that UF state.
   const std::size_t n = curves_.size();
 
@@ -740,6 +759,7 @@ std::vector<Sketch::OrderedPath> Sketch::computeOrderedPaths(double tol) const
 
 std::vector<TopoDS_Wire> Sketch::toOcctWires(double tol) const
 {
+  ensureLoaded();
   auto paths = computeOrderedPaths(tol);
   std::vector<TopoDS_Wire> wires;
   wires.reserve(paths.size());
@@ -821,144 +841,439 @@ std::vector<TopoDS_Wire> Sketch::toOcctWires(double tol) const
   return wires;
 }
 
-// Serialization format (line-based):
+// Binary encoding (default), native byte order (little-endian on every supported platform):
+//   header      104 bytes  "VSKB", u32 version, u32 curve count, u32 point count, u32 constraint count,
+//                          u32 reserved, u64 planeId, f64 x9 plane (origin, normal, x direction)
+//   curve tags  u8 per curve (0 line, 1 arc, 2 clockwise arc), padded to 8 bytes
+//   coordinates f64: x1 y1 x2 y2 per line, cx cy x1 y1 x2 y2 per arc, in curve order
+//   points      f64 x y per point
+//   constraints i32 type, aCurve, aEnd, bCurve, bEnd
+//
+// Text encoding (line-based, exact shortest-form numbers):
 // curves N
 //  L x1 y1 x2 y2
 //  A cx cy x1 y1 x2 y2 cw(0|1)
+// points P
+//  P x y
 // constraints M
 //  C aCurve aEnd bCurve bEnd
 // plane ox oy oz zx zy zz xx xy xz
 // planeId <id>        (optional)
-std::string Sketch::serialize() const
+namespace {
+constexpr char          kBinaryMagic[4] = {'V', 'S', 'K', 'B'};
+constexpr std::uint32_t kBinaryVersion = 1;
+constexpr std::size_t   kBinaryHeaderBytes = 104;
+constexpr std::size_t   kConstraintBytes = 5 * sizeof(std::int32_t);
+
+enum CurveTag : std::uint8_t
+{
+  kTagLine = 0,
+  kTagArc = 1,
+  kTagArcClockwise = 2,
+};
+
+template <class T>
+char* put(char* p, T v)
+{
+  std::memcpy(p, &v, sizeof(T));
+  return p + sizeof(T);
+}
+
+template <class T>
+const char* take(const char* p, T& v)
 {
-  std::ostringstream os;
-  os << "curves " << curves_.size() << "\n";
+  std::memcpy(&v, p, sizeof(T));
+  return p + sizeof(T);
+}
+
+char* putPnt(char* p, const gp_Pnt2d& pt) { return put(put(p, pt.X()), pt.Y()); }
+
+const char* takePnt(const char* p, gp_Pnt2d& pt)
+{
+  double xy[2];
+  std::memcpy(xy, p, sizeof(xy));
+  pt.SetCoord(xy[0], xy[1]);
+  return p + sizeof(xy);
+}
+
+std::size_t paddedTags(std::size_t curves) { return (curves + 7) & ~static_cast<std::size_t>(7); }
+
+// Whitespace-separated tokens of a text blob, parsed in place
+class Tokens
+{
+public:
+  explicit Tokens(std::string_view s) : m_s(s) {}
+
+  bool next(std::string_view& t)
+  {
+    while (m_pos < m_s.size() && std::isspace(static_cast<unsigned char>(m_s[m_pos]))) ++m_pos;
+    if (m_pos == m_s.size()) return false;
+    const std::size_t start = m_pos;
+    while (m_pos < m_s.size() && !std::isspace(static_cast<unsigned char>(m_s[m_pos]))) ++m_pos;
+    t = m_s.substr(start, m_pos - start);
+    return true;
+  }
+
+  bool number(double& v)
+  {
+    std::string_view t;
+    return next(t) && FieldText::parseNumber(t, v);
+  }
+
+  template <class Int>
+  bool integer(Int& v)
+  {
+    std::string_view t;
+    return next(t) && FieldText::parseInteger(t, v);
+  }
+
+  bool point(gp_Pnt2d& p)
+  {
+    double x = 0.0, y = 0.0;
+    if (!number(x) || !number(y)) return false;
+    p.SetCoord(x, y);
+    return true;
+  }
+
+  void skipLine()
+  {
+    const std::size_t eol = m_s.find('\n', m_pos);
+    m_pos = eol == std::string_view::npos ? m_s.size() : eol + 1;
+  }
+
+  // Upper bound for a count read from the blob, so a corrupt count cannot reserve unbounded memory
+  std::size_t remaining() const { return m_s.size() - m_pos; }
+
+private:
+  std::string_view m_s;
+  std::size_t      m_pos{0};
+};
+}
+
+std::string Sketch::serialize(Encoding encoding) const
+{
+  ensureLoaded();
+  return encoding == Encoding::Binary ? serializeBinary() : serializeText();
+}
+
+std::string Sketch::serializeBinary() const
+{
+  std::size_t arcs = 0;
+  for (const auto& c : curves_) arcs += c.type == CurveType::Arc ? 1 : 0;
+  const std::size_t lines = curves_.size() - arcs;
+  std::string out(kBinaryHeaderBytes + paddedTags(curves_.size())
+                      + sizeof(double) * (4 * lines + 6 * arcs + 2 * points_.size())
+                      + kConstraintBytes * constraints_.size(),
+                  '\0');
+
+  char* p = out.data();
+  std::memcpy(p, kBinaryMagic, sizeof(kBinaryMagic));
+  p = put(p + sizeof(kBinaryMagic), kBinaryVersion);
+  p = put(p, static_cast<std::uint32_t>(curves_.size()));
+  p = put(p, static_cast<std::uint32_t>(points_.size()));
+  p = put(p, static_cast<std::uint32_t>(constraints_.size()));
+  p = put(p, std::uint32_t{0});
+  p = put(p, static_cast<std::uint64_t>(m_planeId));
+  const gp_Pnt loc = m_ax2.Location();
+  const gp_Dir Z   = m_ax2.Direction();
+  const gp_Dir X   = m_ax2.XDirection();
+  for (double v : {loc.X(), loc.Y(), loc.Z(), Z.X(), Z.Y(), Z.Z(), X.X(), X.Y(), X.Z()}) p = put(p, v);
+
+  for (const auto& c : curves_)
+  {
+    *p++ = static_cast<char>(c.type == CurveType::Line ? kTagLine : c.arc.clockwise ? kTagArcClockwise : kTagArc);
+  }
+  p += paddedTags(curves_.size()) - curves_.size();
+  for (const auto& c : curves_)
+  {
+    if (c.type == CurveType::Line) p = putPnt(putPnt(p, c.line.p1), c.line.p2);
+    else p = putPnt(putPnt(putPnt(p, c.arc.center), c.arc.p1), c.arc.p2);
+  }
+  for (const auto& pt : points_) p = putPnt(p, pt);
+  for (const auto& k : constraints_)
+  {
+    for (int v : {static_cast<int>(k.type), k.a.curve, k.a.endIndex, k.b.curve, k.b.endIndex})
+    {
+      p = put(p, static_cast<std::int32_t>(v));
+    }
+  }
+  return out;
+}
+
+std::string Sketch::serializeText() const
+{
+  std::string out;
+  out.reserve(64 + 96 * curves_.size() + 40 * points_.size() + 24 * constraints_.size() + 200);
+  auto num = [&out](double v) {
+    out += ' ';
+    FieldText::appendNumber(out, v);
+  };
+  auto pnt = [&num](const gp_Pnt2d& p) {
+    num(p.X());
+    num(p.Y());
+  };
+
+  out += "curves ";
+  FieldText::appendInteger(out, curves_.size());
+  out += '\n';
   for (const auto& c : curves_)
   {
     if (c.type == CurveType::Line)
     {
-      os << "L " << c.line.p1.X() << ' ' << c.line.p1.Y() << ' '
-         << c.line.p2.X() << ' ' << c.line.p2.Y() << "\n";
+      out += 'L';
+      pnt(c.line.p1);
+      pnt(c.line.p2);
     }
     else
     {
-      os << "A " << c.arc.center.X() << ' ' << c.arc.center.Y() << ' '
-         << c.arc.p1.X() << ' ' << c.arc.p1.Y() << ' '
-         << c.arc.p2.X() << ' ' << c.arc.p2.Y() << ' '
-         << (c.arc.clockwise ? 1 : 0) << "\n";
+      out += 'A';
+      pnt(c.arc.center);
+      pnt(c.arc.p1);
+      pnt(c.arc.p2);
+      out += c.arc.clockwise ? " 1" : " 0";
     }
+    out += '\n';
   }
   // Points block
-  os << "points " << points_.size() << "\n";
+  out += "points ";
+  FieldText::appendInteger(out, points_.size());
+  out += '\n';
   for (const auto& p : points_)
   {
-    os << "P " << p.X() << ' ' << p.Y() << "\n";
+    out += 'P';
+    pnt(p);
+    out += '\n';
   }
-  os << "constraints " << constraints_.size() << "\n";
+  out += "constraints ";
+  FieldText::appendInteger(out, constraints_.size());
+  out += '\n';
   for (const auto& k : constraints_)
   {
-    if (k.type == ConstraintType::Coincident)
+    if (k.type != ConstraintType::Coincident) continue;
+    out += 'C';
+    for (int v : {k.a.curve, k.a.endIndex, k.b.curve, k.b.endIndex})
     {
-      os << "C " << k.a.curve << ' ' << k.a.endIndex << ' ' << k.b.curve << ' ' << k.b.endIndex << "\n";
+      out += ' ';
+      FieldText::appendInteger(out, v);
     }
+    out += '\n';
   }
   // Plane binding
   const gp_Pnt loc = m_ax2.Location();
   const gp_Dir Z   = m_ax2.Direction();
   const gp_Dir X   = m_ax2.XDirection();
-  os << "plane "
-     << loc.X() << ' ' << loc.Y() << ' ' << loc.Z() << ' '
-     << Z.X()   << ' ' << Z.Y()   << ' ' << Z.Z()   << ' '
-     << X.X()   << ' ' << X.Y()   << ' ' << X.Z()   << "\n";
+  out += "plane";
+  for (double v : {loc.X(), loc.Y(), loc.Z(), Z.X(), Z.Y(), Z.Z(), X.X(), X.Y(), X.Z()}) num(v);
+  out += '\n';
   if (m_planeId != 0)
   {
-    os << "planeId " << m_planeId << "\n";
+    out += "planeId ";
+    FieldText::appendInteger(out, m_planeId);
+    out += '\n';
+  }
+  return out;
+}
+
+std::uint64_t Sketch::contentHash() const
+{
+  ensureLoaded();
+  ContentHash h;
+  auto addPnt = [&h](const gp_Pnt2d& p) { h.add(p.X()).add(p.Y()); };
+  h.add(static_cast<int>(kind())).add(static_cast<std::uint64_t>(curves_.size()));
+  for (const auto& c : curves_)
+  {
+    h.add(static_cast<int>(c.type));
+    if (c.type == CurveType::Line)
+    {
+      addPnt(c.line.p1);
+      addPnt(c.line.p2);
+    }
+    else
+    {
+      addPnt(c.arc.center);
+      addPnt(c.arc.p1);
+      addPnt(c.arc.p2);
+      h.add(c.arc.clockwise);
+    }
+  }
+  h.add(static_cast<std::uint64_t>(points_.size()));
+  for (const auto& p : points_) addPnt(p);
+  h.add(static_cast<std::uint64_t>(constraints_.size()));
+  for (const auto& k : constraints_)
+  {
+    h.add(static_cast<int>(k.type)).add(k.a.curve).add(k.a.endIndex).add(k.b.curve).add(k.b.endIndex);
   }
-  return os.str();
+  const gp_Pnt loc = m_ax2.Location();
+  const gp_Dir Z   = m_ax2.Direction();
+  const gp_Dir X   = m_ax2.XDirection();
+  h.add(loc.X()).add(loc.Y()).add(loc.Z());
+  h.add(Z.X()).add(Z.Y()).add(Z.Z());
+  h.add(X.X()).add(X.Y()).add(X.Z());
+  return h.value();
 }
 
-void Sketch::deserialize(const std::string& data)
+void Sketch::deserialize(std::string_view data)
 {
+  markDirty();
   curves_.clear();
   constraints_.clear();
   points_.clear();
   // Defaults: XY plane at origin
   m_ax2 = gp_Ax2(gp_Pnt(0,0,0), gp::DZ(), gp::DX());
   m_planeId = 0;
-  std::istringstream is(data);
-  std::string head;
+  if (data.size() >= sizeof(kBinaryMagic) && std::memcmp(data.data(), kBinaryMagic, sizeof(kBinaryMagic)) == 0)
+    deserializeBinary(data);
+  else
+    deserializeText(data);
+}
+
+// Sizes are validated up front, then the vectors are sized once and filled from the buffer
+void Sketch::deserializeBinary(std::string_view data)
+{
+  if (data.size() < kBinaryHeaderBytes) throw std::runtime_error("truncated sketch header");
+  std::uint32_t version = 0, nCurves = 0, nPoints = 0, nConstraints = 0, reserved = 0;
+  std::uint64_t planeId = 0;
+  const char* p = take(data.data() + sizeof(kBinaryMagic), version);
+  if (version != kBinaryVersion) throw std::runtime_error("unsupported sketch encoding " + std::to_string(version));
+  p = take(take(take(take(take(p, nCurves), nPoints), nConstraints), reserved), planeId);
+  double plane[9];
+  for (double& v : plane) p = take(p, v);
+
+  const char* const end = data.data() + data.size();
+  if (static_cast<std::size_t>(end - p) < paddedTags(nCurves)) throw std::runtime_error("truncated sketch curves");
+  const char* tags = p;
+  std::size_t arcs = 0;
+  for (std::uint32_t i = 0; i < nCurves; ++i)
+  {
+    const auto tag = static_cast<std::uint8_t>(tags[i]);
+    if (tag > kTagArcClockwise) throw std::runtime_error("unknown sketch curve tag");
+    arcs += tag != kTagLine ? 1 : 0;
+  }
+  p += paddedTags(nCurves);
+  const std::size_t need = sizeof(double) * (4 * (nCurves - arcs) + 6 * arcs + 2 * std::size_t{nPoints})
+                           + kConstraintBytes * nConstraints;
+  if (static_cast<std::size_t>(end - p) < need) throw std::runtime_error("truncated sketch data");
+  const char* const constraints = p + (need - kConstraintBytes * nConstraints);
+  for (std::uint32_t i = 0; i < nConstraints; ++i)
+  {
+    std::int32_t type = 0;
+    std::memcpy(&type, constraints + kConstraintBytes * i, sizeof(type));
+    if (type != static_cast<std::int32_t>(ConstraintType::Coincident)) throw std::runtime_error("unknown sketch constraint type");
+  }
+
+  curves_.resize(nCurves);
+  for (std::uint32_t i = 0; i < nCurves; ++i)
+  {
+    Curve& c = curves_[i];
+    const auto tag = static_cast<std::uint8_t>(tags[i]);
+    if (tag == kTagLine)
+    {
+      c.type = CurveType::Line;
+      p = takePnt(takePnt(p, c.line.p1), c.line.p2);
+    }
+    else
+    {
+      c.type = CurveType::Arc;
+      c.arc.clockwise = tag == kTagArcClockwise;
+      p = takePnt(takePnt(takePnt(p, c.arc.center), c.arc.p1), c.arc.p2);
+    }
+  }
+  points_.resize(nPoints);
+  for (gp_Pnt2d& pt : points_) p = takePnt(p, pt);
+  constraints_.resize(nConstraints);
+  for (Constraint& k : constraints_)
+  {
+    std::int32_t v[5];
+    std::memcpy(v, p, sizeof(v));
+    p += sizeof(v);
+    k.type = static_cast<ConstraintType>(v[0]);
+    k.a = EndpointRef{v[1], v[2]};
+    k.b = EndpointRef{v[3], v[4]};
+  }
+
+  m_ax2 = gp_Ax2(gp_Pnt(plane[0], plane[1], plane[2]), gp_Dir(plane[3], plane[4], plane[5]),
+                 gp_Dir(plane[6], plane[7], plane[8]));
+  m_planeId = static_cast<DocumentItem::Id>(planeId);
+}
+
+void Sketch::deserializeText(std::string_view data)
+{
+  Tokens is(data);
+  std::string_view head;
   std::size_t n = 0;
-  if (is >> head >> n && head == "curves")
+  if (is.next(head) && is.integer(n) && head == "curves")
   {
+    curves_.reserve(std::min(n, is.remaining() / 8));
     for (std::size_t i = 0; i < n; ++i)
     {
-      char typ; is >> typ;
-      if (typ == 'L')
+      std::string_view typ;
+      if (!is.next(typ)) break;
+      Curve c;
+      if (typ == "L")
       {
-        double x1,y1,x2,y2; is >> x1 >> y1 >> x2 >> y2;
-        addLine(gp_Pnt2d(x1,y1), gp_Pnt2d(x2,y2));
+        c.type = CurveType::Line;
+        if (!is.point(c.line.p1) || !is.point(c.line.p2)) break;
       }
-      else if (typ == 'A')
+      else if (typ == "A")
       {
-        double cx,cy,x1,y1,x2,y2; int cw; is >> cx >> cy >> x1 >> y1 >> x2 >> y2 >> cw;
-        addArc(gp_Pnt2d(cx,cy), gp_Pnt2d(x1,y1), gp_Pnt2d(x2,y2), cw != 0);
+        int cw = 0;
+        c.type = CurveType::Arc;
+        if (!is.point(c.arc.center) || !is.point(c.arc.p1) || !is.point(c.arc.p2) || !is.integer(cw)) break;
+        c.arc.clockwise = cw != 0;
       }
+      else continue;
+      curves_.push_back(c);
     }
   }
   // Optionally points block may follow directly after curves
-  if (is >> head >> n && head == "points")
+  if (is.next(head) && is.integer(n) && head == "points")
   {
+    points_.reserve(std::min(n, is.remaining() / 4));
     for (std::size_t i = 0; i < n; ++i)
     {
-      char typ; is >> typ;
-      if (typ == 'P')
-      {
-        double x,y; is >> x >> y;
-        addPoint(gp_Pnt2d(x,y));
-      }
+      std::string_view typ;
+      gp_Pnt2d pt;
+      if (!is.next(typ)) break;
+      if (typ != "P") continue;
+      if (!is.point(pt)) break;
+      points_.push_back(pt);
     }
   }
 
-  if (is >> head >> n && head == "constraints")
+  if (is.next(head) && is.integer(n) && head == "constraints")
   {
+    constraints_.reserve(std::min(n, is.remaining() / 8));
     for (std::size_t i = 0; i < n; ++i)
     {
-      char typ; is >> typ;
-      if (typ == 'C')
-      {
-        int ac, ae, bc, be; is >> ac >> ae >> bc >> be;
-        addCoincident(EndpointRef{ac, ae}, EndpointRef{bc, be});
-      }
+      std::string_view typ;
+      int ac = 0, ae = 0, bc = 0, be = 0;
+      if (!is.next(typ)) break;
+      if (typ != "C") continue;
+      if (!is.integer(ac) || !is.integer(ae) || !is.integer(bc) || !is.integer(be)) break;
+      constraints_.push_back(Constraint{ConstraintType::Coincident, EndpointRef{ac, ae}, EndpointRef{bc, be}});
     }
   }
 
   // Optional trailing sections (order independent after the two blocks)
   // Parse until EOF: recognize "plane" and "planeId" tokens
-  while (is >> head)
+  while (is.next(head))
   {
     if (head == "plane")
     {
-      double ox,oy,oz, zx,zy,zz, xx,xy,xz;
-      if (is >> ox >> oy >> oz >> zx >> zy >> zz >> xx >> xy >> xz)
-      {
-        gp_Pnt o(ox,oy,oz);
-        gp_Dir Z(zx,zy,zz);
-        gp_Dir X(xx,xy,xz);
-        m_ax2 = gp_Ax2(o, Z, X);
-      }
+      double v[9];
+      bool ok = true;
+      for (double& d : v) ok = ok && is.number(d);
+      if (ok) m_ax2 = gp_Ax2(gp_Pnt(v[0], v[1], v[2]), gp_Dir(v[3], v[4], v[5]), gp_Dir(v[6], v[7], v[8]));
     }
     else if (head == "planeId")
     {
-      unsigned long long pid = 0ULL;
-      if (is >> pid)
-      {
-        m_planeId = static_cast<DocumentItem::Id>(pid);
-      }
+      std::uint64_t pid = 0;
+      if (is.integer(pid)) m_planeId = static_cast<DocumentItem::Id>(pid);
     }
     else
     {
       // Unknown token: skip rest of line
-      is.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+      is.skipLine();
     }
   }
 }
@@ -980,6 +1295,7 @@ gp_Pnt2d Sketch::getEndpoint(const EndpointRef& r) const
 void Sketch::setEndpoint(const EndpointRef& r, const gp_Pnt2d& p)
 {
   auto& c = curves_.at(static_cast<std::size_t>(r.curve));
+  markDirty();
   if (c.type == CurveType::Line)
   {
     if (r.endIndex == 0)
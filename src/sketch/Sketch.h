@@ -6,6 +6,8 @@
 
 #include <cstddef>
 #include <optional>
+#include <string>
+#include <string_view>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -91,9 +93,20 @@ public:
   explicit Sketch(DocumentItem::Id existingId) : DocumentItem(existingId) {}
 
   // DocumentItem
-  Kind kind() const override { return Kind::Sketch; }
-  std::string serialize() const override;
-  void        deserialize(const std::string& data) override;
+  static constexpr Kind StaticKind = Kind::Sketch; // for Document::itemsOfKind<T>()
+  Kind kind() const override { return StaticKind; }
+  // Blobs are exact in both encodings: Text (default) is line-based and diffable; Binary is packed
+  // and read straight into the vectors, and binary document files ask for it explicitly.
+  // deserialize() accepts either.
+  enum class Encoding
+  {
+    Binary,
+    Text,
+  };
+  std::string serialize() const override { return serialize(Encoding::Text); }
+  std::string serialize(Encoding encoding) const;
+  void        deserialize(std::string_view data) override;
+  std::uint64_t contentHash() const override; // raw geometry, constraints and plane (full precision)
 
   // Add primitives
   CurveId addLine(const gp_Pnt2d& a, const gp_Pnt2d& b);
@@ -122,16 +135,34 @@ public:
   std::vector<TopoDS_Wire> toOcctWires(double tol = 1.0e-9) const;
 
   // Plane binding
-  void setPlane(const gp_Ax2& ax) { m_ax2 = ax; }
-  const gp_Ax2& plane() const { return m_ax2; }
+  void setPlane(const gp_Ax2& ax)
+  {
+    ensureLoaded();
+    m_ax2 = ax;
+    markDirty();
+  }
+  const gp_Ax2& plane() const
+  {
+    ensureLoaded();
+    return m_ax2;
+  }
 
-  void setPlaneId(DocumentItem::Id pid) { m_planeId = pid; }
-  DocumentItem::Id planeId() const { return m_planeId; }
+  void setPlaneId(DocumentItem::Id pid)
+  {
+    ensureLoaded();
+    m_planeId = pid;
+    markDirty();
+  }
+  DocumentItem::Id planeId() const
+  {
+    ensureLoaded();
+    return m_planeId;
+  }
 
-  // Access
-  const std::vector<Curve>& curves() const { return curves_; }
-  const std::vector<Constraint>& constraints() const { return constraints_; }
-  const std::vector<gp_Pnt2d>& points() const { return points_; }
+  // Access (loads a deferred payload, see DocumentItem::ensureLoaded)
+  const std::vector<Curve>& curves() const { ensureLoaded(); return curves_; }
+  const std::vector<Constraint>& constraints() const { ensureLoaded(); return constraints_; }
+  const std::vector<gp_Pnt2d>& points() const { ensureLoaded(); return points_; }
 
 private:
   // Endpoint index into a flattened list (each curve contributes two endpoints)
@@ -139,6 +170,11 @@ private:
   gp_Pnt2d getEndpoint(const EndpointRef& r) const;
   void setEndpoint(const EndpointRef& r, const gp_Pnt2d& p);
 
+  std::string serializeBinary() const;
+  std::string serializeText() const;
+  void        deserializeBinary(std::string_view data);
+  void        deserializeText(std::string_view data);
+
   // Union-Find for endpoint clustering
   void ufInit(std::size_t n);
   std::size_t ufFind(std::size_t i) const;
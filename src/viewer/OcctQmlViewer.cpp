@@ -148,6 +148,24 @@ void OcctQmlViewer::updateGlInfoFromRenderer(const QString& info)
   emit glInfoChanged();
 }
 
+ShapeMemory::Usage OcctQmlViewer::presentationMemory() const
+{
+  QMutexLocker lock(&m_mutex);
+  return m_presentationMemory;
+}
+
+void OcctQmlViewer::updatePresentationMemoryFromRenderer(const ShapeMemory::Usage& usage)
+{
+  {
+    QMutexLocker lock(&m_mutex);
+    if (m_presentationMemory.topology == usage.topology && m_presentationMemory.geometry == usage.geometry
+        && m_presentationMemory.triangulation == usage.triangulation)
+      return;
+    m_presentationMemory = usage;
+  }
+  emit presentationMemoryChanged();
+}
+
 void OcctQmlViewer::pullInput(bool& rotStart, bool& rotActive, bool& panActive,
                               QPoint& currPos, QPoint& lastPos) const
 {
@@ -322,6 +340,7 @@ void OcctQmlViewer::RendererImpl::synchronize(QQuickFramebufferObject* item)
   v->takePending(m_toAdd, m_doClear, m_doReset, m_resetDistance, m_doFitAll, m_doClickSelect, m_showAxes, m_datum, m_glInfo);                                                                                                       
   // Push GL info gathered on the render thread back to the item for QML binding
   v->updateGlInfoFromRenderer(m_glInfo);
+  v->updatePresentationMemoryFromRenderer(m_bodyMemory.total());
   m_owner = v;
   if (!m_viewCube.IsNull() && m_owner)
   {
@@ -485,6 +504,7 @@ void OcctQmlViewer::RendererImpl::applyPending()
     }
     m_bodies.Clear();
     m_doClear = false;
+    m_bodyMemory.clear();
   }
   // Ensure gizmos follow datum
   if (m_datum)
@@ -502,6 +522,8 @@ void OcctQmlViewer::RendererImpl::applyPending()
     // Draw bodies last among 3D content, consistent with widget viewer
     m_context->SetZLayer(ais, Graphic3d_ZLayerId_Top);
     m_bodies.Append(ais);
+    // Shaded display has meshed the faces by now; data shared with earlier bodies is not counted again
+    m_bodyMemory.add(ais->Shape());
   }
   m_toAdd.clear();
 
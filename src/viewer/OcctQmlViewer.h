@@ -17,6 +17,8 @@
 #include <TopoDS_Shape.hxx>
 #include <NCollection_Sequence.hxx>
 
+#include <ShapeMemory.h>
+
 #include <memory>
 #include <vector>
 
@@ -27,6 +29,7 @@ class OcctQmlViewer : public QQuickFramebufferObject, public AIS_ViewController
 {
   Q_OBJECT
   Q_PROPERTY(QString glInfo READ glInfo NOTIFY glInfoChanged)
+  Q_PROPERTY(qint64 presentationBytes READ presentationBytes NOTIFY presentationMemoryChanged)
 
 public:
   OcctQmlViewer(QQuickItem* parent = nullptr);
@@ -53,10 +56,15 @@ public: // C++ API (non-QML) for adding shapes and datum
 
 public:
   const QString& glInfo() const { return m_glInfo; }
+  // Geometry memory of the displayed bodies (AIS_Shape), including the meshes built for shading;
+  // same accounting as Document::geometryMemory(). Updated by the renderer after bodies change.
+  ShapeMemory::Usage presentationMemory() const;
+  qint64             presentationBytes() const { return qint64(presentationMemory().total()); }
 
 signals:
   void selectionChanged();
   void glInfoChanged();
+  void presentationMemoryChanged();
 
 protected: // input handling (forwarded to AIS_ViewController)
   void keyPressEvent(QKeyEvent* e) override;
@@ -69,6 +77,7 @@ protected: // input handling (forwarded to AIS_ViewController)
 private:
   // Called by the renderer thread via synchronize() to update UI-visible GL info
   void updateGlInfoFromRenderer(const QString& info);
+  void updatePresentationMemoryFromRenderer(const ShapeMemory::Usage& usage);
 
   struct PendingShape
   {
@@ -89,6 +98,7 @@ private:
   bool                      m_axesRequested = false;
   std::shared_ptr<Datum>    m_datum;
   QString                   m_glInfo;
+  ShapeMemory::Usage        m_presentationMemory;
   // Optional helpers
   Handle(AIS_InteractiveObject) m_grid; // FiniteGrid instance
   std::unique_ptr<class SceneGizmos> m_gizmos;
@@ -161,6 +171,9 @@ public: // Renderer implementation
     double                    m_resetDistance = 1.2;
     std::shared_ptr<Datum>    m_datum;
 
+    // Geometry memory of m_bodies, accumulated as each body is displayed and reset with them
+    ShapeMemory m_bodyMemory;
+
     // GL info string (updated after first context bind)
     QString m_glInfo;
     OcctQmlViewer* m_owner = nullptr; // back-ref for event flushing
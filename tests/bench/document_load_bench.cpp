@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include <Document.h>
+#include <DocumentIO.h>
+#include <BoxFeature.h>
+#include <MoveFeature.h>
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+// Opening a 100k-item document (no recompute): binary container vs the text format, and a lazy open
+TEST(DocumentLoadBench, Open100kItems)
+{
+  const int kItems = 100000;
+  Document doc;
+  Handle(Feature) prev;
+  while (doc.items().Size() < kItems)
+  {
+    if (prev.IsNull() || doc.items().Size() % 10 == 0) prev = new BoxFeature(1.0, 2.0, 3.0 + doc.items().Size());
+    else prev = new MoveFeature(prev->id(), 1.0, 0.0, 0.0, 0.0, 0.0, 5.0);
+    doc.addFeature(prev);
+  }
+
+  const std::filesystem::path dir = std::filesystem::temp_directory_path() / "vibecad_document_load_bench";
+  std::filesystem::create_directories(dir);
+  for (DocumentIO::Format format : {DocumentIO::Format::Binary, DocumentIO::Format::Text})
+  {
+    const bool binary = format == DocumentIO::Format::Binary;
+    const std::filesystem::path file = dir / (binary ? "doc.vcad" : "doc.txt");
+    auto t0 = std::chrono::steady_clock::now();
+    ASSERT_TRUE(DocumentIO::save(doc, file, format));
+    const double saveMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    t0 = std::chrono::steady_clock::now();
+    std::unique_ptr<Document> loaded = DocumentIO::load(file);
+    const double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(loaded->items().Size(), doc.items().Size());
+
+    const char* name = binary ? "binary" : "text";
+    std::cout << "[bench] document " << name << " " << kItems << " items: " << std::filesystem::file_size(file)
+              << " bytes, save " << saveMs << " ms, load " << loadMs << " ms\n";
+    RecordProperty(std::string(name) + "_save_ms", std::to_string(saveMs));
+    RecordProperty(std::string(name) + "_load_ms", std::to_string(loadMs));
+    if (!binary) continue;
+
+    // Table of contents only: what a history view pays before touching any payload
+    t0 = std::chrono::steady_clock::now();
+    loaded = DocumentIO::load(file, nullptr, DocumentIO::LoadMode::Lazy);
+    const double lazyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    ASSERT_TRUE(loaded);
+    t0 = std::chrono::steady_clock::now();
+    loaded->loadDeferred();
+    const double deferredMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "[bench] document lazy " << kItems << " items: open " << lazyMs << " ms, load payloads " << deferredMs
+              << " ms\n";
+    RecordProperty("lazy_open_ms", std::to_string(lazyMs));
+    RecordProperty("lazy_payloads_ms", std::to_string(deferredMs));
+  }
+  std::filesystem::remove_all(dir);
+}
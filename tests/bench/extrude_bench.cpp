@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include <KernelAPI.h>
+#include <Sketch.h>
+
+#include <BRepBuilderAPI_MakeFace.hxx>
+#include <BRepPrimAPI_MakePrism.hxx>
+#include <TopoDS_Face.hxx>
+
+#include <common/test_utils.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+double msSince(Clock::time_point t0) { return std::chrono::duration<double, std::milli>(Clock::now() - t0).count(); }
+
+// Previous KernelAPI::extrude: prism per wire folded into the result with pairwise fuses
+TopoDS_Shape pairwiseExtrude(const std::vector<TopoDS_Wire>& wires, const gp_Vec& dir)
+{
+  TopoDS_Shape result;
+  for (const TopoDS_Wire& w : wires)
+  {
+    TopoDS_Face face = BRepBuilderAPI_MakeFace(w);
+    if (face.IsNull()) continue;
+    TopoDS_Shape prism = BRepPrimAPI_MakePrism(face, dir).Shape();
+    result = result.IsNull() ? prism : KernelAPI::fuse(result, prism);
+  }
+  return result;
+}
+
+// Grid of square profiles; every other column overlaps its neighbour so the fuse has real work
+std::vector<TopoDS_Wire> profiles(int n)
+{
+  Sketch sk;
+  const int cols = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(n))));
+  for (int i = 0; i < n; ++i)
+  {
+    const double x = 8.0 * (i % cols) + ((i % cols) % 2 ? -3.0 : 0.0);
+    const double y = 12.0 * (i / cols);
+    sk.addLine(gp_Pnt2d(x, y), gp_Pnt2d(x + 6.0, y));
+    sk.addLine(gp_Pnt2d(x + 6.0, y), gp_Pnt2d(x + 6.0, y + 6.0));
+    sk.addLine(gp_Pnt2d(x + 6.0, y + 6.0), gp_Pnt2d(x, y + 6.0));
+    sk.addLine(gp_Pnt2d(x, y + 6.0), gp_Pnt2d(x, y));
+  }
+  return sk.toOcctWires();
+}
+}
+
+// Multi-profile extrude: one parallel multi-tool fuse vs the previous pairwise fold
+TEST(ExtrudeBench, ProfilesSinglePassVsPairwise)
+{
+  const gp_Vec dir(0.0, 0.0, 5.0);
+  for (int n : {10, 100, 1000})
+  {
+    const std::vector<TopoDS_Wire> wires = profiles(n);
+    auto t0 = Clock::now();
+    const TopoDS_Shape single = KernelAPI::extrude(wires, dir);
+    const double singleMs = msSince(t0);
+    t0 = Clock::now();
+    const TopoDS_Shape pairwise = pairwiseExtrude(wires, dir);
+    const double pairwiseMs = msSince(t0);
+    // Timings of empty results mean nothing: both sides must have built the union
+    ASSERT_FALSE(single.IsNull()) << n << " profiles";
+    ASSERT_FALSE(pairwise.IsNull()) << n << " profiles";
+    ASSERT_GT(volume(pairwise), 0.0) << n << " profiles";
+    EXPECT_NEAR(volume(single), volume(pairwise), 1e-6 * volume(pairwise));
+
+    std::cout << "[bench] extrude " << n << " profiles: single pass " << singleMs << " ms, pairwise " << pairwiseMs
+              << " ms (x" << pairwiseMs / std::max(singleMs, 1e-3) << ")\n";
+    RecordProperty("single_ms_" + std::to_string(n), std::to_string(singleMs));
+    RecordProperty("pairwise_ms_" + std::to_string(n), std::to_string(pairwiseMs));
+  }
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include <Feature.h>
+#include <PlaneFeature.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Live heap bytes, tracked through a size header in front of every allocation of this executable
+namespace {
+std::atomic<long long> g_liveBytes{0};
+constexpr std::size_t  kHeader = alignof(std::max_align_t);
+}
+
+void* operator new(std::size_t n)
+{
+  void* p = std::malloc(n + kHeader);
+  if (!p) throw std::bad_alloc();
+  *static_cast<std::size_t*>(p) = n;
+  g_liveBytes += static_cast<long long>(n);
+  return static_cast<char*>(p) + kHeader;
+}
+
+void operator delete(void* p) noexcept
+{
+  if (!p) return;
+  char* base = static_cast<char*>(p) - kHeader;
+  g_liveBytes -= static_cast<long long>(*reinterpret_cast<std::size_t*>(base));
+  std::free(base);
+}
+
+void operator delete(void* p, std::size_t) noexcept { operator delete(p); }
+
+namespace {
+using Clock    = std::chrono::steady_clock;
+using Key      = Feature::ParamKey;
+using Value    = Feature::ParamValue;
+using HashMap  = std::unordered_map<Key, Value, Feature::ParamKeyHash>; // previous Feature::ParamMap
+
+const Key kPlaneKeys[] = {Key::Ox, Key::Oy, Key::Oz, Key::Nx, Key::Ny, Key::Nz, Key::Size, Key::Transparency};
+
+double asDouble(const Value* v) { return v && std::holds_alternative<double>(*v) ? std::get<double>(*v) : 0.0; }
+
+template <class Map, class MakeFn, class GetFn>
+void measure(const char* label, int n, MakeFn make, GetFn get, double& bytesPer, double& nsPerRead)
+{
+  const long long before = g_liveBytes.load();
+  std::vector<Map> maps;
+  maps.reserve(static_cast<std::size_t>(n));
+  const long long vecBytes = g_liveBytes.load() - before;
+  for (int i = 0; i < n; ++i)
+  {
+    maps.push_back(make());
+    for (Key k : kPlaneKeys) maps.back()[k] = static_cast<double>(i);
+  }
+  bytesPer = static_cast<double>(g_liveBytes.load() - before - vecBytes) / n + sizeof(Map);
+
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<int> pick(0, n - 1);
+  const int reads = 1000000;
+  double sum = 0.0;
+  const auto t0 = Clock::now();
+  for (int i = 0; i < reads; ++i) sum += get(maps[static_cast<std::size_t>(pick(rng))], kPlaneKeys[i & 7]);
+  nsPerRead = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / reads;
+  EXPECT_GT(sum, 0.0);
+  std::cout << "[bench] params " << label << " n=" << n << ": " << bytesPer << " bytes/feature, " << nsPerRead
+            << " ns/read\n";
+}
+}
+
+// Heap footprint and random read cost of a plane's parameters: hash map vs schema-backed flat store
+TEST(ParamStoreBench, MemoryAndAccess)
+{
+  const int n = 100000;
+  double mapBytes = 0, mapNs = 0, flatBytes = 0, flatNs = 0;
+  measure<HashMap>(
+      "unordered_map", n, [] { return HashMap(); },
+      [](const HashMap& m, Key k) {
+        auto it = m.find(k);
+        return it == m.end() ? 0.0 : asDouble(&it->second);
+      },
+      mapBytes, mapNs);
+  measure<Feature::ParamMap>(
+      "flat", n, [] { return Feature::ParamMap(PlaneFeature::kSchema); },
+      [](const Feature::ParamMap& m, Key k) { return asDouble(m.get(k)); }, flatBytes, flatNs);
+
+  EXPECT_LT(flatBytes, mapBytes);
+  RecordProperty("map_bytes", std::to_string(mapBytes));
+  RecordProperty("flat_bytes", std::to_string(flatBytes));
+  RecordProperty("map_read_ns", std::to_string(mapNs));
+  RecordProperty("flat_read_ns", std::to_string(flatNs));
+}
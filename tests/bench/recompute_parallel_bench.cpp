@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include <Document.h>
+#include <BoxFeature.h>
+#include <MoveFeature.h>
+
+#include <common/test_utils.h>
+
+#include <chrono>
+#include <iostream>
+
+namespace {
+// Synthetic document: independent Box roots, each followed by its own Move chain
+std::vector<Handle(Feature)> buildBodies(Document& doc, int bodies, int chain)
+{
+  std::vector<Handle(Feature)> leaves;
+  for (int b = 0; b < bodies; ++b)
+  {
+    Handle(Feature) prev = new BoxFeature(1.0 + (b % 7), 2.0 + (b % 5), 3.0);
+    doc.addFeature(prev);
+    for (int i = 0; i < chain; ++i)
+    {
+      Handle(MoveFeature) mf = new MoveFeature(prev->id(), 2.0 * b, 0.5 * i, 0.0, 5.0 * i, 0.0, 10.0 * i);
+      prev->setSuppressed(true);
+      doc.addFeature(mf);
+      prev = mf;
+    }
+    leaves.push_back(prev);
+  }
+  return leaves;
+}
+
+double recomputeMs(Document& doc)
+{
+  const auto t0 = std::chrono::steady_clock::now();
+  doc.recompute();
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+}
+
+TEST(RecomputeBench, Parallel500Bodies)
+{
+  const int kBodies = 500;
+  const int kChain  = 4;
+
+  Document seq;
+  Document par;
+  par.setParallelRecompute(true);
+  const auto seqLeaves = buildBodies(seq, kBodies, kChain);
+  const auto parLeaves = buildBodies(par, kBodies, kChain);
+
+  const double tSeq = recomputeMs(seq);
+  const double tPar = recomputeMs(par);
+  std::cout << "[bench] full recompute of " << kBodies << " bodies x " << (kChain + 1) << " features: sequential "
+            << tSeq << " ms, parallel " << tPar << " ms, speedup " << (tPar > 0.0 ? tSeq / tPar : 0.0) << "x\n";
+  RecordProperty("sequential_ms", std::to_string(tSeq));
+  RecordProperty("parallel_ms", std::to_string(tPar));
+
+  for (int i = 0; i < kBodies; ++i)
+  {
+    EXPECT_EQ(countFaces(seqLeaves[i]->shape()), countFaces(parLeaves[i]->shape()));
+    const auto a = bboxExtents(seqLeaves[i]->shape());
+    const auto b = bboxExtents(parLeaves[i]->shape());
+    for (int k = 0; k < 3; ++k) EXPECT_NEAR(a[k], b[k], 1.0e-9);
+  }
+}
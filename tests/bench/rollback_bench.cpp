@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+
+#include <Document.h>
+#include <BoxFeature.h>
+#include <MoveFeature.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+
+// Scrubbing the rollback marker over a 1,000-step history: per-step latency once checkpointed
+TEST(RollbackBench, Scrub1000Steps)
+{
+  const int kSteps = 1000;
+  Document doc;
+  doc.setShapeCache(nullptr); // measure checkpoints, not the result cache
+  Handle(Feature) prev;
+  while (doc.items().Size() < kSteps)
+  {
+    if (prev.IsNull() || doc.items().Size() % 20 == 0) prev = new BoxFeature(1.0, 2.0, 3.0 + doc.items().Size());
+    else prev = new MoveFeature(prev->id(), 1.0, 0.0, 0.0, 0.0, 0.0, 5.0);
+    doc.addFeature(prev);
+  }
+  auto t0 = std::chrono::steady_clock::now();
+  doc.recompute();
+  const double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+  std::mt19937 rng(3);
+  std::uniform_int_distribution<int> pick(1, kSteps);
+  const int jumps = 200;
+  double worstMs = 0.0;
+  t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < jumps; ++i)
+  {
+    const auto s0 = std::chrono::steady_clock::now();
+    doc.setRollback(pick(rng));
+    doc.recompute();
+    worstMs = std::max(worstMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - s0).count());
+  }
+  const double avgMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() / jumps;
+
+  std::cout << "[bench] rollback " << kSteps << " steps: build " << buildMs << " ms, scrub avg " << avgMs
+            << " ms, worst " << worstMs << " ms (interval " << doc.checkpointInterval() << ")\n";
+  RecordProperty("build_ms", std::to_string(buildMs));
+  RecordProperty("scrub_avg_ms", std::to_string(avgMs));
+  RecordProperty("scrub_worst_ms", std::to_string(worstMs));
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <Document.h>
+#include <DocumentIO.h>
+#include <Sketch.h>
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+double msSince(Clock::time_point t0) { return std::chrono::duration<double, std::milli>(Clock::now() - t0).count(); }
+}
+
+// An imported 200k-curve sketch: encode/decode in both encodings, then a lazy open of a document
+// holding it, where the curves are decoded from the mapped file on first access
+TEST(SketchLoadBench, Import200kCurves)
+{
+  const int kCurves = 200000;
+  auto sk = std::make_shared<Sketch>();
+  std::mt19937 rng(5);
+  std::uniform_real_distribution<double> coord(-5.0e5, 5.0e5);
+  for (int i = 0; i < kCurves; ++i)
+  {
+    const gp_Pnt2d a(coord(rng), coord(rng));
+    const gp_Pnt2d b(coord(rng), coord(rng));
+    if (i % 4 == 0) sk->addArc(gp_Pnt2d((a.X() + b.X()) / 2, (a.Y() + b.Y()) / 2), a, b, i % 8 == 0);
+    else sk->addLine(a, b);
+    if (i > 0 && i % 2 == 0) sk->addCoincident({i - 1, 1}, {i, 0});
+  }
+
+  for (Sketch::Encoding encoding : {Sketch::Encoding::Binary, Sketch::Encoding::Text})
+  {
+    const char* name = encoding == Sketch::Encoding::Binary ? "binary" : "text";
+    auto t0 = Clock::now();
+    const std::string blob = sk->serialize(encoding);
+    const double writeMs = msSince(t0);
+    Sketch loaded;
+    t0 = Clock::now();
+    loaded.deserialize(blob);
+    const double readMs = msSince(t0);
+    EXPECT_EQ(loaded.contentHash(), sk->contentHash());
+    std::cout << "[bench] sketch " << name << " " << kCurves << " curves: " << blob.size() << " bytes, write "
+              << writeMs << " ms, read " << readMs << " ms\n";
+    RecordProperty(std::string(name) + "_write_ms", std::to_string(writeMs));
+    RecordProperty(std::string(name) + "_read_ms", std::to_string(readMs));
+  }
+
+  Document doc;
+  doc.addSketch(sk);
+  const std::filesystem::path dir = std::filesystem::temp_directory_path() / "vibecad_sketch_load_bench";
+  std::filesystem::create_directories(dir);
+  const std::filesystem::path file = dir / "sketch.vcad";
+  ASSERT_TRUE(DocumentIO::save(doc, file));
+  auto t0 = Clock::now();
+  std::unique_ptr<Document> loaded = DocumentIO::load(file, nullptr, DocumentIO::LoadMode::Lazy);
+  ASSERT_TRUE(loaded);
+  const std::shared_ptr<Sketch> lsk = loaded->findSketch(sk->id());
+  ASSERT_NE(lsk, nullptr);
+  EXPECT_EQ(lsk->curves().size(), static_cast<std::size_t>(kCurves));
+  const double openMs = msSince(t0);
+  std::cout << "[bench] sketch document open + first access: " << openMs << " ms\n";
+  RecordProperty("mapped_open_ms", std::to_string(openMs));
+  std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include <Document.h>
+#include <BoxFeature.h>
+
+#include <chrono>
+#include <iostream>
+#include <algorithm>
+#include <random>
+#include <string>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double nsPerOp(Clock::time_point t0, std::size_t ops)
+{
+  return std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / static_cast<double>(ops);
+}
+}
+
+// Per-operation cost of timeline edits and lookups should not grow with document size
+TEST(TimelineBench, AddFindRemoveScale)
+{
+  for (int n : {100, 1000, 10000, 100000})
+  {
+    Document doc;
+    std::vector<Handle(Feature)> features;
+    features.reserve(static_cast<std::size_t>(n));
+    for (int i = 0; i < n; ++i) features.push_back(new BoxFeature(1.0, 1.0, 1.0));
+
+    auto t0 = Clock::now();
+    for (const Handle(Feature)& f : features) doc.addFeature(f);
+    const double addNs = nsPerOp(t0, features.size());
+
+    // Random lookups by id and position
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> pick(0, n - 1);
+    const int lookups = 10000;
+    std::size_t found = 0;
+    t0 = Clock::now();
+    for (int i = 0; i < lookups; ++i)
+    {
+      const Handle(Feature)& f = features[static_cast<std::size_t>(pick(rng))];
+      found += doc.items().find(f->id()).IsNull() ? 0 : 1;
+      found += doc.items().indexOf(f->id()) != 0 ? 1 : 0;
+    }
+    const double findNs = nsPerOp(t0, lookups);
+    EXPECT_EQ(found, static_cast<std::size_t>(2 * lookups));
+
+    // Remove by handle from the tail (undo-like edits)
+    const int removals = std::min(n / 2, 1000);
+    t0 = Clock::now();
+    for (int i = 0; i < removals; ++i) doc.removeFeature(features[static_cast<std::size_t>(n - 1 - i)]);
+    const double removeNs = nsPerOp(t0, static_cast<std::size_t>(removals));
+    EXPECT_FALSE(doc.items().contains(features.back()->id()));
+
+    std::cout << "[bench] timeline n=" << n << ": add " << addNs << " ns/op, find " << findNs
+              << " ns/op, remove " << removeNs << " ns/op\n";
+    RecordProperty("add_ns_" + std::to_string(n), std::to_string(addNs));
+    RecordProperty("find_ns_" + std::to_string(n), std::to_string(findNs));
+    RecordProperty("remove_ns_" + std::to_string(n), std::to_string(removeNs));
+  }
+}
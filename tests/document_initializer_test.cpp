@@ -12,7 +12,7 @@ TEST(DocumentInitializer, NewDocumentHasDefaultPlanesAndOptionalOrigin)
   // Count planes and points in the ordered items list
   int planeCount = 0;
   int pointCount = 0;
-  for (NCollection_Sequence<Handle(DocumentItem)>::Iterator it(doc.items()); it.More(); it.Next())
+  for (Timeline::Iterator it(doc.items()); it.More(); it.Next())
   {
     const Handle(DocumentItem)& di = it.Value();
     if (!Handle(PlaneFeature)::DownCast(di).IsNull()) ++planeCount;
@@ -38,7 +38,7 @@ TEST(DocumentInitializer, ClearReinitializesUsingDatumToggles)
   d->setShowOriginPoint(false);
   doc.clear();
   int pointCount = 0;
-  for (NCollection_Sequence<Handle(DocumentItem)>::Iterator it(doc.items()); it.More(); it.Next())
+  for (Timeline::Iterator it(doc.items()); it.More(); it.Next())
   {
     if (!Handle(PointFeature)::DownCast(it.Value()).IsNull()) ++pointCount;
   }
@@ -49,7 +49,7 @@ TEST(DocumentInitializer, ClearReinitializesUsingDatumToggles)
   doc.clear();
   pointCount = 0;
   int planeCount = 0;
-  for (NCollection_Sequence<Handle(DocumentItem)>::Iterator it2(doc.items()); it2.More(); it2.Next())
+  for (Timeline::Iterator it2(doc.items()); it2.More(); it2.Next())
   {
     if (!Handle(PointFeature)::DownCast(it2.Value()).IsNull()) ++pointCount;
     if (!Handle(PlaneFeature)::DownCast(it2.Value()).IsNull()) ++planeCount;
@@ -49,3 +49,36 @@ TEST(Model, ExtrudeFeatureSolidBBoxAndVolume)
   EXPECT_NEAR(volume(shp), w * h * d, 1e-6);
 }
 
+
+TEST(Model, ExtrudeFeatureFusesAllProfiles)
+{
+  // Two overlapping rectangles and a separate one: one fuse over all prisms
+  auto sk = std::make_shared<Sketch>();
+  auto addRect = [&sk](double x0, double y0, double x1, double y1) {
+    const Sketch::CurveId a = sk->addLine(gp_Pnt2d(x0, y0), gp_Pnt2d(x1, y0));
+    const Sketch::CurveId b = sk->addLine(gp_Pnt2d(x1, y0), gp_Pnt2d(x1, y1));
+    const Sketch::CurveId c = sk->addLine(gp_Pnt2d(x1, y1), gp_Pnt2d(x0, y1));
+    const Sketch::CurveId d = sk->addLine(gp_Pnt2d(x0, y1), gp_Pnt2d(x0, y0));
+    sk->addCoincident({a, 1}, {b, 0});
+    sk->addCoincident({b, 1}, {c, 0});
+    sk->addCoincident({c, 1}, {d, 0});
+    sk->addCoincident({d, 1}, {a, 0});
+  };
+  addRect(0.0, 0.0, 10.0, 10.0);
+  addRect(5.0, 0.0, 15.0, 10.0);
+  addRect(20.0, 0.0, 30.0, 10.0);
+  sk->solveConstraints();
+
+  Handle(ExtrudeFeature) ef = new ExtrudeFeature();
+  ef->setSketch(sk);
+  ef->setDistance(4.0);
+  ef->execute();
+
+  const auto& shp = ef->shape();
+  ASSERT_FALSE(shp.IsNull());
+  auto ext = bboxExtents(shp);
+  EXPECT_NEAR(ext[0], 30.0, 1e-6);
+  EXPECT_NEAR(ext[1], 10.0, 1e-6);
+  EXPECT_NEAR(ext[2], 4.0, 1e-6);
+  EXPECT_NEAR(volume(shp), (150.0 + 100.0) * 4.0, 1e-6); // the overlap counts once
+}
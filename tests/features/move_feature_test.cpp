@@ -6,6 +6,7 @@
 
 #include <Bnd_Box.hxx>
 #include <BRepBndLib.hxx>
+#include <TopLoc_Location.hxx>
 
 static gp_Pnt bboxCenter(const TopoDS_Shape& s)
 {
@@ -37,3 +38,29 @@ TEST(Model, MoveFeatureTranslatesShape)
   EXPECT_NEAR(c1.Z() - c0.Z(), 2.5, 1e-7);
 }
 
+
+TEST(Model, MoveChainSharesSourceGeometryAndCollapsesTransforms)
+{
+  Document doc;
+  Handle(BoxFeature) bf = new BoxFeature(1.0, 2.0, 3.0);
+  doc.addFeature(bf);
+
+  Handle(Feature) prev = bf;
+  for (int i = 0; i < 3; ++i)
+  {
+    Handle(MoveFeature) mf = new MoveFeature(prev->id(), 1.0, 2.0 * i, 0.0, 0.0, 0.0, 0.0);
+    doc.addFeature(mf);
+    prev = mf;
+  }
+  doc.recompute();
+
+  const TopoDS_Shape& base = bf->shape();
+  const TopoDS_Shape& last = prev->shape();
+  ASSERT_FALSE(last.IsNull());
+  // No geometry copy: the chain end refers to the box's TShape under one composed location
+  EXPECT_TRUE(last.TShape() == base.TShape());
+  const gp_XYZ t = last.Location().Transformation().TranslationPart();
+  EXPECT_NEAR(t.X(), 3.0, 1e-9);
+  EXPECT_NEAR(t.Y(), 6.0, 1e-9);
+  EXPECT_NEAR(t.Z(), 0.0, 1e-9);
+}
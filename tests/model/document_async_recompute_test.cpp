@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include <Document.h>
+#include <BoxFeature.h>
+#include <MoveFeature.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+class CountingBox : public BoxFeature
+{
+public:
+  using BoxFeature::BoxFeature;
+  void execute() override { ++calls; BoxFeature::execute(); }
+  Handle(Feature) clone() const override { return new CountingBox(*this); }
+  int calls = 0;
+};
+
+// Spins until the recompute's progress range reports a user break
+class BlockingBox : public BoxFeature
+{
+public:
+  using BoxFeature::BoxFeature;
+  void execute() override
+  {
+    started = true;
+    const Message_ProgressRange range = progressRange();
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!range.UserBreak() && std::chrono::steady_clock::now() < deadline)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    m_shape = TopoDS_Shape();
+  }
+  Handle(Feature) clone() const override { return new BlockingBox(*this); }
+  static std::atomic<bool> started;
+};
+std::atomic<bool> BlockingBox::started{false};
+}
+
+TEST(DocumentAsyncRecompute, RunsOnSnapshotAndPublishesOnDemand)
+{
+  Document doc;
+  Handle(CountingBox) box = new CountingBox(1.0, 2.0, 3.0);
+  Handle(MoveFeature) mv = new MoveFeature(box->id(), 1.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+  doc.addFeature(box);
+  doc.addFeature(mv);
+
+  std::atomic<std::size_t> reported{0};
+  std::atomic<std::size_t> total{0};
+  RecomputeJob::Callbacks cb;
+  cb.onFeatureDone = [&](DocumentItem::Id, std::size_t, std::size_t t) { ++reported; total = t; };
+  std::shared_ptr<RecomputeJob> job = doc.recomputeAsync(cb);
+  job->wait();
+
+  ASSERT_EQ(job->state(), RecomputeJob::State::Finished);
+  EXPECT_EQ(reported.load(), total.load());
+  EXPECT_EQ(job->completedFeatures(), job->totalFeatures());
+  EXPECT_DOUBLE_EQ(job->progress(), 1.0);
+  // Nothing is visible in the document before publish
+  EXPECT_TRUE(mv->shape().IsNull());
+  EXPECT_EQ(box->calls, 0);
+
+  ASSERT_TRUE(doc.publish(*job));
+  EXPECT_FALSE(box->shape().IsNull());
+  EXPECT_FALSE(mv->shape().IsNull());
+  EXPECT_FALSE(box->isDirty());
+  EXPECT_FALSE(mv->isDirty());
+  EXPECT_FALSE(doc.publish(*job)); // once only
+
+  doc.recompute();
+  EXPECT_EQ(box->calls, 0); // published results are current
+}
+
+TEST(DocumentAsyncRecompute, EditsDuringRunStayDirty)
+{
+  Document doc;
+  doc.setShapeCache(nullptr);
+  Handle(CountingBox) box = new CountingBox(1.0, 2.0, 3.0);
+  Handle(CountingBox) other = new CountingBox(4.0, 4.0, 4.0);
+  doc.addFeature(box);
+  doc.addFeature(other);
+
+  std::shared_ptr<RecomputeJob> job = doc.recomputeAsync();
+  box->setSize(5.0, 5.0, 5.0); // edited after the snapshot was taken
+  job->wait();
+  ASSERT_TRUE(doc.publish(*job));
+
+  EXPECT_TRUE(box->isDirty());
+  EXPECT_FALSE(other->isDirty());
+  doc.recompute();
+  EXPECT_EQ(box->calls, 1);
+  EXPECT_EQ(other->calls, 0);
+}
+
+TEST(DocumentAsyncRecompute, CancelStopsKernelWorkAndPublishesNothing)
+{
+  Document doc;
+  Handle(BlockingBox) slow = new BlockingBox(1.0, 1.0, 1.0);
+  Handle(MoveFeature) mv = new MoveFeature(slow->id(), 1.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+  doc.addFeature(slow);
+  doc.addFeature(mv);
+
+  BlockingBox::started = false;
+  std::shared_ptr<RecomputeJob> job = doc.recomputeAsync();
+  while (!BlockingBox::started) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  EXPECT_FALSE(job->isDone());
+  job->cancel();
+  job->wait();
+
+  EXPECT_EQ(job->state(), RecomputeJob::State::Cancelled);
+  EXPECT_LT(job->completedFeatures(), 2u);
+  EXPECT_FALSE(doc.publish(*job));
+  EXPECT_TRUE(slow->isDirty());
+  EXPECT_TRUE(mv->isDirty());
+}
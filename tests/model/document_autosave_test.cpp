@@ -0,0 +1,227 @@
+#include <gtest/gtest.h>
+
+#include <Document.h>
+#include <DocumentAutosave.h>
+#include <DocumentIO.h>
+#include <BoxFeature.h>
+#include <MoveFeature.h>
+#include <Sketch.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+class DocumentAutosaveTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_dir = std::filesystem::temp_directory_path() /
+            ("vibecad_autosave_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+    std::filesystem::remove_all(m_dir);
+    std::filesystem::create_directories(m_dir);
+    m_file = m_dir / "part.vcad";
+  }
+  void TearDown() override { std::filesystem::remove_all(m_dir); }
+
+  static void expectSameState(const Document& a, const Document& b)
+  {
+    ASSERT_EQ(a.items().Size(), b.items().Size());
+    for (int i = 1; i <= a.items().Size(); ++i)
+    {
+      EXPECT_EQ(a.items().Value(i)->id(), b.items().Value(i)->id()) << "position " << i;
+      EXPECT_EQ(a.items().Value(i)->serialize(), b.items().Value(i)->serialize()) << "position " << i;
+    }
+    const auto sa = a.sketches();
+    const auto sb = b.sketches();
+    ASSERT_EQ(sa.size(), sb.size());
+    for (std::size_t i = 0; i < sa.size(); ++i) EXPECT_EQ(sa[i]->serialize(), sb[i]->serialize());
+  }
+
+  std::filesystem::path m_dir;
+  std::filesystem::path m_file;
+};
+}
+
+TEST_F(DocumentAutosaveTest, FlushCostFollowsTheEdit)
+{
+  Document doc;
+  std::vector<Handle(BoxFeature)> boxes;
+  for (int i = 0; i < 2000; ++i)
+  {
+    boxes.push_back(new BoxFeature(1.0 + i, 1.0, 1.0));
+    doc.addFeature(boxes.back());
+  }
+  ASSERT_TRUE(DocumentIO::save(doc, m_file));
+  DocumentAutosave autosave(doc, m_file);
+
+  boxes[1234]->setDz(7.0);
+  doc.recompute(); // the change notification flushes
+  EXPECT_GT(autosave.lastFlushBytes(), 0u);
+  EXPECT_LT(autosave.lastFlushBytes(), 512u);
+  EXPECT_TRUE(autosave.flush());
+  EXPECT_EQ(autosave.lastFlushBytes(), 0u); // nothing new
+
+  std::string error;
+  std::unique_ptr<Document> recovered = DocumentAutosave::recover(m_file, &error);
+  ASSERT_TRUE(recovered) << error;
+  expectSameState(doc, *recovered);
+}
+
+TEST_F(DocumentAutosaveTest, RecoverReplaysStructureAndSketchEdits)
+{
+  Document doc;
+  Handle(BoxFeature) box = new BoxFeature(1.0, 2.0, 3.0);
+  doc.addFeature(box);
+  ASSERT_TRUE(DocumentIO::save(doc, m_file));
+  {
+    DocumentAutosave autosave(doc, m_file);
+    Handle(MoveFeature) mv = new MoveFeature(box->id(), 1.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+    doc.addFeature(mv);
+    Handle(BoxFeature) first = new BoxFeature(9.0, 9.0, 9.0);
+    doc.insertItem(1, first);
+    auto sk = std::make_shared<Sketch>();
+    sk->addLine(gp_Pnt2d(0, 0), gp_Pnt2d(5, 0));
+    doc.addSketch(sk);
+    ASSERT_TRUE(autosave.flush());
+
+    sk->addLine(gp_Pnt2d(5, 0), gp_Pnt2d(5, 5));
+    box->setName(TCollection_AsciiString("Renamed"));
+    doc.removeItem(first);
+    ASSERT_TRUE(autosave.flush());
+  } // no compaction: the journal is the only record of the edits
+
+  ASSERT_TRUE(DocumentAutosave::hasJournal(m_file));
+  std::string error;
+  std::unique_ptr<Document> recovered = DocumentAutosave::recover(m_file, &error);
+  ASSERT_TRUE(recovered) << error;
+  expectSameState(doc, *recovered);
+  EXPECT_FALSE(recovered->journal().canUndo());
+}
+
+TEST_F(DocumentAutosaveTest, TornTailIsIgnored)
+{
+  Document doc;
+  Handle(BoxFeature) box = new BoxFeature(1.0, 2.0, 3.0);
+  doc.addFeature(box);
+  ASSERT_TRUE(DocumentIO::save(doc, m_file));
+  DocumentAutosave autosave(doc, m_file);
+  box->setDx(4.0);
+  ASSERT_TRUE(autosave.flush());
+  {
+    // A crash in the middle of the next append
+    std::ofstream os(DocumentAutosave::segmentPath(m_file, autosave.generation()), std::ios::binary | std::ios::app);
+    os << "\x40\x00\x00\x00\x03garbage";
+  }
+  std::unique_ptr<Document> recovered = DocumentAutosave::recover(m_file);
+  ASSERT_TRUE(recovered);
+  expectSameState(doc, *recovered);
+}
+
+TEST_F(DocumentAutosaveTest, CompactionFoldsTheJournalIntoTheFile)
+{
+  Document doc;
+  Handle(BoxFeature) box = new BoxFeature(1.0, 2.0, 3.0);
+  doc.addFeature(box);
+  ASSERT_TRUE(DocumentIO::save(doc, m_file));
+  DocumentAutosave autosave(doc, m_file);
+  box->setDx(4.0);
+  ASSERT_TRUE(autosave.flush());
+  const std::uint32_t before = autosave.generation();
+
+  autosave.compact(true);
+  EXPECT_EQ(autosave.generation(), before + 1);
+  EXPECT_EQ(DocumentIO::generation(m_file), autosave.generation());
+  EXPECT_FALSE(std::filesystem::exists(DocumentAutosave::segmentPath(m_file, before)));
+  std::unique_ptr<Document> reloaded = DocumentIO::load(m_file);
+  ASSERT_TRUE(reloaded);
+  expectSameState(doc, *reloaded);
+
+  // Later edits land in the new segment only
+  box->setDy(5.0);
+  ASSERT_TRUE(autosave.flush());
+  std::unique_ptr<Document> recovered = DocumentAutosave::recover(m_file);
+  ASSERT_TRUE(recovered);
+  expectSameState(doc, *recovered);
+}
+
+TEST_F(DocumentAutosaveTest, BackgroundCompactionRunsAgainAfterFinishing)
+{
+  Document doc;
+  Handle(BoxFeature) box = new BoxFeature(1.0, 2.0, 3.0);
+  doc.addFeature(box);
+  ASSERT_TRUE(DocumentIO::save(doc, m_file));
+  DocumentAutosave autosave(doc, m_file);
+  autosave.setCompactionRatio(0.0); // any journal past the minimum size compacts
+
+  // Nobody waits for the compactions: a finished one must not block the next
+  const std::uint32_t start = autosave.generation();
+  for (int round = 1; round <= 2; ++round)
+  {
+    box->setName(TCollection_AsciiString(std::string(80 * 1024, char('a' + round)).c_str()));
+    ASSERT_TRUE(autosave.flush());
+    EXPECT_EQ(autosave.generation(), start + round);
+    for (int i = 0; i < 1000 && autosave.compacting(); ++i) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ASSERT_FALSE(autosave.compacting());
+    EXPECT_EQ(DocumentIO::generation(m_file), autosave.generation());
+  }
+
+  std::unique_ptr<Document> recovered = DocumentAutosave::recover(m_file);
+  ASSERT_TRUE(recovered);
+  expectSameState(doc, *recovered);
+}
+
+TEST_F(DocumentAutosaveTest, LeftoverSegmentsAreFoldedOnAttach)
+{
+  Document doc;
+  Handle(BoxFeature) box = new BoxFeature(1.0, 2.0, 3.0);
+  doc.addFeature(box);
+  ASSERT_TRUE(DocumentIO::save(doc, m_file));
+  {
+    DocumentAutosave crashed(doc, m_file);
+    box->setDx(8.0);
+    ASSERT_TRUE(crashed.flush());
+  }
+  std::unique_ptr<Document> recovered = DocumentAutosave::recover(m_file);
+  ASSERT_TRUE(recovered);
+  DocumentAutosave autosave(*recovered, m_file); // rewrites the file from the recovered state
+  EXPECT_FALSE(std::filesystem::exists(DocumentAutosave::segmentPath(m_file, 0)));
+  std::unique_ptr<Document> reloaded = DocumentIO::load(m_file);
+  ASSERT_TRUE(reloaded);
+  expectSameState(doc, *reloaded);
+}
+
+TEST_F(DocumentAutosaveTest, RandomReordersReplayInOrder)
+{
+  Document doc;
+  std::vector<Handle(BoxFeature)> boxes;
+  for (int i = 0; i < 60; ++i)
+  {
+    boxes.push_back(new BoxFeature(1.0 + i, 1.0, 1.0));
+    doc.addFeature(boxes.back());
+  }
+  ASSERT_TRUE(DocumentIO::save(doc, m_file));
+  DocumentAutosave autosave(doc, m_file);
+
+  std::mt19937 rng(11);
+  for (int round = 0; round < 20; ++round)
+  {
+    for (int k = 0; k < 5; ++k)
+    {
+      const int from = std::uniform_int_distribution<int>(1, doc.items().Size())(rng);
+      Handle(DocumentItem) item = doc.items().Value(from);
+      doc.removeItem(item);
+      if (k % 2 == 0) doc.insertItem(std::uniform_int_distribution<int>(1, doc.items().Size() + 1)(rng), item);
+      else doc.addFeature(new BoxFeature(100.0 + round, 2.0, k));
+    }
+    ASSERT_TRUE(autosave.flush());
+  }
+  std::unique_ptr<Document> recovered = DocumentAutosave::recover(m_file);
+  ASSERT_TRUE(recovered);
+  expectSameState(doc, *recovered);
+}
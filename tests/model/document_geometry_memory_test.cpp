@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+
+#include <Document.h>
+#include <BoxFeature.h>
+#include <MoveFeature.h>
+#include <ShapeMemory.h>
+#include <KernelAPI.h>
+
+#include <BRepMesh_IncrementalMesh.hxx>
+
+TEST(ShapeMemory, NullShapeIsEmpty)
+{
+  const ShapeMemory::Usage u = ShapeMemory::measure(TopoDS_Shape());
+  EXPECT_EQ(u.total(), 0u);
+}
+
+TEST(ShapeMemory, SharedTShapeCountedOnce)
+{
+  const TopoDS_Shape box = KernelAPI::makeBox(1.0, 2.0, 3.0);
+  ShapeMemory counter;
+  const ShapeMemory::Usage first = counter.add(box);
+  EXPECT_GT(first.topology, 0u);
+
+  // Same TShape under another location adds nothing
+  gp_Trsf t;
+  t.SetTranslation(gp_Vec(5.0, 0.0, 0.0));
+  EXPECT_EQ(counter.add(box.Moved(TopLoc_Location(t))).total(), 0u);
+  EXPECT_EQ(counter.add(box).total(), 0u);
+  EXPECT_EQ(counter.total().total(), first.total());
+
+  counter.clear();
+  EXPECT_EQ(counter.add(box).total(), first.total());
+}
+
+TEST(ShapeMemory, MeshingAddsTriangulation)
+{
+  const TopoDS_Shape box = KernelAPI::makeBox(10.0, 10.0, 10.0);
+  const ShapeMemory::Usage before = ShapeMemory::measure(box);
+  EXPECT_GT(before.geometry, 0u);
+  EXPECT_EQ(before.triangulation, 0u);
+
+  BRepMesh_IncrementalMesh mesh(box, 0.5);
+  const ShapeMemory::Usage after = ShapeMemory::measure(box);
+  EXPECT_GT(after.triangulation, 0u);
+  EXPECT_EQ(after.topology, before.topology);
+}
+
+TEST(DocumentGeometryMemory, SharedResultsCountOnceInTotal)
+{
+  Document doc;
+  Handle(BoxFeature) box = new BoxFeature(1.0, 2.0, 3.0);
+  Handle(MoveFeature) moved = new MoveFeature(box->id(), 4.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+  Handle(BoxFeature) other = new BoxFeature(2.0, 2.0, 2.0);
+  doc.addFeature(box);
+  doc.addFeature(moved);
+  doc.addFeature(other);
+  doc.recompute();
+
+  const Document::GeometryMemory memory = doc.geometryMemory();
+  ShapeMemory::Usage sum;
+  const Document::GeometryMemory::Entry* boxEntry = nullptr;
+  const Document::GeometryMemory::Entry* movedEntry = nullptr;
+  for (const auto& e : memory.features)
+  {
+    EXPECT_LE(e.added.total(), e.usage.total());
+    sum += e.added;
+    if (e.id == box->id()) boxEntry = &e;
+    if (e.id == moved->id()) movedEntry = &e;
+  }
+  ASSERT_NE(boxEntry, nullptr);
+  ASSERT_NE(movedEntry, nullptr);
+  EXPECT_GT(boxEntry->usage.topology, 0u);
+  EXPECT_EQ(boxEntry->added.total(), boxEntry->usage.total());
+  // A rigid move relocates the box's TShape: full usage on its own, nothing new for the document
+  EXPECT_EQ(movedEntry->usage.total(), boxEntry->usage.total());
+  EXPECT_EQ(movedEntry->added.total(), 0u);
+  EXPECT_EQ(sum.total(), memory.total.total());
+}
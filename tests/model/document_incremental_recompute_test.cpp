@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+
+#include <Document.h>
+#include <BoxFeature.h>
+#include <ExtrudeFeature.h>
+#include <MoveFeature.h>
+#include <PlaneFeature.h>
+#include <Sketch.h>
+
+namespace {
+// Test doubles counting execute() calls
+class CountingBox : public BoxFeature
+{
+public:
+  using BoxFeature::BoxFeature;
+  void execute() override { ++calls; BoxFeature::execute(); }
+  int calls = 0;
+};
+
+class CountingMove : public MoveFeature
+{
+public:
+  void execute() override { ++calls; MoveFeature::execute(); }
+  int calls = 0;
+};
+
+class CountingExtrude : public ExtrudeFeature
+{
+public:
+  using ExtrudeFeature::ExtrudeFeature;
+  void execute() override { ++calls; ExtrudeFeature::execute(); }
+  int calls = 0;
+};
+
+std::shared_ptr<Sketch> makeRectSketch(double w, double h)
+{
+  auto sk = std::make_shared<Sketch>();
+  auto c1 = sk->addLine(gp_Pnt2d(0, 0), gp_Pnt2d(w, 0));
+  auto c2 = sk->addLine(gp_Pnt2d(w, 0), gp_Pnt2d(w, h));
+  auto c3 = sk->addLine(gp_Pnt2d(w, h), gp_Pnt2d(0, h));
+  auto c4 = sk->addLine(gp_Pnt2d(0, h), gp_Pnt2d(0, 0));
+  sk->addCoincident({c1, 1}, {c2, 0});
+  sk->addCoincident({c2, 1}, {c3, 0});
+  sk->addCoincident({c3, 1}, {c4, 0});
+  sk->addCoincident({c4, 1}, {c1, 0});
+  sk->solveConstraints();
+  return sk;
+}
+}
+
+TEST(DocumentIncrementalRecompute, SingleParamEditExecutesOnlyDirtyChain)
+{
+  Document doc;
+
+  // Chain: base -> m1 -> m2 -> m3, plus an independent box
+  Handle(CountingBox) base = new CountingBox(10.0, 10.0, 10.0);
+  Handle(CountingBox) other = new CountingBox(1.0, 2.0, 3.0);
+  doc.addFeature(base);
+  doc.addFeature(other);
+  std::vector<Handle(CountingMove)> moves;
+  Handle(Feature) prev = base;
+  for (int i = 0; i < 3; ++i)
+  {
+    Handle(CountingMove) mf = new CountingMove();
+    mf->setSourceId(prev->id());
+    mf->setTranslation(1.0, 0.0, 0.0);
+    prev->setSuppressed(true);
+    doc.addFeature(mf);
+    moves.push_back(mf);
+    prev = mf;
+  }
+  doc.recompute();
+  EXPECT_EQ(base->calls, 1);
+  EXPECT_EQ(other->calls, 1);
+  for (const auto& m : moves) EXPECT_EQ(m->calls, 1);
+
+  // Nothing changed: nothing re-executes
+  doc.recompute();
+  EXPECT_EQ(base->calls, 1);
+  EXPECT_EQ(other->calls, 1);
+  for (const auto& m : moves) EXPECT_EQ(m->calls, 1);
+
+  // Edit the last feature only
+  moves.back()->setTranslation(2.0, 0.0, 0.0);
+  doc.recompute();
+  EXPECT_EQ(base->calls, 1);
+  EXPECT_EQ(other->calls, 1);
+  EXPECT_EQ(moves[0]->calls, 1);
+  EXPECT_EQ(moves[1]->calls, 1);
+  EXPECT_EQ(moves[2]->calls, 2);
+
+  // Edit the (suppressed) root: the whole chain re-executes, the independent box does not
+  base->setDx(20.0);
+  doc.recompute();
+  EXPECT_EQ(base->calls, 2);
+  EXPECT_EQ(other->calls, 1);
+  EXPECT_EQ(moves[0]->calls, 2);
+  EXPECT_EQ(moves[1]->calls, 2);
+  EXPECT_EQ(moves[2]->calls, 3);
+
+  const auto& down = doc.dependencies().downstream(base->id());
+  ASSERT_EQ(down.size(), 1u);
+  EXPECT_EQ(down.front(), moves[0]->id());
+}
+
+TEST(DocumentIncrementalRecompute, SketchAndPlaneEditsPropagateToExtrude)
+{
+  Document doc;
+  Handle(PlaneFeature) plane = doc.planes().First();
+  auto sk = makeRectSketch(10.0, 20.0);
+  sk->setPlaneId(plane->id());
+  doc.addSketch(sk);
+
+  Handle(CountingExtrude) ef = new CountingExtrude(sk->id(), 5.0);
+  Handle(CountingBox) other = new CountingBox(1.0, 1.0, 1.0);
+  doc.addFeature(ef);
+  doc.addFeature(other);
+  doc.recompute();
+  EXPECT_EQ(ef->calls, 1);
+  EXPECT_EQ(other->calls, 1);
+
+  // Sketch geometry change re-executes the extrude only
+  sk->addLine(gp_Pnt2d(0, 0), gp_Pnt2d(5, 5));
+  doc.recompute();
+  EXPECT_EQ(ef->calls, 2);
+  EXPECT_EQ(other->calls, 1);
+
+  // Plane edit reaches the extrude through the sketch
+  plane->setSize(plane->size() + 1.0);
+  doc.recompute();
+  EXPECT_EQ(ef->calls, 3);
+  EXPECT_EQ(other->calls, 1);
+
+  // Own parameter edit
+  ef->setDistance(7.0);
+  doc.recompute();
+  EXPECT_EQ(ef->calls, 4);
+  EXPECT_EQ(other->calls, 1);
+}
+
+TEST(DocumentIncrementalRecompute, UnsuppressRebuildsStaleResult)
+{
+  Document doc;
+  Handle(CountingBox) box = new CountingBox(1.0, 1.0, 1.0);
+  doc.addFeature(box);
+  doc.recompute();
+  ASSERT_EQ(box->calls, 1);
+
+  box->setSuppressed(true);
+  box->setDz(4.0);
+  doc.recompute();
+  EXPECT_EQ(box->calls, 1); // suppressed and unused: skipped
+
+  box->setSuppressed(false);
+  doc.recompute();
+  EXPECT_EQ(box->calls, 2);
+}
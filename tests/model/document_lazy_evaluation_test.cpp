@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <Document.h>
+#include <BoxFeature.h>
+#include <MoveFeature.h>
+
+#include <memory>
+
+namespace {
+class CountingBox : public BoxFeature
+{
+public:
+  using BoxFeature::BoxFeature;
+  void execute() override { ++calls; BoxFeature::execute(); }
+  int calls = 0;
+};
+
+class CountingMove : public MoveFeature
+{
+public:
+  using MoveFeature::MoveFeature;
+  void execute() override { ++calls; MoveFeature::execute(); }
+  int calls = 0;
+};
+}
+
+TEST(DocumentLazyEvaluation, ShapeAccessPullsUpstreamOnce)
+{
+  Document doc;
+  doc.setLazyEvaluation(true);
+  Handle(CountingBox) box = new CountingBox(1.0, 2.0, 3.0);
+  Handle(CountingMove) mv = new CountingMove(box->id(), 1.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+  Handle(CountingBox) hidden = new CountingBox(4.0, 4.0, 4.0);
+  doc.addFeature(box);
+  doc.addFeature(mv);
+  doc.addFeature(hidden);
+  doc.recompute();
+  EXPECT_EQ(box->calls + mv->calls + hidden->calls, 0);
+  EXPECT_TRUE(mv->isPendingEvaluation());
+
+  EXPECT_FALSE(mv->shape().IsNull());
+  EXPECT_EQ(box->calls, 1);
+  EXPECT_EQ(mv->calls, 1);
+  EXPECT_FALSE(mv->isDirty());
+  EXPECT_FALSE(box->isPendingEvaluation());
+  mv->shape();
+  EXPECT_EQ(mv->calls, 1);
+  EXPECT_EQ(hidden->calls, 0); // never read, never built
+
+  // Invalidation makes the dependent pending again; untouched upstream stays built
+  mv->setTranslation(2.0, 0.0, 0.0);
+  doc.recompute();
+  EXPECT_TRUE(mv->isPendingEvaluation());
+  EXPECT_FALSE(box->isPendingEvaluation());
+  mv->shape();
+  EXPECT_EQ(box->calls, 1);
+  EXPECT_EQ(mv->calls, 2);
+}
+
+TEST(DocumentLazyEvaluation, EditAfterRecomputeIsNotCached)
+{
+  Document doc;
+  doc.setLazyEvaluation(true);
+  Handle(CountingBox) box = new CountingBox(1.0, 1.0, 1.0);
+  doc.addFeature(box);
+  doc.recompute();
+  const std::size_t entries = doc.shapeCache()->stats().entries;
+
+  box->setDx(5.0); // after planning: the planned key describes Dx=1
+  box->shape();
+  EXPECT_EQ(box->calls, 1);
+  EXPECT_TRUE(box->isDirty());
+  EXPECT_EQ(doc.shapeCache()->stats().entries, entries);
+
+  doc.recompute();
+  box->shape();
+  EXPECT_EQ(box->calls, 2);
+  EXPECT_FALSE(box->isDirty());
+}
+
+TEST(DocumentLazyEvaluation, PendingFeaturesOutliveTheDocument)
+{
+  Handle(CountingBox) box = new CountingBox(1.0, 1.0, 1.0);
+  {
+    auto doc = std::make_unique<Document>();
+    doc->setLazyEvaluation(true);
+    doc->addFeature(box);
+    doc->recompute();
+    EXPECT_TRUE(box->isPendingEvaluation());
+  }
+  EXPECT_FALSE(box->isPendingEvaluation());
+  EXPECT_TRUE(box->shape().IsNull());
+  EXPECT_EQ(box->calls, 0);
+}
+
+TEST(DocumentLazyEvaluation, SwitchingBackToEagerExecutesPending)
+{
+  Document doc;
+  doc.setLazyEvaluation(true);
+  Handle(CountingBox) box = new CountingBox(1.0, 1.0, 1.0);
+  doc.addFeature(box);
+  doc.recompute();
+  doc.setLazyEvaluation(false);
+  EXPECT_FALSE(box->isPendingEvaluation());
+  doc.recompute();
+  EXPECT_EQ(box->calls, 1);
+  EXPECT_FALSE(box->currentShape().IsNull());
+}
@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include <Document.h>
+#include <BoxFeature.h>
+#include <CylinderFeature.h>
+#include <MoveFeature.h>
+
+#include <common/test_utils.h>
+
+#include <atomic>
+
+namespace {
+// Several independent bodies, each with its own Move chain
+std::vector<Handle(Feature)> buildBodies(Document& doc, int bodies, int chain)
+{
+  std::vector<Handle(Feature)> leaves;
+  for (int b = 0; b < bodies; ++b)
+  {
+    Handle(Feature) prev;
+    if (b % 2 == 0) prev = new BoxFeature(1.0 + b, 2.0, 3.0);
+    else            prev = new CylinderFeature(1.0 + 0.5 * b, 4.0);
+    doc.addFeature(prev);
+    for (int i = 0; i < chain; ++i)
+    {
+      Handle(MoveFeature) mf = new MoveFeature(prev->id(), 1.0 * b, 0.5 * i, 0.0, 0.0, 0.0, 10.0 * i);
+      prev->setSuppressed(true);
+      doc.addFeature(mf);
+      prev = mf;
+    }
+    leaves.push_back(prev);
+  }
+  return leaves;
+}
+
+void expectSameResult(const TopoDS_Shape& a, const TopoDS_Shape& b)
+{
+  ASSERT_EQ(a.IsNull(), b.IsNull());
+  if (a.IsNull()) return;
+  EXPECT_EQ(countFaces(a), countFaces(b));
+  const auto ea = bboxExtents(a);
+  const auto eb = bboxExtents(b);
+  for (int k = 0; k < 3; ++k) EXPECT_NEAR(ea[k], eb[k], 1.0e-9);
+  EXPECT_NEAR(volume(a), volume(b), 1.0e-9);
+}
+}
+
+TEST(DocumentParallelRecompute, MatchesSequentialResults)
+{
+  Document seq;
+  Document par;
+  par.setParallelRecompute(true);
+  const auto seqLeaves = buildBodies(seq, 12, 4);
+  const auto parLeaves = buildBodies(par, 12, 4);
+
+  seq.recompute();
+  par.recompute();
+  ASSERT_EQ(seqLeaves.size(), parLeaves.size());
+  for (std::size_t i = 0; i < seqLeaves.size(); ++i)
+  {
+    ASSERT_FALSE(parLeaves[i]->shape().IsNull());
+    expectSameResult(seqLeaves[i]->shape(), parLeaves[i]->shape());
+  }
+
+  // Incremental edits on a subset of branches stay consistent as well
+  for (std::size_t i = 0; i < seqLeaves.size(); i += 3)
+  {
+    Handle(MoveFeature)::DownCast(seqLeaves[i])->setTranslation(5.0, 5.0, 5.0);
+    Handle(MoveFeature)::DownCast(parLeaves[i])->setTranslation(5.0, 5.0, 5.0);
+  }
+  seq.recompute();
+  par.recompute();
+  for (std::size_t i = 0; i < seqLeaves.size(); ++i)
+  {
+    expectSameResult(seqLeaves[i]->shape(), parLeaves[i]->shape());
+    EXPECT_FALSE(parLeaves[i]->isDirty());
+  }
+}
+
+TEST(DocumentParallelRecompute, PartitionSeparatesIndependentBranches)
+{
+  Document doc;
+  const auto leaves = buildBodies(doc, 3, 2);
+
+  std::vector<DocumentItem::Id> ids;
+  for (const Handle(Feature)& f : doc.features()) ids.push_back(f->id());
+  // features() exposes bodies and their moves: 3 independent groups of 3
+  const auto groups = doc.dependencies().partition(ids);
+  ASSERT_EQ(groups.size(), 3u);
+  for (const auto& g : groups) EXPECT_EQ(g.size(), 3u);
+  EXPECT_EQ(groups[0].back(), leaves[0]->id());
+}
+
+namespace {
+class CountingBox : public BoxFeature
+{
+public:
+  using BoxFeature::BoxFeature;
+  void execute() override { ++calls; BoxFeature::execute(); }
+  std::atomic<int> calls{0};
+};
+}
+
+TEST(DocumentParallelRecompute, PartitionWalksThroughEvictedInputs)
+{
+  Document doc;
+  Handle(BoxFeature) box = new BoxFeature(1.0, 2.0, 3.0);
+  doc.addFeature(box);
+  Handle(MoveFeature) ma = new MoveFeature(box->id(), 1.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+  Handle(MoveFeature) mb = new MoveFeature(box->id(), 0.0, 1.0, 0.0, 0.0, 0.0, 0.0);
+  doc.addFeature(ma);
+  doc.addFeature(mb);
+  Handle(MoveFeature) m1 = new MoveFeature(ma->id(), 0.0, 0.0, 1.0, 0.0, 0.0, 0.0);
+  Handle(MoveFeature) m2 = new MoveFeature(mb->id(), 0.0, 0.0, 2.0, 0.0, 0.0, 0.0);
+  doc.addFeature(m1);
+  doc.addFeature(m2);
+
+  const std::vector<DocumentItem::Id> ids{m1->id(), m2->id()};
+  EXPECT_EQ(doc.dependencies().partition(ids).size(), 2u);
+  const auto groups = doc.dependencies().partition(ids, [&](DocumentItem::Id id) { return id == ma->id() || id == mb->id(); });
+  ASSERT_EQ(groups.size(), 1u);
+  EXPECT_EQ(groups[0], ids);
+}
+
+TEST(DocumentParallelRecompute, SharedEvictedInputIsRebuiltOnce)
+{
+  // Box -> Ma -> M1 and Box -> Mb -> M2 with every result evicted: editing both leaves rebuilds
+  // the shared box exactly once, and no leaf sees it half-built
+  Document doc;
+  doc.setParallelRecompute(true);
+  doc.setShapeCache(nullptr);
+  doc.setCheckpointInterval(0);
+  doc.setRetention(Document::Retention::ByteBudget, 0);
+  Handle(CountingBox) box = new CountingBox(1.0, 2.0, 3.0);
+  box->setSuppressed(true);
+  doc.addFeature(box);
+  Handle(MoveFeature) ma = new MoveFeature(box->id(), 1.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+  Handle(MoveFeature) mb = new MoveFeature(box->id(), 0.0, 1.0, 0.0, 0.0, 0.0, 0.0);
+  ma->setSuppressed(true);
+  mb->setSuppressed(true);
+  doc.addFeature(ma);
+  doc.addFeature(mb);
+  Handle(MoveFeature) m1 = new MoveFeature(ma->id(), 0.0, 0.0, 1.0, 0.0, 0.0, 0.0);
+  Handle(MoveFeature) m2 = new MoveFeature(mb->id(), 0.0, 0.0, 2.0, 0.0, 0.0, 0.0);
+  doc.addFeature(m1);
+  doc.addFeature(m2);
+  doc.recompute();
+  ASSERT_TRUE(box->isPendingEvaluation());
+
+  std::atomic<int> nullLeaves{0};
+  doc.setFeatureCallback([&](DocumentItem::Id id, std::size_t, std::size_t) {
+    if ((id == m1->id() && m1->currentShape().IsNull()) || (id == m2->id() && m2->currentShape().IsNull()))
+      ++nullLeaves;
+  });
+  for (int round = 1; round <= 20; ++round)
+  {
+    const int calls = box->calls;
+    m1->setTranslation(0.0, 0.0, 1.0 + round);
+    m2->setTranslation(0.0, 0.0, 2.0 + round);
+    doc.recompute();
+    EXPECT_EQ(box->calls, calls + 1);
+    EXPECT_TRUE(box->isPendingEvaluation()); // evicted again by the zero budget
+  }
+  EXPECT_EQ(nullLeaves, 0);
+  EXPECT_FALSE(m1->shape().IsNull());
+  EXPECT_FALSE(m2->shape().IsNull());
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <Document.h>
+#include <BoxFeature.h>
+#include <MoveFeature.h>
+
+namespace {
+class CountingBox : public BoxFeature
+{
+public:
+  using BoxFeature::BoxFeature;
+  void execute() override { ++calls; BoxFeature::execute(); }
+  int calls = 0;
+};
+
+struct Chain
+{
+  Handle(CountingBox) box;
+  Handle(MoveFeature) mid;
+  Handle(MoveFeature) leaf;
+};
+
+// Box -> Move -> Move with hidden intermediates, as in the Move stress workflow
+Chain addChain(Document& doc)
+{
+  Chain c;
+  c.box = new CountingBox(1.0, 2.0, 3.0);
+  c.mid = new MoveFeature(c.box->id(), 1.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+  c.leaf = new MoveFeature(c.mid->id(), 0.0, 1.0, 0.0, 0.0, 0.0, 0.0);
+  c.box->setSuppressed(true);
+  c.mid->setSuppressed(true);
+  doc.addFeature(c.box);
+  doc.addFeature(c.mid);
+  doc.addFeature(c.leaf);
+  return c;
+}
+}
+
+TEST(DocumentRetention, LeafOrVisibleEvictsHiddenSourcesAndRebuildsOnAccess)
+{
+  Document doc;
+  doc.setShapeCache(nullptr);
+  doc.setCheckpointInterval(0); // rebuilds must come from execution
+  doc.setRetention(Document::Retention::LeafOrVisible);
+  const Chain c = addChain(doc);
+  doc.recompute();
+
+  EXPECT_FALSE(c.leaf->currentShape().IsNull());
+  EXPECT_TRUE(c.box->currentShape().IsNull());
+  EXPECT_TRUE(c.mid->currentShape().IsNull());
+  const Document::MemoryStats stats = doc.memoryStats();
+  EXPECT_EQ(stats.evictedCount, 2u);
+  std::size_t sum = 0;
+  for (const auto& e : stats.features)
+  {
+    sum += e.bytes;
+    if (e.id == c.box->id()) EXPECT_TRUE(e.evicted);
+    if (e.id == c.leaf->id()) EXPECT_GT(e.bytes, 0u);
+  }
+  EXPECT_EQ(sum, stats.retainedBytes);
+
+  // Transparent rebuild: the evicted source executes again, nothing is marked dirty
+  EXPECT_EQ(c.box->calls, 1);
+  EXPECT_FALSE(c.mid->shape().IsNull());
+  EXPECT_EQ(c.box->calls, 2);
+  EXPECT_FALSE(c.mid->isDirty());
+
+  // A downstream edit pulls the evicted source through Move::execute()
+  c.leaf->setTranslation(5.0, 0.0, 0.0);
+  doc.recompute();
+  EXPECT_FALSE(c.leaf->currentShape().IsNull());
+  EXPECT_EQ(doc.memoryStats().evictedCount, 2u);
+}
+
+TEST(DocumentRetention, ByteBudgetEvictsIntermediatesFirst)
+{
+  Document doc;
+  const Chain c = addChain(doc);
+  doc.recompute();
+  const std::size_t leafBytes = ShapeCache::estimateBytes(c.leaf->currentShape());
+
+  doc.setRetention(Document::Retention::ByteBudget, leafBytes);
+  c.leaf->setRotation(0.0, 0.0, 10.0);
+  doc.recompute();
+  EXPECT_FALSE(c.leaf->currentShape().IsNull());
+  EXPECT_TRUE(c.box->currentShape().IsNull());
+  EXPECT_TRUE(c.mid->currentShape().IsNull());
+
+  // A zero budget drops leaves as well; results come back from the result cache
+  doc.setRetention(Document::Retention::ByteBudget, 0);
+  c.leaf->setRotation(0.0, 0.0, 20.0);
+  doc.recompute();
+  EXPECT_TRUE(c.leaf->currentShape().IsNull());
+  const int calls = c.box->calls;
+  EXPECT_FALSE(c.leaf->shape().IsNull());
+  EXPECT_EQ(c.box->calls, calls);
+  EXPECT_EQ(doc.memoryStats().evictedCount, 2u);
+}
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include <Document.h>
+#include <BoxFeature.h>
+#include <MoveFeature.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+std::size_t indexOf(const DocumentSnapshot& s, DocumentItem::Id id)
+{
+  for (std::size_t i = 0; i < s.size(); ++i)
+  {
+    if (s.at(i).id == id) return i;
+  }
+  return s.size();
+}
+}
+
+TEST(DocumentSnapshot, UnchangedDocumentReturnsSameSnapshot)
+{
+  Document doc;
+  Handle(BoxFeature) box = new BoxFeature(1.0, 2.0, 3.0);
+  doc.addFeature(box);
+  doc.recompute();
+
+  auto s1 = doc.snapshot();
+  auto s2 = doc.snapshot();
+  EXPECT_EQ(s1, s2);
+  ASSERT_NE(s1->find(box->id()), nullptr);
+  EXPECT_FALSE(s1->find(box->id())->shape.IsNull());
+  EXPECT_FALSE(s1->find(box->id())->dirty);
+  EXPECT_EQ(s1->size(), static_cast<std::size_t>(doc.items().Size()));
+}
+
+TEST(DocumentSnapshot, EditRebuildsOnlyChangedItems)
+{
+  Document doc;
+  std::vector<Handle(BoxFeature)> boxes;
+  for (int i = 0; i < 200; ++i)
+  {
+    boxes.push_back(new BoxFeature(1.0 + i, 1.0, 1.0));
+    doc.addFeature(boxes.back());
+  }
+  doc.recompute();
+  auto before = doc.snapshot();
+  const std::string oldData = before->find(boxes[10]->id())->data;
+
+  boxes[10]->setDx(50.0);
+  doc.recompute();
+  auto after = doc.snapshot();
+
+  EXPECT_EQ(after->version(), before->version() + 1);
+  EXPECT_EQ(after->builtItems(), 1u);
+  EXPECT_NE(after->find(boxes[10]->id())->data, oldData);
+  // The earlier snapshot is untouched
+  EXPECT_EQ(before->find(boxes[10]->id())->data, oldData);
+  // Unchanged records are shared, not copied
+  const std::size_t other = indexOf(*after, boxes[150]->id());
+  EXPECT_EQ(after->itemPtr(other), before->itemPtr(other));
+}
+
+TEST(DocumentSnapshot, StructureChangeReusesRecords)
+{
+  Document doc;
+  Handle(BoxFeature) a = new BoxFeature(1.0, 1.0, 1.0);
+  Handle(BoxFeature) b = new BoxFeature(2.0, 2.0, 2.0);
+  doc.addFeature(a);
+  doc.addFeature(b);
+  doc.recompute();
+  auto before = doc.snapshot();
+
+  doc.removeFeature(a);
+  auto after = doc.snapshot();
+  EXPECT_EQ(after->size(), before->size() - 1);
+  EXPECT_EQ(after->find(a->id()), nullptr);
+  EXPECT_EQ(after->builtItems(), 0u);
+  EXPECT_EQ(after->itemPtr(indexOf(*after, b->id())), before->itemPtr(indexOf(*before, b->id())));
+
+  // Detached items no longer report to the document
+  a->setDx(3.0);
+  EXPECT_EQ(doc.snapshot(), after);
+}
+
+TEST(DocumentSnapshot, NameAndSuppressionAreVisible)
+{
+  Document doc;
+  Handle(BoxFeature) box = new BoxFeature(1.0, 1.0, 1.0);
+  doc.addFeature(box);
+  doc.recompute();
+  doc.snapshot();
+
+  box->setName("Body");
+  box->setSuppressed(true);
+  auto s = doc.snapshot();
+  EXPECT_EQ(s->find(box->id())->name, "Body");
+  EXPECT_TRUE(s->find(box->id())->suppressed);
+}
+
+TEST(DocumentSnapshot, ReadersOnOtherThreadsSeeConsistentVersions)
+{
+  Document doc;
+  Handle(BoxFeature) box = new BoxFeature(1.0, 1.0, 1.0);
+  Handle(MoveFeature) mv = new MoveFeature(box->id(), 1.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+  doc.addFeature(box);
+  doc.addFeature(mv);
+  doc.recompute();
+
+  std::shared_ptr<const DocumentSnapshot> published = doc.snapshot();
+  std::atomic<bool> stop{false};
+  std::atomic<int>  regressions{0};
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 4; ++r)
+  {
+    readers.emplace_back([&] {
+      std::uint64_t last = 0;
+      while (!stop)
+      {
+        auto s = std::atomic_load(&published);
+        if (s->version() < last) ++regressions;
+        last = s->version();
+        for (std::size_t i = 0; i < s->size(); ++i)
+        {
+          const DocumentSnapshot::Item& it = s->at(i);
+          if (it.id == 0) ++regressions;
+          TopoDS_Shape held = it.shape; // shares the result with the writer
+        }
+      }
+    });
+  }
+  for (int i = 0; i < 100; ++i)
+  {
+    box->setDx(1.0 + i);
+    doc.recompute();
+    std::atomic_store(&published, doc.snapshot());
+  }
+  stop = true;
+  for (auto& t : readers) t.join();
+  EXPECT_EQ(regressions.load(), 0);
+  EXPECT_FALSE(published->find(mv->id())->shape.IsNull());
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include <Document.h>
+#include <BoxFeature.h>
+#include <MoveFeature.h>
+
+#include <vector>
+
+namespace {
+class CountingMove : public MoveFeature
+{
+public:
+  using MoveFeature::MoveFeature;
+  void execute() override { ++calls; MoveFeature::execute(); }
+  int calls = 0;
+};
+}
+
+TEST(DocumentTransaction, CommitRunsOneRecomputeAndOneNotification)
+{
+  Document doc;
+  Handle(BoxFeature) box = new BoxFeature(1.0, 2.0, 3.0);
+  Handle(CountingMove) mv = new CountingMove(box->id(), 0.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+  doc.addFeature(box);
+  doc.addFeature(mv);
+  doc.recompute();
+
+  std::vector<Document::Change> changes;
+  const int token = doc.addChangeListener([&](const Document::Change& c) { changes.push_back(c); });
+  mv->calls = 0;
+  {
+    Document::Transaction tx(doc);
+    mv->setTranslation(5.0, 0.0, 0.0);
+    doc.recompute(); // deferred
+    mv->setTranslation(5.0, 5.0, 0.0);
+    doc.recompute();
+    mv->setRotation(0.0, 0.0, 5.0);
+    doc.recompute();
+    box->setDx(4.0);
+    EXPECT_TRUE(doc.inTransaction());
+    EXPECT_EQ(mv->calls, 0);
+    EXPECT_TRUE(changes.empty());
+    tx.commit();
+  }
+  EXPECT_FALSE(doc.inTransaction());
+  EXPECT_EQ(mv->calls, 1);
+  ASSERT_EQ(changes.size(), 1u);
+  EXPECT_EQ(changes[0].recomputed, (std::vector<DocumentItem::Id>{box->id(), mv->id()}));
+  EXPECT_FALSE(changes[0].structure);
+
+  // The whole transaction is one undo step
+  ASSERT_TRUE(doc.undo());
+  EXPECT_DOUBLE_EQ(mv->tx(), 0.0);
+  EXPECT_DOUBLE_EQ(mv->rzDeg(), 0.0);
+  EXPECT_DOUBLE_EQ(box->dx(), 1.0);
+  ASSERT_TRUE(doc.redo());
+  EXPECT_DOUBLE_EQ(mv->ty(), 5.0);
+  EXPECT_DOUBLE_EQ(box->dx(), 4.0);
+
+  doc.removeChangeListener(token);
+  doc.setParam(box, Feature::ParamKey::Dy, 1.0);
+  doc.recompute();
+  EXPECT_EQ(changes.size(), 1u);
+}
+
+TEST(DocumentTransaction, ScopeExitRollsBackJournaledEdits)
+{
+  Document doc;
+  Handle(BoxFeature) box = new BoxFeature(1.0, 2.0, 3.0);
+  Handle(MoveFeature) mv = new MoveFeature(box->id(), 1.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+  doc.addFeature(box);
+  doc.addFeature(mv);
+  doc.recompute();
+  const std::size_t steps = doc.journal().undoCount();
+  const int size = doc.items().Size();
+
+  int notified = 0;
+  doc.addChangeListener([&](const Document::Change&) { ++notified; });
+  {
+    Document::Transaction tx(doc);
+    mv->setTranslation(4.0, 5.0, 6.0);
+    mv->setRotation(0.0, 90.0, 0.0);
+    mv->setTranslation(7.0, 8.0, 9.0);
+    box->setDz(7.0);
+    box->setSuppressed(true);
+    doc.addFeature(new BoxFeature(1.0, 1.0, 1.0));
+  }
+  EXPECT_DOUBLE_EQ(mv->tx(), 1.0);
+  EXPECT_DOUBLE_EQ(mv->ty(), 0.0);
+  EXPECT_DOUBLE_EQ(mv->tz(), 0.0);
+  EXPECT_DOUBLE_EQ(mv->ryDeg(), 0.0);
+  EXPECT_DOUBLE_EQ(box->dz(), 3.0);
+  EXPECT_FALSE(box->isSuppressed());
+  EXPECT_EQ(doc.items().Size(), size);
+  EXPECT_EQ(doc.journal().undoCount(), steps);
+  EXPECT_FALSE(doc.journal().canRedo());
+  EXPECT_EQ(notified, 0);
+}
+
+TEST(DocumentTransaction, NestedRollbackKeepsOuterEdits)
+{
+  Document doc;
+  Handle(BoxFeature) box = new BoxFeature(1.0, 2.0, 3.0);
+  doc.addFeature(box);
+  doc.recompute();
+
+  doc.beginTransaction();
+  box->setDx(10.0);
+  doc.beginTransaction();
+  box->setDy(20.0);
+  box->setDx(30.0); // not folded into the outer transaction's edit
+  doc.rollback();
+  EXPECT_TRUE(doc.inTransaction());
+  doc.commit();
+
+  EXPECT_DOUBLE_EQ(box->dx(), 10.0);
+  EXPECT_DOUBLE_EQ(box->dy(), 2.0);
+  EXPECT_FALSE(box->isDirty());
+  ASSERT_TRUE(doc.undo());
+  EXPECT_DOUBLE_EQ(box->dx(), 1.0);
+}
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <Document.h>
+#include <BoxFeature.h>
+#include <MoveFeature.h>
+
+namespace {
+class CountingBox : public BoxFeature
+{
+public:
+  using BoxFeature::BoxFeature;
+  void execute() override { ++calls; BoxFeature::execute(); }
+  int calls = 0;
+};
+}
+
+TEST(DocumentUndo, ParamEditsCoalesceAndUndoReRunsOnlyAffectedItems)
+{
+  Document doc;
+  doc.setShapeCache(nullptr);
+  Handle(CountingBox) a = new CountingBox(1.0, 1.0, 1.0);
+  Handle(CountingBox) b = new CountingBox(2.0, 2.0, 2.0);
+  doc.addFeature(a);
+  doc.addFeature(b);
+  doc.recompute();
+  const std::size_t steps = doc.journal().undoCount();
+
+  // A drag: three edits of Dx become one undo step
+  for (double dx : {1.5, 2.0, 2.5}) doc.setParam(a, Feature::ParamKey::Dx, dx);
+  doc.journal().closeGroup();
+  doc.setParam(a, Feature::ParamKey::Dy, 4.0);
+  EXPECT_EQ(doc.journal().undoCount(), steps + 2);
+  doc.recompute();
+
+  a->calls = b->calls = 0;
+  ASSERT_TRUE(doc.undo());
+  EXPECT_DOUBLE_EQ(a->dy(), 1.0);
+  ASSERT_TRUE(doc.undo());
+  EXPECT_DOUBLE_EQ(a->dx(), 1.0);
+  doc.recompute();
+  EXPECT_EQ(a->calls, 1);
+  EXPECT_EQ(b->calls, 0);
+
+  ASSERT_TRUE(doc.redo());
+  EXPECT_DOUBLE_EQ(a->dx(), 2.5);
+  EXPECT_TRUE(doc.journal().canRedo());
+  doc.setParam(b, Feature::ParamKey::Dz, 9.0); // new edit drops the redo branch
+  EXPECT_FALSE(doc.journal().canRedo());
+}
+
+TEST(DocumentUndo, StructureAndSuppressionRoundtrip)
+{
+  Document doc;
+  EXPECT_FALSE(doc.journal().canUndo()); // default datum items are not history
+  Handle(BoxFeature) box = new BoxFeature(1.0, 2.0, 3.0);
+  Handle(MoveFeature) mv = new MoveFeature(box->id(), 1.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+  doc.addFeature(box);
+  doc.addFeature(mv);
+  doc.setSuppressed(box, true);
+  doc.recompute();
+  const int boxIndex = doc.items().indexOf(box->id());
+
+  doc.removeFeature(box);
+  EXPECT_FALSE(doc.items().contains(box->id()));
+  ASSERT_TRUE(doc.undo());
+  EXPECT_EQ(doc.items().indexOf(box->id()), boxIndex);
+
+  ASSERT_TRUE(doc.undo());
+  EXPECT_FALSE(box->isSuppressed());
+  ASSERT_TRUE(doc.undo());
+  EXPECT_FALSE(doc.items().contains(mv->id()));
+  EXPECT_TRUE(mv->shape().IsNull()); // parked items do not keep results
+
+  ASSERT_TRUE(doc.redo());
+  EXPECT_TRUE(doc.items().contains(mv->id()));
+  EXPECT_TRUE(mv->isDirty());
+  doc.recompute();
+  EXPECT_FALSE(mv->shape().IsNull());
+}
+
+TEST(DocumentUndo, MemoryCapDropsOldestSteps)
+{
+  Document doc;
+  Handle(BoxFeature) box = new BoxFeature(1.0, 1.0, 1.0);
+  doc.addFeature(box);
+  doc.journal().setBudget(4 * sizeof(UndoJournal::Command));
+  for (int i = 0; i < 100; ++i)
+  {
+    doc.setParam(box, Feature::ParamKey::Dx, 1.0 + i);
+    doc.journal().closeGroup();
+  }
+  EXPECT_LE(doc.journal().bytes(), doc.journal().budget());
+  EXPECT_EQ(doc.journal().undoCount(), 4u);
+  while (doc.undo()) {}
+  EXPECT_DOUBLE_EQ(box->dx(), 96.0); // the four newest steps were kept
+}
+
+TEST(DocumentUndo, TypedSettersAreJournaled)
+{
+  Document doc;
+  Handle(BoxFeature) box = new BoxFeature(1.0, 2.0, 3.0);
+  Handle(MoveFeature) mv = new MoveFeature(box->id(), 1.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+  doc.addFeature(box);
+  doc.addFeature(mv);
+  doc.recompute();
+
+  box->setDx(5.0);
+  doc.journal().closeGroup();
+  mv->setTranslation(4.0, 5.0, 6.0); // three parameters, one undo step
+  box->setSuppressed(true);
+
+  ASSERT_TRUE(doc.undo());
+  EXPECT_FALSE(box->isSuppressed());
+  ASSERT_TRUE(doc.undo());
+  EXPECT_DOUBLE_EQ(mv->tx(), 1.0);
+  EXPECT_DOUBLE_EQ(mv->ty(), 0.0);
+  EXPECT_DOUBLE_EQ(mv->tz(), 0.0);
+  EXPECT_DOUBLE_EQ(box->dx(), 5.0);
+  ASSERT_TRUE(doc.undo());
+  EXPECT_DOUBLE_EQ(box->dx(), 1.0);
+
+  ASSERT_TRUE(doc.redo());
+  ASSERT_TRUE(doc.redo());
+  EXPECT_DOUBLE_EQ(mv->tx(), 4.0);
+  EXPECT_DOUBLE_EQ(mv->tz(), 6.0);
+  EXPECT_FALSE(box->isSuppressed());
+
+  // Removed features are parked in the journal; editing them is not history
+  doc.removeFeature(mv);
+  const std::size_t commands = doc.journal().undoCount();
+  mv->setRotation(0.0, 0.0, 45.0);
+  EXPECT_EQ(doc.journal().undoCount(), commands);
+}
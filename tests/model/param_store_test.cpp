@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <BoxFeature.h>
+#include <PlaneFeature.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using Key = Feature::ParamKey;
+
+TEST(ParamStore, SchemaAssignsSlotsInKeyOrder)
+{
+  const Feature::ParamSchema& s = PlaneFeature::kSchema;
+  EXPECT_EQ(s.size, 9u);
+  EXPECT_EQ(s.slot(Key::Ox), 0);
+  EXPECT_EQ(s.slot(Key::Transparency), 8);
+  EXPECT_EQ(s.slot(Key::Dx), -1);
+  EXPECT_EQ(s.typeOf(Key::FixedGeometry, ParamType::Double), ParamType::Int);
+}
+
+TEST(ParamStore, DeclaredAndUndeclaredKeysBehaveLikeAMap)
+{
+  Feature::ParamMap m(BoxFeature::kSchema);
+  EXPECT_TRUE(m.empty());
+  m[Key::Dz] = 3.0;
+  m[Key::Dx] = 1.0;
+  m[Key::Length] = 7;          // not in the box schema: overflow
+  m[Key::Distance] = TCollection_AsciiString("x");
+  EXPECT_EQ(m.size(), 4u);
+  EXPECT_EQ(m.count(Key::Dy), 0u);
+  ASSERT_NE(m.find(Key::Length), m.end());
+  EXPECT_EQ(std::get<int>(m.find(Key::Length)->second), 7);
+
+  // Declared slots first, then overflow, each in key order
+  std::vector<Key> order;
+  for (const auto& kv : m) order.push_back(kv.first);
+  EXPECT_EQ(order, (std::vector<Key>{Key::Dx, Key::Dz, Key::Distance, Key::Length}));
+
+  EXPECT_TRUE(m.erase(Key::Dx));
+  EXPECT_FALSE(m.erase(Key::Dx));
+  EXPECT_TRUE(m.erase(Key::Distance));
+  EXPECT_EQ(m.size(), 2u);
+  m.clear();
+  EXPECT_TRUE(m.empty());
+  EXPECT_EQ(m.begin(), m.end());
+}
+
+TEST(ParamStore, FeatureRoundtripKeepsIntParams)
+{
+  Handle(PlaneFeature) a = new PlaneFeature();
+  a->setSize(50.0);
+  a->setFixedGeometry(true);
+  a->setParam(Key::Dx, 2.5); // undeclared key still round-trips
+
+  Handle(PlaneFeature) b = new PlaneFeature();
+  b->deserialize(a->serialize());
+  EXPECT_TRUE(std::holds_alternative<int>(*b->params().get(Key::FixedGeometry)));
+  EXPECT_TRUE(b->isFixedGeometry());
+  EXPECT_DOUBLE_EQ(b->size(), 50.0);
+  EXPECT_DOUBLE_EQ(std::get<double>(*b->params().get(Key::Dx)), 2.5);
+  EXPECT_EQ(a->contentHash(), b->contentHash());
+}
+
+TEST(ParamStore, OverflowKeysStaySortedInAnyInsertOrder)
+{
+  Feature::ParamMap m(BoxFeature::kSchema);
+  const std::vector<Key> keys{Key::Transparency, Key::Ox, Key::Length, Key::Distance, Key::Nz, Key::Radius};
+  for (std::size_t i = 0; i < keys.size(); ++i) m[keys[i]] = static_cast<int>(i);
+  for (std::size_t i = 0; i < keys.size(); ++i)
+  {
+    ASSERT_NE(m.get(keys[i]), nullptr);
+    EXPECT_EQ(std::get<int>(*m.get(keys[i])), static_cast<int>(i));
+  }
+  std::vector<Key> order;
+  for (const auto& kv : m) order.push_back(kv.first);
+  EXPECT_TRUE(std::is_sorted(order.begin(), order.end()));
+  EXPECT_EQ(order.size(), keys.size());
+  EXPECT_TRUE(m.erase(Key::Length));
+  EXPECT_EQ(m.get(Key::Length), nullptr);
+  EXPECT_NE(m.get(Key::Nz), nullptr);
+}
+
+TEST(ParamStore, DeclaredSlotsKeepTheirSchemaType)
+{
+  Handle(PlaneFeature) p = new PlaneFeature();
+  p->setSize(50.0);
+  EXPECT_TRUE(p->setParam(Key::Size, 80));                     // int widens into a Double slot
+  EXPECT_TRUE(std::holds_alternative<double>(*p->params().get(Key::Size)));
+  EXPECT_DOUBLE_EQ(p->size(), 80.0);
+  EXPECT_FALSE(p->setParam(Key::Size, TCollection_AsciiString("big")));
+  EXPECT_FALSE(p->setParam(Key::FixedGeometry, 0.5));
+  EXPECT_DOUBLE_EQ(p->size(), 80.0);
+  EXPECT_FALSE(p->params().contains(Key::FixedGeometry));
+  EXPECT_TRUE(p->setParam(Key::Dx, TCollection_AsciiString("free"))); // undeclared: any type
+
+  // Loading drops values their declared slot cannot hold
+  Handle(PlaneFeature) q = new PlaneFeature();
+  q->deserialize("name=p\ns_" + std::to_string(static_cast<int>(Key::Size)) + "=big\n");
+  EXPECT_FALSE(q->params().contains(Key::Size));
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include <Document.h>
+#include <BoxFeature.h>
+#include <MoveFeature.h>
+
+TEST(RecomputeProfile, RecordsOneSamplePerExecutedFeature)
+{
+  Document doc;
+  doc.setProfiling(true);
+  Handle(BoxFeature) box = new BoxFeature(1.0, 2.0, 3.0);
+  box->setName("Base");
+  Handle(MoveFeature) mv = new MoveFeature();
+  mv->setSource(box);
+  mv->setTranslation(1.0, 0.0, 0.0);
+  doc.addFeature(box);
+  doc.addFeature(mv);
+  doc.recompute();
+
+  const RecomputeProfile& p = doc.lastRecomputeProfile();
+  ASSERT_EQ(p.samples.size(), 2u);
+  EXPECT_EQ(p.samples[0].id, box->id());
+  EXPECT_EQ(p.samples[0].kind, DocumentItem::Kind::BoxFeature);
+  EXPECT_EQ(p.samples[0].name, "Base");
+  EXPECT_EQ(p.samples[1].id, mv->id());
+  for (const auto& s : p.samples)
+  {
+    EXPECT_EQ(s.source, RecomputeProfile::Source::Executed);
+    EXPECT_EQ(s.thread, 0); // sequential recompute stays on the calling thread
+    EXPECT_GE(s.durationUs, 0.0);
+    EXPECT_LE(s.startUs + s.durationUs, p.totalUs);
+  }
+  EXPECT_GE(p.totalUs, p.planUs);
+
+  const std::string trace = p.toChromeTrace();
+  EXPECT_NE(trace.find("\"traceEvents\""), std::string::npos);
+  EXPECT_NE(trace.find("\"name\":\"Base\""), std::string::npos);
+  EXPECT_NE(trace.find("\"cat\":\"Move\""), std::string::npos);
+
+  // Nothing dirty: nothing to profile
+  doc.recompute();
+  EXPECT_TRUE(doc.lastRecomputeProfile().empty());
+
+  // Reverted edit is served from the memory cache and reported as such
+  box->setSize(2.0, 2.0, 3.0);
+  doc.recompute();
+  box->setSize(1.0, 2.0, 3.0);
+  doc.recompute();
+  ASSERT_EQ(doc.lastRecomputeProfile().samples.size(), 2u);
+  EXPECT_EQ(doc.lastRecomputeProfile().samples[0].source, RecomputeProfile::Source::MemoryCache);
+}
+
+TEST(RecomputeProfile, DisabledByDefault)
+{
+  Document doc;
+  doc.addFeature(new BoxFeature(1.0, 1.0, 1.0));
+  doc.recompute();
+  EXPECT_TRUE(doc.lastRecomputeProfile().empty());
+}
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include <Document.h>
+#include <BoxFeature.h>
+#include <MoveFeature.h>
+#include <ShapeCache.h>
+#include <DiskShapeCache.h>
+
+#include <BRepPrimAPI_MakeBox.hxx>
+
+#include <filesystem>
+
+namespace {
+class CountingBox : public BoxFeature
+{
+public:
+  using BoxFeature::BoxFeature;
+  void execute() override { ++calls; BoxFeature::execute(); }
+  int calls = 0;
+};
+
+// Same kind and inputs, newer execute()
+class RevisedBox : public CountingBox
+{
+public:
+  using CountingBox::CountingBox;
+  std::uint32_t algorithmVersion() const override { return CountingBox::algorithmVersion() + 1; }
+};
+
+class CountingMove : public MoveFeature
+{
+public:
+  void execute() override { ++calls; MoveFeature::execute(); }
+  int calls = 0;
+};
+}
+
+TEST(ShapeCache, RevertedParamEditIsServedFromCache)
+{
+  Document doc;
+  Handle(CountingBox) box = new CountingBox(10.0, 10.0, 10.0);
+  Handle(CountingMove) mv = new CountingMove();
+  mv->setSource(box);
+  mv->setTranslation(5.0, 0.0, 0.0);
+  doc.addFeature(box);
+  doc.addFeature(mv);
+  doc.recompute();
+  ASSERT_EQ(box->calls, 1);
+  ASSERT_EQ(mv->calls, 1);
+
+  box->setSize(20.0, 10.0, 10.0);
+  doc.recompute();
+  EXPECT_EQ(box->calls, 2);
+  EXPECT_EQ(mv->calls, 2);
+
+  // Back to the original inputs: both results come from the cache
+  const auto before = doc.shapeCache()->stats();
+  box->setSize(10.0, 10.0, 10.0);
+  doc.recompute();
+  EXPECT_EQ(box->calls, 2);
+  EXPECT_EQ(mv->calls, 2);
+  EXPECT_FALSE(mv->shape().IsNull());
+  const auto after = doc.shapeCache()->stats();
+  EXPECT_EQ(after.hits - before.hits, 2u);
+  EXPECT_EQ(after.misses, before.misses);
+}
+
+TEST(ShapeCache, DisabledCacheAlwaysExecutes)
+{
+  Document doc;
+  doc.setShapeCache(nullptr);
+  Handle(CountingBox) box = new CountingBox(1.0, 1.0, 1.0);
+  doc.addFeature(box);
+  doc.recompute();
+  box->setSize(2.0, 1.0, 1.0);
+  doc.recompute();
+  box->setSize(1.0, 1.0, 1.0);
+  doc.recompute();
+  EXPECT_EQ(box->calls, 3);
+}
+
+TEST(ShapeCache, EvictsLeastRecentlyUsedOverBudget)
+{
+  const TopoDS_Shape a = BRepPrimAPI_MakeBox(1.0, 1.0, 1.0).Shape();
+  const TopoDS_Shape b = BRepPrimAPI_MakeBox(2.0, 1.0, 1.0).Shape();
+  const TopoDS_Shape c = BRepPrimAPI_MakeBox(3.0, 1.0, 1.0).Shape();
+  const std::size_t one = ShapeCache::estimateBytes(a);
+
+  ShapeCache cache(2 * one);
+  cache.insert(1, a);
+  cache.insert(2, b);
+  TopoDS_Shape out;
+  ASSERT_TRUE(cache.find(1, out)); // 1 becomes most recent
+  cache.insert(3, c);              // evicts 2
+
+  EXPECT_TRUE(cache.find(1, out));
+  EXPECT_FALSE(cache.find(2, out));
+  EXPECT_TRUE(cache.find(3, out));
+  const ShapeCache::Stats s = cache.stats();
+  EXPECT_EQ(s.entries, 2u);
+  EXPECT_EQ(s.evictions, 1u);
+  EXPECT_EQ(s.hits, 3u);
+  EXPECT_EQ(s.misses, 1u);
+}
+
+TEST(DiskShapeCache, ReopenedDocumentLoadsResultsInsteadOfExecuting)
+{
+  const std::filesystem::path docFile = std::filesystem::temp_directory_path() / "vibecad_disk_cache_test.vcad";
+  auto disk = std::make_shared<DiskShapeCache>(DiskShapeCache::directoryFor(docFile));
+  disk->clear();
+
+  {
+    Document doc;
+    doc.setDiskCache(disk);
+    Handle(CountingBox) box = new CountingBox(4.0, 5.0, 6.0);
+    doc.addFeature(box);
+    doc.recompute();
+    EXPECT_EQ(box->calls, 1);
+  }
+  EXPECT_EQ(disk->stats().writes, 1u);
+
+  // Fresh document and memory cache: the result comes from disk
+  Document reopened;
+  reopened.setDiskCache(disk);
+  Handle(CountingBox) box = new CountingBox(4.0, 5.0, 6.0);
+  reopened.addFeature(box);
+  reopened.recompute();
+  EXPECT_EQ(box->calls, 0);
+  EXPECT_FALSE(box->shape().IsNull());
+  EXPECT_EQ(disk->stats().hits, 1u);
+
+  // A different input misses and executes
+  box->setSize(4.0, 5.0, 7.0);
+  reopened.recompute();
+  EXPECT_EQ(box->calls, 1);
+
+  // So does a newer algorithm for the same kind and inputs
+  Document upgraded;
+  upgraded.setDiskCache(disk);
+  Handle(RevisedBox) revised = new RevisedBox(4.0, 5.0, 6.0);
+  upgraded.addFeature(revised);
+  upgraded.recompute();
+  EXPECT_EQ(revised->calls, 1);
+
+  disk->clear();
+  std::filesystem::remove(disk->directory());
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <Timeline.h>
+#include <BoxFeature.h>
+#include <Document.h>
+#include <MoveFeature.h>
+#include <PlaneFeature.h>
+
+namespace {
+Handle(DocumentItem) box() { return new BoxFeature(1.0, 1.0, 1.0); }
+}
+
+TEST(Timeline, IdAndPositionLookupsFollowEdits)
+{
+  Timeline t;
+  Handle(DocumentItem) a = box();
+  Handle(DocumentItem) b = box();
+  Handle(DocumentItem) c = box();
+  t.append(a);
+  t.append(c);
+  t.insert(2, b);
+
+  ASSERT_EQ(t.Size(), 3);
+  EXPECT_TRUE(t.Value(2) == b);
+  EXPECT_EQ(t.indexOf(a->id()), 1);
+  EXPECT_EQ(t.indexOf(b->id()), 2);
+  EXPECT_EQ(t.indexOf(c->id()), 3);
+  EXPECT_TRUE(t.find(c->id()) == c);
+
+  t.removeAt(1);
+  EXPECT_FALSE(t.contains(a->id()));
+  EXPECT_EQ(t.indexOf(a->id()), 0);
+  EXPECT_EQ(t.indexOf(b->id()), 1);
+  EXPECT_EQ(t.indexOf(c->id()), 2);
+
+  // Out-of-range insert clamps to the ends
+  t.insert(0, a);
+  EXPECT_EQ(t.indexOf(a->id()), 1);
+  EXPECT_EQ(t.indexOf(c->id()), 3);
+
+  int n = 0;
+  for (const Handle(DocumentItem)& it : t) n += it.IsNull() ? 0 : 1;
+  EXPECT_EQ(n, 3);
+
+  t.clear();
+  EXPECT_TRUE(t.IsEmpty());
+  EXPECT_TRUE(t.find(b->id()).IsNull());
+}
+
+TEST(Timeline, RepeatedIdsKeepLatestMapping)
+{
+  Timeline t;
+  Handle(Feature) a = new BoxFeature(1.0, 1.0, 1.0);
+  Handle(Feature) copy = new BoxFeature(*Handle(BoxFeature)::DownCast(a)); // same id
+  ASSERT_EQ(a->id(), copy->id());
+  t.append(a);
+  t.append(box());
+  t.append(copy);
+
+  EXPECT_TRUE(t.find(a->id()) == copy);
+  EXPECT_EQ(t.indexOf(a->id()), 3);
+  t.removeAt(3);
+  EXPECT_TRUE(t.find(a->id()) == a);
+  EXPECT_EQ(t.indexOf(a->id()), 1);
+  t.removeAt(1);
+  EXPECT_FALSE(t.contains(a->id()));
+}
+
+TEST(Timeline, KindIndexFollowsHistoryOrder)
+{
+  Document doc;
+  const std::size_t planes = doc.itemsOfKind<PlaneFeature>().size(); // default datum planes
+  Handle(BoxFeature) a = new BoxFeature(1.0, 1.0, 1.0);
+  Handle(BoxFeature) b = new BoxFeature(2.0, 1.0, 1.0);
+  Handle(MoveFeature) m = new MoveFeature(a->id(), 1.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+  doc.addFeature(a);
+  doc.addFeature(m);
+  doc.insertItem(doc.items().indexOf(m->id()), b); // a, b, m
+
+  std::vector<Handle(BoxFeature)> boxes = doc.itemsOfKind<BoxFeature>();
+  ASSERT_EQ(boxes.size(), 2u);
+  EXPECT_TRUE(boxes[0] == a);
+  EXPECT_TRUE(boxes[1] == b);
+  EXPECT_EQ(doc.itemsOfKind<MoveFeature>().size(), 1u);
+  EXPECT_EQ(doc.itemsOfKind<PlaneFeature>().size(), planes);
+
+  doc.removeFeature(a);
+  boxes = doc.itemsOfKind<BoxFeature>();
+  ASSERT_EQ(boxes.size(), 1u);
+  EXPECT_TRUE(boxes[0] == b);
+
+  // Many inserts at the same slot exhaust the order gap and force a renumber
+  Timeline t;
+  Handle(DocumentItem) last = new BoxFeature(1.0, 1.0, 1.0);
+  t.append(last);
+  std::vector<Handle(DocumentItem)> inserted;
+  for (int i = 0; i < 64; ++i)
+  {
+    Handle(DocumentItem) it = new BoxFeature(1.0, 1.0, 1.0);
+    t.insert(t.Size(), it); // always just before `last`
+    inserted.push_back(it);
+  }
+  const std::vector<Handle(DocumentItem)>& kinds = t.ofKind(DocumentItem::Kind::BoxFeature);
+  ASSERT_EQ(kinds.size(), 65u);
+  for (int i = 0; i < 64; ++i) EXPECT_TRUE(kinds[static_cast<std::size_t>(i)] == inserted[static_cast<std::size_t>(i)]);
+  EXPECT_TRUE(kinds.back() == last);
+}
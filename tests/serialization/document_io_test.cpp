@@ -0,0 +1,275 @@
+#include <gtest/gtest.h>
+
+#include <Document.h>
+#include <DocumentIO.h>
+#include <BoxFeature.h>
+#include <ExtrudeFeature.h>
+#include <MoveFeature.h>
+#include <Sketch.h>
+
+#include <filesystem>
+#include <sstream>
+#include <vector>
+
+TEST(DocumentIO, RoundtripKeepsTimelineIdsAndLinks)
+{
+  Document doc;
+  Handle(BoxFeature) box = new BoxFeature(1.0, 2.0, 3.0);
+  box->setName(TCollection_AsciiString("Base"));
+  Handle(MoveFeature) mv = new MoveFeature(box->id(), 5.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+  auto sk = std::make_shared<Sketch>();
+  sk->addLine(gp_Pnt2d(0, 0), gp_Pnt2d(10, 0));
+  Handle(ExtrudeFeature) ex = new ExtrudeFeature();
+  ex->setSketchId(sk->id());
+  ex->setDistance(4.0);
+  doc.addFeature(box);
+  doc.addFeature(mv);
+  doc.addSketch(sk);
+  doc.addFeature(ex);
+
+  std::stringstream ss;
+  ASSERT_TRUE(DocumentIO::save(doc, ss));
+  std::string error;
+  std::unique_ptr<Document> loaded = DocumentIO::load(ss, &error);
+  ASSERT_TRUE(loaded) << error;
+
+  ASSERT_EQ(loaded->items().Size(), doc.items().Size());
+  for (int i = 1; i <= doc.items().Size(); ++i)
+  {
+    const Handle(DocumentItem)& a = doc.items().Value(i);
+    const Handle(DocumentItem)& b = loaded->items().Value(i);
+    EXPECT_EQ(a->id(), b->id());
+    EXPECT_EQ(a->kind(), b->kind());
+    EXPECT_EQ(a->serialize(), b->serialize());
+    EXPECT_TRUE(b->isDirty());
+  }
+  ASSERT_NE(loaded->findSketch(sk->id()), nullptr);
+  EXPECT_EQ(loaded->findSketch(sk->id())->serialize(), sk->serialize());
+  EXPECT_FALSE(loaded->journal().canUndo());
+
+  loaded->recompute();
+  Handle(MoveFeature) lmv = Handle(MoveFeature)::DownCast(loaded->items().find(mv->id()));
+  ASSERT_FALSE(lmv.IsNull());
+  EXPECT_FALSE(lmv->shape().IsNull());
+}
+
+TEST(DocumentIO, NewIdsStayAheadOfLoadedOnes)
+{
+  std::stringstream ss;
+  ss << "vibecad-document 1\nitem 100 900000000 0\n\n";
+  std::unique_ptr<Document> loaded = DocumentIO::load(ss);
+  ASSERT_TRUE(loaded);
+  Handle(BoxFeature) fresh = new BoxFeature();
+  EXPECT_GT(fresh->id(), 900000000u);
+}
+
+TEST(DocumentIO, MalformedInputIsRejected)
+{
+  std::string error;
+  std::stringstream bad("not-a-document 1\n");
+  EXPECT_FALSE(DocumentIO::load(bad, &error));
+  EXPECT_FALSE(error.empty());
+
+  std::stringstream truncated("vibecad-document 1\nitem 100 7 50\nname=x\n");
+  EXPECT_FALSE(DocumentIO::load(truncated, &error));
+
+  std::stringstream oversized("vibecad-document 1\nitem 100 7 18446744073709551615\nname=x\n");
+  EXPECT_FALSE(DocumentIO::load(oversized, &error));
+
+  std::stringstream unknown("vibecad-document 1\nitem 999 7 0\n\n");
+  EXPECT_FALSE(DocumentIO::load(unknown, &error));
+
+  // A blob deserialize() rejects is reported, not thrown
+  Sketch sk;
+  sk.addLine(gp_Pnt2d(0, 0), gp_Pnt2d(1, 0));
+  const std::string blob = sk.serialize(Sketch::Encoding::Binary).substr(0, 24);
+  std::stringstream malformed("vibecad-document 1\nsketch 500 " + std::to_string(blob.size()) + "\n" + blob + "\n");
+  error.clear();
+  EXPECT_FALSE(DocumentIO::load(malformed, &error));
+  EXPECT_EQ(error.rfind("malformed item 500: ", 0), 0u) << error;
+}
+
+TEST(DocumentIO, BinaryFileRoundtripAndTextFallback)
+{
+  Document doc;
+  std::vector<Handle(BoxFeature)> boxes;
+  for (int i = 0; i < 1500; ++i) // several parallel decode blocks
+  {
+    boxes.push_back(new BoxFeature(1.0 + i, 2.0, 3.0));
+    doc.addFeature(boxes.back());
+  }
+  boxes[7]->setSuppressed(true);
+  auto sk = std::make_shared<Sketch>();
+  sk->addLine(gp_Pnt2d(0, 0), gp_Pnt2d(10, 0));
+  doc.addSketch(sk);
+
+  const std::filesystem::path dir = std::filesystem::temp_directory_path() / "vibecad_document_io_test";
+  std::filesystem::create_directories(dir);
+  for (DocumentIO::Format format : {DocumentIO::Format::Binary, DocumentIO::Format::Text})
+  {
+    const std::filesystem::path file = dir / "doc.vcad";
+    ASSERT_TRUE(DocumentIO::save(doc, file, format));
+    std::string error;
+    std::unique_ptr<Document> loaded = DocumentIO::load(file, &error);
+    ASSERT_TRUE(loaded) << error;
+    ASSERT_EQ(loaded->items().Size(), doc.items().Size());
+    for (int i = 1; i <= doc.items().Size(); ++i)
+    {
+      EXPECT_EQ(loaded->items().Value(i)->id(), doc.items().Value(i)->id());
+      EXPECT_EQ(loaded->items().Value(i)->serialize(), doc.items().Value(i)->serialize());
+    }
+    ASSERT_NE(loaded->findSketch(sk->id()), nullptr);
+    EXPECT_EQ(loaded->findSketch(sk->id())->serialize(), sk->serialize());
+    EXPECT_FALSE(loaded->journal().canUndo());
+  }
+  std::filesystem::remove_all(dir);
+}
+
+TEST(DocumentIO, CorruptBinaryIsRejected)
+{
+  Document doc;
+  doc.addFeature(new BoxFeature(1.0, 2.0, 3.0));
+  std::stringstream ss;
+  ASSERT_TRUE(DocumentIO::save(doc, ss));
+  const std::string good = ss.str();
+  std::string error;
+
+  std::stringstream truncated(good.substr(0, 40)); // header survives, table does not
+  EXPECT_FALSE(DocumentIO::load(truncated, &error));
+  EXPECT_FALSE(error.empty());
+
+  std::string badOffset = good;
+  badOffset[32 + 16 + 7] = '\x7f'; // first entry's payload offset far past the end
+  std::stringstream s1(badOffset);
+  EXPECT_FALSE(DocumentIO::load(s1, &error));
+
+  std::string badKind = good;
+  badKind[32] = '\x63'; // first entry's kind: 99 is not a kind
+  badKind[33] = '\0';
+  std::stringstream s2(badKind);
+  EXPECT_FALSE(DocumentIO::load(s2, &error));
+}
+
+TEST(DocumentIO, LazyLoadDefersPayloadsUntilFirstAccess)
+{
+  Document doc;
+  Handle(BoxFeature) box = new BoxFeature(1.0, 2.0, 3.0);
+  box->setName(TCollection_AsciiString("Base"));
+  Handle(BoxFeature) hidden = new BoxFeature(4.0, 5.0, 6.0);
+  hidden->setSuppressed(true);
+  auto sk = std::make_shared<Sketch>();
+  for (int i = 0; i < 200; ++i) sk->addLine(gp_Pnt2d(i, 0), gp_Pnt2d(i + 1, 0));
+  Handle(ExtrudeFeature) ex = new ExtrudeFeature();
+  ex->setSketchId(sk->id());
+  ex->setDistance(4.0);
+  doc.addFeature(box);
+  doc.addFeature(hidden);
+  doc.addSketch(sk);
+  doc.addFeature(ex);
+
+  std::stringstream ss;
+  ASSERT_TRUE(DocumentIO::save(doc, ss));
+  std::string error;
+  std::unique_ptr<Document> loaded = DocumentIO::load(ss, &error, DocumentIO::LoadMode::Lazy);
+  ASSERT_TRUE(loaded) << error;
+
+  // History metadata comes from the table of contents
+  Handle(BoxFeature) lbox = Handle(BoxFeature)::DownCast(loaded->items().find(box->id()));
+  Handle(BoxFeature) lhidden = Handle(BoxFeature)::DownCast(loaded->items().find(hidden->id()));
+  ASSERT_FALSE(lbox.IsNull());
+  EXPECT_EQ(lbox->name(), TCollection_AsciiString("Base"));
+  EXPECT_TRUE(lhidden->isSuppressed());
+  for (const Handle(DocumentItem)& di : loaded->items()) EXPECT_FALSE(di->isLoaded());
+
+  // Touching one sketch loads that sketch only
+  std::shared_ptr<Sketch> lsk = loaded->findSketch(sk->id());
+  ASSERT_NE(lsk, nullptr);
+  EXPECT_FALSE(lsk->isLoaded());
+  EXPECT_EQ(lsk->curves().size(), 200u);
+  EXPECT_TRUE(lsk->isLoaded());
+  EXPECT_FALSE(lbox->isLoaded());
+
+  // A header edit before loading survives the payload
+  lbox->setName(TCollection_AsciiString("Renamed"));
+  EXPECT_TRUE(lbox->isLoaded());
+  EXPECT_EQ(lbox->name(), TCollection_AsciiString("Renamed"));
+  EXPECT_DOUBLE_EQ(lbox->dx(), 1.0);
+
+  // Recompute loads the rest and rebuilds the links from the payloads
+  loaded->recompute();
+  for (const Handle(DocumentItem)& di : loaded->items()) EXPECT_TRUE(di->isLoaded());
+  Handle(ExtrudeFeature) lex = Handle(ExtrudeFeature)::DownCast(loaded->items().find(ex->id()));
+  EXPECT_EQ(lex->serialize(), ex->serialize());
+}
+
+TEST(DocumentIO, LazyPayloadsAreNotEditsForAsyncRecompute)
+{
+  Document doc;
+  Handle(BoxFeature) box = new BoxFeature(1.0, 2.0, 3.0);
+  doc.addFeature(box);
+  doc.addFeature(new MoveFeature(box->id(), 1.0, 0.0, 0.0, 0.0, 0.0, 0.0));
+  std::stringstream ss;
+  ASSERT_TRUE(DocumentIO::save(doc, ss));
+  std::string error;
+  std::unique_ptr<Document> loaded = DocumentIO::load(ss, &error, DocumentIO::LoadMode::Lazy);
+  ASSERT_TRUE(loaded) << error;
+
+  // The snapshot loads every payload; publish() must not take that for an edit made meanwhile
+  std::shared_ptr<RecomputeJob> job = loaded->recomputeAsync();
+  job->wait();
+  ASSERT_TRUE(loaded->publish(*job));
+  for (const Handle(DocumentItem)& di : loaded->items())
+  {
+    EXPECT_TRUE(di->isLoaded());
+    EXPECT_FALSE(di->isDirty());
+  }
+}
+
+TEST(DocumentIO, LoadedIdsLeaveTheCounterDeterministic)
+{
+  Document doc;
+  for (int i = 0; i < 1500; ++i) doc.addFeature(new BoxFeature(1.0 + i, 2.0, 3.0)); // several parallel blocks
+  std::stringstream ss;
+  ASSERT_TRUE(DocumentIO::save(doc, ss));
+  std::string bytes = ss.str();
+
+  // Persisted ids far above anything this process has handed out
+  const DocumentItem::Id base = 5000000000000ull;
+  for (std::size_t i = 0; i < 1500; ++i)
+  {
+    const DocumentItem::Id id = base + i;
+    for (int b = 0; b < 8; ++b) bytes[32 + i * 40 + 8 + b] = static_cast<char>((id >> (8 * b)) & 0xFF);
+  }
+  std::stringstream patched(bytes);
+  std::string error;
+  std::unique_ptr<Document> loaded = DocumentIO::load(patched, &error);
+  ASSERT_TRUE(loaded) << error;
+  EXPECT_EQ(loaded->items().Value(1500)->id(), base + 1499);
+
+  Handle(BoxFeature) fresh = new BoxFeature();
+  EXPECT_EQ(fresh->id(), base + 1500); // loading drew no ids of its own
+}
+
+TEST(DocumentIO, FactoryTableCreatesRegisteredKinds)
+{
+  Handle(DocumentItem) box = DocumentItem::create(DocumentItem::Kind::BoxFeature, {42000});
+  ASSERT_FALSE(box.IsNull());
+  EXPECT_EQ(box->id(), 42000u);
+  EXPECT_EQ(box->kind(), DocumentItem::Kind::BoxFeature);
+  Handle(DocumentItem) sk = DocumentItem::create(DocumentItem::Kind::Sketch, {42001});
+  ASSERT_FALSE(sk.IsNull());
+  EXPECT_EQ(sk->kind(), DocumentItem::Kind::Sketch);
+  EXPECT_TRUE(DocumentItem::create(static_cast<DocumentItem::Kind>(999), {42002}).IsNull());
+
+  // Loaders build every stored kind through the table
+  using K = DocumentItem::Kind;
+  DocumentItem::Id id = 42010;
+  for (K k : {K::Sketch, K::BoxFeature, K::CylinderFeature, K::ExtrudeFeature, K::MoveFeature, K::PlaneFeature,
+              K::PointFeature, K::AxeFeature})
+  {
+    Handle(DocumentItem) item = DocumentIO::createItem(k, ++id);
+    ASSERT_FALSE(item.IsNull()) << static_cast<int>(k);
+    EXPECT_EQ(item->kind(), k);
+    EXPECT_EQ(item->id(), id);
+  }
+}
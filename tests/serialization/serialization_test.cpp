@@ -4,6 +4,11 @@
 #include <BoxFeature.h>
 #include <ExtrudeFeature.h>
 
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
 TEST(Serialization, SketchRoundtrip)
 {
   Sketch s;
@@ -62,3 +67,129 @@ TEST(Serialization, ExtrudeSkIdRoundtrip)
   EXPECT_EQ(f->sketchId(), 1234u);
 }
 
+
+TEST(Serialization, FeatureParamsRoundtripExactlyInKeyOrder)
+{
+  Handle(BoxFeature) a = new BoxFeature();
+  a->setName(TCollection_AsciiString("a=b\\c"));
+  a->setParam(Feature::ParamKey::Transparency, 0.1 + 0.2); // overflow keys, inserted out of order
+  a->setParam(Feature::ParamKey::Radius, 1e-300);
+  a->setFixedGeometry(true);
+  a->setSize(12.3456789, 1.0 / 3.0, -2.5e17);
+
+  const std::string blob = a->serialize();
+  EXPECT_NE(blob.find("name=a\\=b\\\\c\n"), std::string::npos);
+  EXPECT_NE(blob.find("p_0=12.3456789\np_1="), std::string::npos);
+  EXPECT_LT(blob.find("p_3="), blob.find("i_20=1\n")); // int the box schema does not declare
+  EXPECT_LT(blob.find("i_20="), blob.find("p_21="));
+
+  Handle(BoxFeature) b = new BoxFeature();
+  b->deserialize(blob);
+  EXPECT_STREQ(b->name().ToCString(), "a=b\\c");
+  EXPECT_EQ(b->dx(), 12.3456789);
+  EXPECT_EQ(b->dy(), 1.0 / 3.0);
+  EXPECT_EQ(b->dz(), -2.5e17);
+  EXPECT_EQ(std::get<double>(*b->params().get(Feature::ParamKey::Transparency)), 0.1 + 0.2);
+  EXPECT_EQ(std::get<double>(*b->params().get(Feature::ParamKey::Radius)), 1e-300);
+  EXPECT_TRUE(std::holds_alternative<int>(*b->params().get(Feature::ParamKey::FixedGeometry)));
+  EXPECT_EQ(b->serialize(), blob); // byte-stable
+  EXPECT_EQ(b->contentHash(), a->contentHash());
+}
+
+TEST(Serialization, LineBreaksInValuesStayOnTheirLine)
+{
+  Handle(ExtrudeFeature) a = new ExtrudeFeature();
+  a->setName(TCollection_AsciiString("first line\nsecond=line\r\nthird \\n"));
+  a->setParam(Feature::ParamKey::Transparency, TCollection_AsciiString("a\nsuppressed=1"));
+  a->setDistance(7.0);
+  a->setSketchId(1234); // a subclass field after the escaped ones
+
+  const std::string blob = a->serialize();
+  EXPECT_EQ(blob.find("\nsuppressed=1"), std::string::npos); // the param value did not start a line
+  EXPECT_EQ(blob.find('\r'), std::string::npos);
+
+  Handle(ExtrudeFeature) b = new ExtrudeFeature();
+  b->deserialize(blob);
+  EXPECT_STREQ(b->name().ToCString(), "first line\nsecond=line\r\nthird \\n");
+  EXPECT_STREQ(std::get<TCollection_AsciiString>(*b->params().get(Feature::ParamKey::Transparency)).ToCString(),
+               "a\nsuppressed=1");
+  EXPECT_FALSE(b->isSuppressed());
+  EXPECT_EQ(b->distance(), 7.0);
+  EXPECT_EQ(b->sketchId(), 1234u);
+  EXPECT_EQ(b->serialize(), blob);
+}
+
+TEST(Serialization, FeatureReadsOlderBlobs)
+{
+  // Six-digit stream output, keys in storage order, unknown keys and lines without '='
+  Handle(BoxFeature) b = new BoxFeature();
+  b->deserialize("name=Old\nsuppressed=0\ndatum_related=0\np_2=3.5\np_0=1e+06\nfuture=x\ngarbage\np_x=1\n");
+  EXPECT_STREQ(b->name().ToCString(), "Old");
+  EXPECT_EQ(b->dx(), 1e6);
+  EXPECT_EQ(b->dz(), 3.5);
+  EXPECT_EQ(b->params().size(), 2u);
+}
+
+TEST(Serialization, SketchEncodingsAreExact)
+{
+  Sketch s;
+  s.setPlane(gp_Ax2(gp_Pnt(1.5, -2.0, 3.0e7), gp::DX(), gp::DY()));
+  s.setPlaneId(77);
+  s.addLine(gp_Pnt2d(1.0e9 + 0.123456789, 1.0 / 3.0), gp_Pnt2d(-2.5e-7, 4.0));
+  s.addArc(gp_Pnt2d(0.1, 0.2), gp_Pnt2d(0.3, 0.2), gp_Pnt2d(-0.1, 0.2), true);
+  s.addPoint(gp_Pnt2d(123456.789012345, 0.7));
+  s.addCoincident({0, 1}, {1, 0});
+
+  const std::string binary = s.serialize(Sketch::Encoding::Binary);
+  const std::string text = s.serialize();
+  EXPECT_EQ(text.rfind("curves 2\n", 0), 0u);
+  EXPECT_NE(text.find("L 1000000000.1234568 0.3333333333333333 "), std::string::npos);
+
+  for (const std::string* blob : {&binary, &text})
+  {
+    Sketch r;
+    r.deserialize(*blob);
+    ASSERT_EQ(r.curves().size(), 2u);
+    EXPECT_EQ(r.curves()[0].line.p1.X(), 1.0e9 + 0.123456789);
+    EXPECT_EQ(r.curves()[0].line.p1.Y(), 1.0 / 3.0);
+    EXPECT_TRUE(r.curves()[1].arc.clockwise);
+    ASSERT_EQ(r.points().size(), 1u);
+    EXPECT_EQ(r.points()[0].X(), 123456.789012345);
+    ASSERT_EQ(r.constraints().size(), 1u);
+    EXPECT_EQ(r.constraints()[0].b.curve, 1);
+    EXPECT_EQ(r.planeId(), 77u);
+    EXPECT_EQ(r.plane().Location().Z(), 3.0e7);
+    EXPECT_EQ(r.contentHash(), s.contentHash());
+    EXPECT_EQ(r.serialize(Sketch::Encoding::Binary), binary);
+    EXPECT_EQ(r.serialize(), text);
+  }
+}
+
+TEST(Serialization, SketchReadsOlderTextAndRejectsCorruptBinary)
+{
+  Sketch old;
+  old.deserialize("curves 1\nL 0 0 12.3457 0\npoints 0\nconstraints 0\nplane 0 0 0 0 0 1 1 0 0\nplaneId 5\n");
+  ASSERT_EQ(old.curves().size(), 1u);
+  EXPECT_EQ(old.curves()[0].line.p2.X(), 12.3457);
+  EXPECT_EQ(old.planeId(), 5u);
+
+  Sketch s;
+  for (int i = 0; i < 10; ++i) s.addLine(gp_Pnt2d(i, 0), gp_Pnt2d(i + 1, 0));
+  const std::string blob = s.serialize(Sketch::Encoding::Binary);
+  Sketch r;
+  EXPECT_THROW(r.deserialize(blob.substr(0, blob.size() - 8)), std::runtime_error);
+
+  // Curve tags (padded to 8 bytes) sit right before the line endpoints, four doubles per line
+  const std::size_t tagsAt = blob.size() - 10 * 4 * sizeof(double) - 16;
+  ASSERT_EQ(blob[tagsAt], '\0');
+  std::string badTag = blob;
+  badTag[tagsAt] = '\x09';
+  EXPECT_THROW(r.deserialize(badTag), std::runtime_error);
+
+  // Constraints come last, five int32 each with the type first
+  s.addCoincident({0, 1}, {1, 0});
+  std::string badType = s.serialize(Sketch::Encoding::Binary);
+  const std::int32_t unknown = 7;
+  std::memcpy(&badType[badType.size() - 5 * sizeof(std::int32_t)], &unknown, sizeof(unknown));
+  EXPECT_THROW(r.deserialize(badType), std::runtime_error);
+}